@@ -73,6 +73,10 @@ extern "C" __declspec(dllexport) void setInfo(NppData NppData)
 	_hScintillaMain = NppData._scintillaMainHandle;
 	_hScintillaSecond = NppData._scintillaSecondHandle;
 
+#ifdef NPP_PLUGININTERFACE_NOTIFYTRACE
+	notify_trace::startRecording();
+#endif
+
 	messageProc( PIFACE_MSG_NPPDATASET, 0, 0 );
 }
 
@@ -97,4 +97,20 @@ extern "C" __declspec(dllexport) const TCHAR * getName();
 
 }  // End Namespace: npp_plugin
 
+//  Stand-in Notepad++ host for running plugins without a GUI session.
+#ifdef NPP_PLUGININTERFACE_HOSTSIM
+#include "NppPluginIface_HostSim.h"
+#endif
+
+//  Hot path timing probes, PIFACE_TIMED_SCOPE is empty unless NPP_PLUGININTERFACE_TIMING is defined.
+#include "NppPluginIface_Timing.h"
+
+//  Record and replay of the plugin's notifications and message replies.
+#ifdef NPP_PLUGININTERFACE_NOTIFYTRACE
+#include "NppPluginIface_NotifyTrace.h"
+#endif
+
+//  Single route for every ::SendMessage, optionally profiled with NPP_PLUGININTERFACE_MSGPROFILE.
+#include "NppPluginIface_MsgFacade.h"
+
 #endif // End include guard:  NPP_PLUGININTERFACE_H
\ No newline at end of file
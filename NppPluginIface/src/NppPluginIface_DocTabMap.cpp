@@ -106,6 +106,8 @@ dts_by_visibleTab& visibleTab_index = dts.get<dt_visible_key>();
 //  Update the tab mapping between bufferIDs and pDocs for message filtering.
 void update_DocTabMap()
 {
+	PIFACE_TIMED_SCOPE( PROBE_UPDATEDOCTABMAP );
+
 	//  Since there isn't a buffer-deactivate message to remove an entry we empty the set and
 	//  rebuild on buffer activated messages.
 	if ( dts.size() > 0 ) {
@@ -126,7 +128,11 @@ void update_DocTabMap()
 			int tabBuffID = ::SendMessage( hNpp(), NPPM_GETBUFFERIDFROMPOS, tab, view);
 			if ( tabBuffID > 0 ) {
 				BufferID pBuff = (BufferID)tabBuffID;;
+#ifdef NPP_PLUGININTERFACE_HOSTSIM
+				Document pDoc = (Document)host_sim::documentFromBufferID( tabBuffID );
+#else
 				Document pDoc = pBuff->getDocument();
+#endif
 				isVisible = ( pDoc == viewDocID ) ? ( true ) : ( false );
 				dts.insert(
 					DocTab( targetView, tab, pBuff, pDoc, isVisible)
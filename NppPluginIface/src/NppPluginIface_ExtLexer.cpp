@@ -56,13 +56,30 @@ const bool LEX = false;
 std::vector<FuncItem> _LexerFuncVector;	//  Container for lexer function commands.
 std::vector<FuncItem> ReturnVector;		//  Container for the ordered function commands.
 std::vector<Lexer> _LexerDetailVector;  //  Container for lexer details.
+std::vector<void (*)()> _DeferredInits;	//  Lexer setups waiting for the loader lock to be released.
+
+//  Runs the lexer setups put off by initLexersLater, in the order they were given.
+void runDeferredInits()
+{
+	std::vector<void (*)()> inits;
+	inits.swap( _DeferredInits );
+	for ( size_t i = 0; i < inits.size(); i++ ) ( *inits[i] )();
+}
 
 //  Required Notepad++ External Lexer Function
 //  Returns a count of lexers initialized from this plugin.
-int __stdcall GetLexerCount() {	return _LexerDetailVector.size(); }
+int __stdcall GetLexerCount()
+{
+	runDeferredInits();
+	return _LexerDetailVector.size();
+}
 
 //  Returns a count of all lexer menu function items in this plugin.
-int getLexerFuncCount () { return _LexerFuncVector.size(); }
+int getLexerFuncCount ()
+{
+	runDeferredInits();
+	return _LexerFuncVector.size();
+}
 
 //  Both Notepad++ and Scintilla use this.  Scintilla expects char and Notepad++ will
 //  convert it for unicode if needed.
@@ -101,6 +118,8 @@ void __stdcall GetLexerStatusText(unsigned int Index, TCHAR *desc, int buflength
 void __stdcall Lex(unsigned int langID, unsigned int startPos, int length, int initStyle,
 				   char *words[], WindowID window, char *props)
 {
+	PIFACE_TIMED_SCOPE( PROBE_LEX );
+
 	Lexer* currLexer = &_LexerDetailVector.at(langID);
 
 	if (! ( currLexer->SCI_LEXERID >= SCLEX_AUTOMATIC ) || ( npp_plugin::isNppReady() ) ) {
@@ -125,6 +144,8 @@ void __stdcall Lex(unsigned int langID, unsigned int startPos, int length, int i
 void __stdcall Fold(int langID, unsigned int startPos, int length,	int initStyle,
 				char *words[], WindowID window, char *props)
 {
+		PIFACE_TIMED_SCOPE( PROBE_FOLD );
+
 		Lexer* currLexer = &_LexerDetailVector.at(langID);
 		currLexer->_pLexOrFold(1, startPos, length, initStyle, words, window, props);
 }
@@ -139,8 +160,9 @@ void __stdcall Fold(int langID, unsigned int startPos, int length,	int initStyle
 //    statusText:  text that appears in the N++ status bar.	/* TEXT("Status-Bar Text")	*/
 //    pLexOrFold:  pointer to the lexers LexOrFold funtion.	/* NameSpace::LexOrFold		*/
 //    pMenuDlg:  lexer's main menu dialog function.			/* NameSpace::MenuDlg */
+//    pLexOrFoldAccessor:  optional Accessor& entry point.	/* NameSpace::LexOrFold		*/
 void initLexer(std::string Name, tstring statusText, NppExtLexerFunction pLexOrFold,
-				PFUNCPLUGINCMD pMenuDlg)
+				PFUNCPLUGINCMD pMenuDlg, NppExtLexerAccessorFunction pLexOrFoldAccessor)
 {
 	// Notify if length is too long.
 	if ( Name.length() > MAX_EXTERNAL_LEXER_NAME_LEN )
@@ -163,6 +185,7 @@ void initLexer(std::string Name, tstring statusText, NppExtLexerFunction pLexOrF
 	thisLexer._name.assign(Name);
 	thisLexer._description.assign(statusText);
 	thisLexer._pLexOrFold = pLexOrFold;
+	thisLexer._pLexOrFoldAccessor = pLexOrFoldAccessor;
 	thisLexer.SCI_LEXERID = NULL;
 
 	_LexerDetailVector.push_back(thisLexer);
@@ -211,6 +234,15 @@ void setLexerFuncItem(tstring Name, PFUNCPLUGINCMD pFunction,
 	_LexerFuncVector.push_back(thisFunction);
 }
 
+//  DllMain runs under the loader lock, where reading and parsing files or showing messages
+//  can deadlock.  A lexer needing any of that to set itself up is registered by pInitLexers
+//  instead, which is run the first time Notepad++ or Scintilla asks about this plugin's
+//  lexers or menu items.
+void initLexersLater(void (*pInitLexers)())
+{
+	_DeferredInits.push_back(pInitLexers);
+}
+
 // Returns the SCI_LEXERID at vector index.
 int getSCILexerIDByIndex(int index) { return ( _LexerDetailVector.at(index).SCI_LEXERID ); }
 
@@ -239,7 +271,11 @@ std::vector<FuncItem> getLexerFuncVector() { return ( _LexerFuncVector ); }
 //
 //  Useful to merge additional function items together before responding to the
 //  Npp plugin manager's getFuncArray() call.
-std::vector<Lexer> getLexerDetailVector() { return ( _LexerDetailVector ); }
+std::vector<Lexer> getLexerDetailVector()
+{
+	runDeferredInits();
+	return ( _LexerDetailVector );
+}
 
 
 //  'Virtualized' base plugin FuncItem functions.
@@ -268,6 +304,8 @@ FuncItem * getPluginFuncArray()
 		 }
 	};
 
+	runDeferredInits();
+
 	if ( _LexerFuncVector.empty() ) {
 		//  Doesn't look like there are any lexer function items so just send the plugin's.
 		ReturnVector = npp_plugin::getPluginFuncVector();
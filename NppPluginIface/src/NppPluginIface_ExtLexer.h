@@ -54,6 +54,12 @@
 typedef void (*NppExtLexerFunction)(bool LexOrFold, unsigned int startPos, int lengthDoc, int initStyle,
                   char *words[], WindowID window, char *props);
 
+//  Optional LexOrFold Function Definition working on any Scintilla Accessor instead of a window.
+//  Lets a lexer be driven by the in-memory accessor used for benchmarking.
+class Accessor;
+typedef void (*NppExtLexerAccessorFunction)(bool LexOrFold, unsigned int startPos, int lengthDoc,
+                  int initStyle, char *words[], Accessor &styler);
+
 namespace npp_plugin {
 
 //  Namespace Extension for External Lexer Interface
@@ -65,14 +71,17 @@ struct Lexer
 	std::string _name;			// Use of char instead of TCHAR since Scintilla expects char.
 	tstring _description;
 	NppExtLexerFunction _pLexOrFold;
+	NppExtLexerAccessorFunction _pLexOrFoldAccessor;	//  NULL when the lexer doesn't provide one.
 	int SCI_LEXERID;
 };
 
 //  <--- Initialization --->
 void initLexer(std::string Name, tstring statusText, NppExtLexerFunction pLexOrFold,
-			   PFUNCPLUGINCMD pMenuDlg);		//  Setup a lexer definition.
+			   PFUNCPLUGINCMD pMenuDlg,
+			   NppExtLexerAccessorFunction pLexOrFoldAccessor = NULL);		//  Setup a lexer definition.
 void setLexerFuncItem(tstring Name, PFUNCPLUGINCMD pFunction, int cmdID = NULL,
 				bool init2Check = false, ShortcutKey* pShKey = NULL);	//  Store additional lexer FuncItem commands.
+void initLexersLater(void (*pInitLexers)());	//  Run pInitLexers outside DllMain, before the lexers are first asked for.
 
 //  <--- Data Retrieval --->
 int getSCILexerIDByIndex( int index );			//  Returns the Scintilla lexer ID for this vector index.
@@ -92,4 +101,8 @@ FuncItem * getPluginFuncArray();				//  'Virtualize' the base plugin's getPlugin
 
 }  // End Namespace: npp_plugin.
 
+#ifdef NPP_PLUGININTERFACE_LEXERBENCH
+#include "NppPluginIface_ExtLexer_Bench.h"
+#endif
+
 #endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_EXTENSION_H
\ No newline at end of file
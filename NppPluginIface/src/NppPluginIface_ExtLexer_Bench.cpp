@@ -0,0 +1,434 @@
+/* NppPluginIface_ExtLexer_Bench.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a throughput benchmark for the plugin's
+ *  external lexers.
+ *
+ *  Small documents are lexed repeatedly and the best time is kept so the figures aren't just
+ *  timer noise.  The keystroke relex restyles and refolds from the edited line to RELEX_LINES
+ *  below it, which is about what Scintilla asks for to fill one screen.  The keystroke is then
+ *  deleted and relexed again, so afterwards the output must still match the full lex; that is
+ *  reported in the 'relex' column.
+ *
+ *  Notepad++ isn't running, so messages the lexers send get no answer.  Anything a lexer
+ *  would read from Notepad++ comes from the setup function it registered, if any.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer.h"
+
+#ifdef NPP_PLUGININTERFACE_LEXERBENCH
+
+#include "NppPluginIface_ExtLexer_MemAccessor.h"
+
+//  <--- STL --->
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+
+//  <--- Windows --->
+#include "Shlwapi.h"
+#pragma comment( lib, "Shlwapi.lib" )
+
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+namespace bench {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const int NB_TIERS = 4;
+const size_t TIER_SIZES[NB_TIERS] = { 1 << 10, 64 << 10, 1 << 20, 50 << 20 };
+const char* TIER_NAMES[NB_TIERS] = { "1KB", "64KB", "1MB", "50MB" };
+
+const int NB_KEYWORD_LISTS = 9;				//  Scintilla's KEYWORDSET_MAX + 1.
+const size_t REPEAT_BYTES = 8 << 20;		//  Small documents are lexed until about this much is done.
+const int MAX_REPEATS = 20;
+const int KEYSTROKE_REPEATS = 10;
+const int RELEX_LINES = 60;
+
+const char* DEFAULT_PROPS = "fold=1\nfold.compact=1\nfold.comment=1\n";
+
+//  Keyword lists and properties passed to one lexer.
+struct LexerInput {
+	std::vector<std::string> keywords;
+	std::vector<char*> words;				//  Null terminated, points into keywords.
+	std::string props;
+
+	void setWords()
+	{
+		keywords.resize( NB_KEYWORD_LISTS );
+		words.clear();
+		for ( size_t i = 0; i < keywords.size(); i++ ) words.push_back( const_cast<char*>( keywords[i].c_str() ) );
+		words.push_back( NULL );
+	}
+};
+
+//  Results for one document.
+struct DocResult {
+	size_t bytes;
+	double lexMBps;
+	double foldMBps;
+	double keystrokeUs;						//  Median lex and fold for one keystroke.
+	double keystrokeMBps;
+	bool relexMatches;
+
+	DocResult():bytes(0), lexMBps(0), foldMBps(0), keystrokeUs(0), keystrokeMBps(0),
+		relexMatches(true){};
+};
+
+double _secondsPerTick = 0;
+
+std::map<std::string, SetupFunction> _setups;		//  By lexer name.
+
+double elapsedSeconds( const LARGE_INTEGER& entry )
+{
+	LARGE_INTEGER exit;
+	::QueryPerformanceCounter( &exit );
+	return ( double( exit.QuadPart - entry.QuadPart ) * _secondsPerTick );
+}
+
+std::string toNarrow( const tstring& wide )
+{
+	std::string narrow( wide.length(), '\0' );
+	for ( size_t i = 0; i < wide.length(); i++ ) narrow[i] = static_cast<char>( wide[i] );
+	return ( narrow );
+}
+
+tstring joinPath( const tstring& dir, const tstring& name )
+{
+	TCHAR path[MAX_PATH];
+	lstrcpyn( path, dir.c_str(), MAX_PATH );
+	PathAppend( path, name.c_str() );
+	return ( tstring( path ) );
+}
+
+bool readFile( const tstring& path, std::string& contents )
+{
+	std::ifstream in( path.c_str(), std::ios::in | std::ios::binary );
+	if (! in ) return ( false );
+	std::ostringstream buffer;
+	buffer << in.rdbuf();
+	contents = buffer.str();
+	return ( true );
+}
+
+//  Returns the names of the files ( or directories ) in dir.
+std::vector<tstring> listDir( const tstring& dir, bool directories )
+{
+	std::vector<tstring> names;
+
+	WIN32_FIND_DATA findData;
+	HANDLE hFind = ::FindFirstFile( joinPath( dir, TEXT("*") ).c_str(), &findData );
+	if ( hFind == INVALID_HANDLE_VALUE ) return ( names );
+
+	do {
+		bool isDir = ( findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) != 0;
+		if ( isDir != directories ) continue;
+		if ( findData.cFileName[0] == '.' ) continue;
+		names.push_back( tstring( findData.cFileName ) );
+	} while ( ::FindNextFile( hFind, &findData ) );
+
+	::FindClose( hFind );
+	std::sort( names.begin(), names.end() );
+	return ( names );
+}
+
+//  Reads keywords.txt ( one list per line ) and props.txt from a lexer's corpus directory.
+LexerInput readLexerInput( const tstring& lexerDir )
+{
+	LexerInput input;
+
+	std::string contents;
+	if ( readFile( joinPath( lexerDir, TEXT("keywords.txt") ), contents ) ) {
+		std::istringstream lines( contents );
+		std::string line;
+		while ( std::getline( lines, line ) && ( int( input.keywords.size() ) < NB_KEYWORD_LISTS ) ) {
+			line.erase( std::remove( line.begin(), line.end(), '\r' ), line.end() );
+			input.keywords.push_back( line );
+		}
+	}
+	input.setWords();
+
+	input.props = DEFAULT_PROPS;
+	if ( readFile( joinPath( lexerDir, TEXT("props.txt") ), contents ) ) {
+		contents.erase( std::remove( contents.begin(), contents.end(), '\r' ), contents.end() );
+		input.props = contents;
+	}
+
+	return ( input );
+}
+
+//  Repeats or cuts source at a line end to make a document of about size bytes.
+std::string makeTierText( const std::string& source, size_t size )
+{
+	std::string text;
+	if ( source.empty() ) return ( text );
+
+	std::string unit( source );
+	char last = unit[unit.length() - 1];
+	if ( ( last != '\n' ) && ( last != '\r' ) ) unit.append( "\r\n" );
+
+	text.reserve( size + unit.length() );
+	while ( text.length() < size ) text.append( unit );
+
+	size_t cut = text.find_last_of( "\r\n", size - 1 );
+	if ( ( cut == std::string::npos ) || ( cut + 1 < unit.length() / 2 ) ) cut = size - 1;
+	if ( ( text[cut] == '\r' ) && ( cut + 1 < text.length() ) && ( text[cut + 1] == '\n' ) ) cut++;
+	text.erase( cut + 1 );
+
+	return ( text );
+}
+
+//  Lex and fold from the line holding pos the way Scintilla does after an edit.
+void relexAt( const Lexer& lexer, LexerInput& input, MemAccessor& styler, int pos )
+{
+	int line = styler.GetLine( pos );
+	int startPos = styler.LineStart( line );
+	int length = styler.LineStart( line + RELEX_LINES ) - startPos;
+	int initStyle = ( startPos > 0 ) ? ( styler.StyleAt( startPos - 1 ) ) : ( 0 );
+
+	lexer._pLexOrFoldAccessor( false, startPos, length, initStyle, &input.words[0], styler );
+	lexer._pLexOrFoldAccessor( true, startPos, length, initStyle, &input.words[0], styler );
+}
+
+//  Lexes and folds source as it is and compares the dump of the output with the golden file.
+//  Returns "match", "MISMATCH at line <n>", "recorded", or "new".
+std::string checkGolden( const Lexer& lexer, LexerInput& input, const std::string& source,
+		const tstring& goldenPath, bool recordGoldens )
+{
+	MemAccessor styler( source, input.props.c_str() );
+	lexer._pLexOrFoldAccessor( false, 0, source.length(), 0, &input.words[0], styler );
+	lexer._pLexOrFoldAccessor( true, 0, source.length(), 0, &input.words[0], styler );
+	std::string dump = styler.getDump();
+
+	std::string golden;
+	bool hasGolden = readFile( goldenPath, golden );
+	if ( recordGoldens || !hasGolden ) {
+		std::ofstream out( goldenPath.c_str(), std::ios::out | std::ios::binary );
+		out << dump;
+		return ( hasGolden ? ( "recorded" ) : ( "new" ) );
+	}
+
+	golden.erase( std::remove( golden.begin(), golden.end(), '\r' ), golden.end() );
+	if ( golden == dump ) return ( "match" );
+
+	std::istringstream goldenLines( golden );
+	std::istringstream dumpLines( dump );
+	std::string goldenLine, dumpLine;
+	int line = 0;
+	while ( std::getline( goldenLines, goldenLine ) && std::getline( dumpLines, dumpLine ) &&
+			( goldenLine == dumpLine ) ) line++;
+
+	std::ostringstream result;
+	result << "MISMATCH at line " << line;
+	return ( result.str() );
+}
+
+//  Times one document and checks that relexing after a keystroke gives the full lex output.
+DocResult runDocument( const Lexer& lexer, LexerInput& input, const std::string& text )
+{
+	DocResult result;
+	result.bytes = text.length();
+	double mb = double( text.length() ) / ( 1024.0 * 1024.0 );
+
+	int nbRepeats = int( REPEAT_BYTES / ( text.length() + 1 ) );
+	if ( nbRepeats < 1 ) nbRepeats = 1;
+	if ( nbRepeats > MAX_REPEATS ) nbRepeats = MAX_REPEATS;
+
+	//  Full document lex and fold, keeping the best of the repeats.
+	double bestLex = -1;
+	double bestFold = -1;
+	std::string summary;
+	for ( int repeat = 0; repeat < nbRepeats; repeat++ ) {
+		MemAccessor styler( text, input.props.c_str() );
+		LARGE_INTEGER entry;
+
+		::QueryPerformanceCounter( &entry );
+		lexer._pLexOrFoldAccessor( false, 0, text.length(), 0, &input.words[0], styler );
+		double lexTime = elapsedSeconds( entry );
+
+		::QueryPerformanceCounter( &entry );
+		lexer._pLexOrFoldAccessor( true, 0, text.length(), 0, &input.words[0], styler );
+		double foldTime = elapsedSeconds( entry );
+
+		if ( ( bestLex < 0 ) || ( lexTime < bestLex ) ) bestLex = lexTime;
+		if ( ( bestFold < 0 ) || ( foldTime < bestFold ) ) bestFold = foldTime;
+		if ( repeat == 0 ) summary = styler.getSummary();
+	}
+	if ( bestLex > 0 ) result.lexMBps = mb / bestLex;
+	if ( bestFold > 0 ) result.foldMBps = mb / bestFold;
+
+	//  Single keystroke at the middle line, typed and then deleted again.
+	MemAccessor styler( text, input.props.c_str() );
+	lexer._pLexOrFoldAccessor( false, 0, text.length(), 0, &input.words[0], styler );
+	lexer._pLexOrFoldAccessor( true, 0, text.length(), 0, &input.words[0], styler );
+
+	int keystrokePos = styler.LineStart( styler.getLineCount() / 2 );
+	int relexBytes = styler.LineStart( styler.GetLine( keystrokePos ) + RELEX_LINES ) - keystrokePos;
+	std::vector<double> keystrokeTimes;
+	for ( int repeat = 0; repeat < KEYSTROKE_REPEATS; repeat++ ) {
+		LARGE_INTEGER entry;
+
+		styler.insertText( keystrokePos, "x" );
+		::QueryPerformanceCounter( &entry );
+		relexAt( lexer, input, styler, keystrokePos );
+		keystrokeTimes.push_back( elapsedSeconds( entry ) );
+
+		styler.deleteText( keystrokePos, 1 );
+		::QueryPerformanceCounter( &entry );
+		relexAt( lexer, input, styler, keystrokePos );
+		keystrokeTimes.push_back( elapsedSeconds( entry ) );
+	}
+	std::sort( keystrokeTimes.begin(), keystrokeTimes.end() );
+	double medianKeystroke = keystrokeTimes[keystrokeTimes.size() / 2];
+	result.keystrokeUs = medianKeystroke * 1000000.0;
+	if ( medianKeystroke > 0 ) result.keystrokeMBps = ( double( relexBytes ) / ( 1024.0 * 1024.0 ) ) / medianKeystroke;
+	result.relexMatches = ( styler.getSummary() == summary );
+
+	return ( result );
+}
+
+}  // End: Un-named namespace
+
+
+void setLexerSetup( std::string lexerName, SetupFunction setup )
+{
+	_setups[lexerName] = setup;
+}
+
+//  Runs every corpus document through its lexer and writes <corpus>\lexerbench.txt.
+int runBenchmark( tstring corpusDir, bool recordGoldens, size_t maxBytes )
+{
+	LARGE_INTEGER perfFreq;
+	::QueryPerformanceFrequency( &perfFreq );
+	_secondsPerTick = 1.0 / double( perfFreq.QuadPart );
+
+	//  Lets lexers take their normal incremental paths instead of treating every call as the
+	//  first one during Notepad++ start up.
+	npp_plugin::setNppReady();
+
+	std::ofstream report( joinPath( corpusDir, TEXT("lexerbench.txt") ).c_str() );
+	report << std::fixed << std::setprecision( 2 );
+	report << std::left << std::setw( 14 ) << "lexer" << std::setw( 32 ) << "file" << std::setw( 6 ) << "size"
+		<< std::right << std::setw( 10 ) << "bytes" << std::setw( 10 ) << "lex_MB/s" << std::setw( 12 ) << "fold_MB/s"
+		<< std::setw( 12 ) << "key_us" << std::setw( 10 ) << "key_MB/s" << "  relex     golden\n";
+
+	int nbDocs = 0;
+	int nbMismatches = 0;
+	std::vector<Lexer> lexers = getLexerDetailVector();
+	std::vector<tstring> lexerDirs = listDir( corpusDir, true );
+
+	for ( std::vector<tstring>::iterator dirName = lexerDirs.begin(); dirName != lexerDirs.end(); dirName++ ) {
+		std::string lexerName = toNarrow( *dirName ) + "*";
+		std::vector<Lexer>::iterator lexer = lexers.begin();
+		while ( ( lexer != lexers.end() ) && ( lexer->_name.compare( lexerName ) != 0 ) ) lexer++;
+		if ( ( lexer == lexers.end() ) || ( lexer->_pLexOrFoldAccessor == NULL ) ) {
+			report << "Skipped " << toNarrow( *dirName ) << ":  no lexer with an Accessor entry point.\n";
+			continue;
+		}
+
+		tstring lexerDir = joinPath( corpusDir, *dirName );
+		tstring goldenDir = joinPath( lexerDir, TEXT("golden") );
+		::CreateDirectory( goldenDir.c_str(), NULL );
+		LexerInput input = readLexerInput( lexerDir );
+
+		std::map<std::string, SetupFunction>::const_iterator setup = _setups.find( lexerName );
+		if ( setup != _setups.end() ) {
+			MemAccessor props( std::string(), input.props.c_str() );
+			setup->second( &input.words[0], props );
+		}
+
+		std::vector<tstring> files = listDir( lexerDir, false );
+		for ( std::vector<tstring>::iterator fileName = files.begin(); fileName != files.end(); fileName++ ) {
+			if ( ( *fileName == TEXT("keywords.txt") ) || ( *fileName == TEXT("props.txt") ) ) continue;
+
+			std::string source;
+			if (! readFile( joinPath( lexerDir, *fileName ), source ) ) continue;
+
+			tstring goldenName( *fileName );
+			goldenName.append( TEXT(".txt") );
+			std::string golden = checkGolden( *lexer, input, source, joinPath( goldenDir, goldenName ), recordGoldens );
+			if ( golden.compare( 0, 8, "MISMATCH" ) == 0 ) nbMismatches++;
+
+			for ( int tier = 0; tier < NB_TIERS; tier++ ) {
+				if ( ( maxBytes > 0 ) && ( TIER_SIZES[tier] > maxBytes ) ) continue;
+
+				std::string text = makeTierText( source, TIER_SIZES[tier] );
+				if ( text.empty() ) continue;
+
+				DocResult result = runDocument( *lexer, input, text );
+				nbDocs++;
+				if (! result.relexMatches ) nbMismatches++;
+
+				report << std::left << std::setw( 14 ) << toNarrow( *dirName ) << std::setw( 32 ) << toNarrow( *fileName )
+					<< std::setw( 6 ) << TIER_NAMES[tier] << std::right
+					<< std::setw( 10 ) << result.bytes
+					<< std::setw( 10 ) << result.lexMBps
+					<< std::setw( 12 ) << result.foldMBps
+					<< std::setw( 12 ) << result.keystrokeUs
+					<< std::setw( 10 ) << result.keystrokeMBps
+					<< "  " << std::left << std::setw( 10 ) << ( result.relexMatches ? "match" : "MISMATCH" )
+					<< golden << "\n";
+				report.flush();
+			}
+		}
+	}
+
+	report << "\n" << nbDocs << " documents, " << nbMismatches << " mismatches.\n";
+	return ( nbMismatches );
+}
+
+}  // End namespace: bench
+
+}  // End namespace: external_lexer
+
+}  // End namespace: npp_plugin
+
+
+//  rundll32 entry point:  rundll32 <plugin>.dll,LexerBench [record ]<corpus dir>
+extern "C" __declspec(dllexport) void CALLBACK LexerBench( HWND /*hwnd*/, HINSTANCE /*hinst*/,
+		LPSTR lpszCmdLine, int /*nCmdShow*/ )
+{
+	using npp_plugin::tstring;
+
+	std::string cmdLine( lpszCmdLine );
+	cmdLine.erase( std::remove( cmdLine.begin(), cmdLine.end(), '\"' ), cmdLine.end() );
+
+	bool recordGoldens = false;
+	const std::string recordMode( "record " );
+	if ( cmdLine.compare( 0, recordMode.length(), recordMode ) == 0 ) {
+		recordGoldens = true;
+		cmdLine.erase( 0, recordMode.length() );
+	}
+
+	tstring corpusDir( cmdLine.length(), '\0' );
+	std::copy( cmdLine.begin(), cmdLine.end(), corpusDir.begin() );
+
+	npp_plugin::external_lexer::bench::runBenchmark( corpusDir, recordGoldens );
+}
+
+#endif  // End: NPP_PLUGININTERFACE_LEXERBENCH
@@ -0,0 +1,86 @@
+/* NppPluginIface_ExtLexer_Bench.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a throughput benchmark for the plugin's
+ *  external lexers.
+ *
+ *  With NPP_PLUGININTERFACE_LEXERBENCH defined the plugin dll exports LexerBench, which runs
+ *  every lexer registered with an Accessor& entry point against a corpus directory using the
+ *  in-memory MemAccessor:
+ *
+ *    rundll32 NppPlugin_ExtLexer.dll,LexerBench [record ]C:\path\to\corpus
+ *
+ *  NppPlugins\NppPlugin_ExtLexer\linux_bench builds the same benchmark as a gcc program with
+ *  stand-in Windows and Scintilla headers, for machines without VC9;  'make check' runs it
+ *  against the committed corpus.
+ *
+ *  The corpus holds one sub-directory per lexer, named after the lexer without its trailing
+ *  '*' ( PowerShell, Conf, MYUSERLANG ).  Each file in it is run at 1KB, 64KB, 1MB and 50MB,
+ *  repeating or cutting the file at a line end to reach each size.  An optional keywords.txt
+ *  holds one keyword list per line and an optional props.txt holds key=value lines.
+ *
+ *  For each document the full lex, full fold, and a single keystroke relex at the middle line
+ *  are timed.  Results go to <corpus>\lexerbench.txt.  Each file is also lexed and folded as
+ *  it is, and MemAccessor::getDump()'s line by line fold levels, line states, style runs and
+ *  indicator runs are compared with <corpus>\<lexer>\golden\<file>.txt; 'record ' rewrites
+ *  the golden files instead.  NppPlugins\NppPlugin_ExtLexer\bench holds a small corpus with
+ *  its golden files.
+ *
+ *  Settings a lexer normally takes from Notepad++, like the PowerShell highlighters from the
+ *  style configuration, are given to it by a setup function the plugin registers with
+ *  setLexerSetup(), called with the corpus keyword lists and props.txt before its documents.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_BENCH_H
+#define NPP_PLUGININTERFACE_EXTLEXER_BENCH_H
+
+#include "NppPluginIface_ExtLexer.h"
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+//  Namespace extension for the lexer benchmark.
+namespace bench {
+
+//  Sets a lexer up from its corpus keyword lists and an Accessor over its props.txt.
+typedef void (*SetupFunction)( char* words[], Accessor& props );
+
+void setLexerSetup( std::string lexerName, SetupFunction setup );	//  lexerName as given to initLexer.
+
+//  Returns the number of golden and relex mismatches.  Document sizes over maxBytes are
+//  skipped, 0 runs them all.
+int runBenchmark( tstring corpusDir, bool recordGoldens, size_t maxBytes = 0 );
+
+}  // End namespace: bench
+
+}  // End namespace: external_lexer
+
+}  // End namespace: npp_plugin
+
+//  Keeps the linker from dropping the rundll32 entry point, nothing in the plugin calls it.
+#ifdef _WIN64
+#pragma comment( linker, "/include:LexerBench" )
+#else
+#pragma comment( linker, "/include:_LexerBench@16" )
+#endif
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_BENCH_H
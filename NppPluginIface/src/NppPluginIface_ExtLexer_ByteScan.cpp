@@ -0,0 +1,196 @@
+/* NppPluginIface_ExtLexer_ByteScan.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a fast way for a lexer to step over
+ *  text that can't change its state.
+ *
+ *  The Visual Studio 2008 toolset has no AVX intrinsics, so SSE2 is as wide as the scan gets.
+ *  On 32 bit x86 builds the processor is asked whether it has SSE2 before it is used.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_ByteScan.h"
+#include "NppPluginIface_ExtLexer_DirectAccessor.h"
+#include "NppPluginIface_ExtLexer_MemAccessor.h"
+#include "NppPluginIface_ExtLexer_RunAccessor.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define NPP_PLUGININTERFACE_BYTESCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+#ifdef NPP_PLUGININTERFACE_BYTESCAN_SSE2
+bool hasSSE2()
+{
+#if defined(_M_IX86)
+	int cpuInfo[4];
+	__cpuid( cpuInfo, 1 );
+	return ( ( cpuInfo[3] & ( 1 << 26 ) ) != 0 );
+#else
+	return ( true );
+#endif
+}
+
+const bool useSSE2 = hasSSE2();
+#endif
+
+//  The text styler already holds in memory, from start to end, or NULL if it holds none.
+const char* heldText( Accessor& styler, int& start, int& end )
+{
+	if ( DirectAccessor* direct = dynamic_cast<DirectAccessor*>( &styler ) )
+		return ( direct->heldText( start, end ) );
+	if ( MemAccessor* mem = dynamic_cast<MemAccessor*>( &styler ) ) {
+		start = 0;
+		end = mem->getText().size();
+		return ( mem->getText().c_str() );
+	}
+	if ( RunAccessor* runs = dynamic_cast<RunAccessor*>( &styler ) )
+		return ( heldText( runs->target(), start, end ) );
+	return ( NULL );
+}
+
+}  // End: Un-named namespace
+
+
+ByteScanner::ByteScanner( const char* stopBytes )
+	:_nbBytes(0)
+{
+	std::memset( _stop, 0, sizeof( _stop ) );
+
+	for ( const char* pByte = stopBytes; *pByte; pByte++ ) {
+		unsigned char ch = static_cast<unsigned char>( *pByte );
+		if ( _stop[ch] ) continue;
+		_stop[ch] = true;
+
+		if ( _nbBytes >= 0 && _nbBytes < MAX_VECTOR_BYTES ) _bytes[_nbBytes++] = *pByte;
+		else _nbBytes = -1;
+	}
+}
+
+size_t ByteScanner::span( const char* text, size_t length ) const
+{
+	size_t i = 0;
+
+#ifdef NPP_PLUGININTERFACE_BYTESCAN_SSE2
+	if ( useSSE2 && _nbBytes > 0 ) {
+		__m128i needles[MAX_VECTOR_BYTES];
+		for ( int k = 0; k < _nbBytes; k++ ) needles[k] = _mm_set1_epi8( _bytes[k] );
+
+		for ( ; i + 16 <= length; i += 16 ) {
+			__m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( text + i ) );
+			__m128i hits = _mm_cmpeq_epi8( chunk, needles[0] );
+			for ( int k = 1; k < _nbBytes; k++ ) {
+				hits = _mm_or_si128( hits, _mm_cmpeq_epi8( chunk, needles[k] ) );
+			}
+
+			int mask = _mm_movemask_epi8( hits );
+			if ( mask != 0 ) {
+				while ( ( mask & 1 ) == 0 ) {
+					mask >>= 1;
+					i++;
+				}
+				return ( i );
+			}
+		}
+	}
+#endif
+
+	for ( ; i < length; i++ ) {
+		if ( _stop[static_cast<unsigned char>( text[i] )] ) return ( i );
+	}
+	return ( length );
+}
+
+
+TextSnapshot::TextSnapshot( Accessor& styler )
+	:_styler(styler), _held(NULL), _heldStart(0), _heldEnd(0), _text(_block), _start(0), _end(0)
+{
+	_held = heldText( styler, _heldStart, _heldEnd );
+	if ( _held ) {
+		_text = _held;
+		_start = _heldStart;
+		_end = _heldEnd;
+	}
+}
+
+//  Reads the held text in place, or copies a new block starting at position, whenever
+//  position is outside the current text.
+const char* TextSnapshot::textAt( int position, int endPos, int& length )
+{
+	if ( position < _start || position >= _end ) {
+		if ( _held && position >= _heldStart && position < _heldEnd ) {
+			_text = _held;
+			_start = _heldStart;
+			_end = _heldEnd;
+		}
+		else {
+			_text = _block;
+			_start = position;
+			_end = position + BLOCK_SIZE;
+			if ( _end > endPos ) _end = endPos;
+			if ( _end < _start ) _end = _start;
+
+			for ( int i = _start; i < _end; i++ ) _block[i - _start] = _styler.SafeGetCharAt( i );
+		}
+	}
+
+	int last = ( endPos < _end ) ? ( endPos ) : ( _end );
+	length = ( last > position ) ? ( last - position ) : ( 0 );
+	return ( _text + ( position - _start ) );
+}
+
+char TextSnapshot::fetch( int position, int endPos )
+{
+	int length;
+	const char* text = textAt( position, endPos, length );
+	if ( length == 0 ) return ( _styler.SafeGetCharAt( position ) );
+	return ( *text );
+}
+
+int TextSnapshot::span( const ByteScanner& scanner, int position, int endPos )
+{
+	int pos = position;
+	while ( pos < endPos ) {
+		int length;
+		const char* text = textAt( pos, endPos, length );
+		if ( length == 0 ) break;
+
+		size_t plain = scanner.span( text, length );
+		pos += plain;
+		if ( plain < static_cast<size_t>( length ) ) break;
+	}
+	return ( pos - position );
+}
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
@@ -0,0 +1,108 @@
+/* NppPluginIface_ExtLexer_ByteScan.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a fast way for a lexer to step over
+ *  text that can't change its state.
+ *
+ *  Inside a string or comment body most characters are plain text; only a handful of bytes
+ *  ( the closing quote, an escape, a line end, ... ) need the lexer's attention.  A
+ *  ByteScanner is made once from that handful and finds the first of them in a block of text,
+ *  sixteen bytes at a time with SSE2 where the processor has it.
+ *
+ *  The TextSnapshot gives the scanner contiguous text to run over: the text a DirectAccessor or
+ *  MemAccessor already holds, read in place, or for other Accessors a block at a time copied
+ *  out.  The lexer then styles the text in between with one ColourTo and moves its
+ *  StyleContext straight to the byte found, without running its per-character checks.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_BYTESCAN_H
+#define NPP_PLUGININTERFACE_EXTLEXER_BYTESCAN_H
+
+#include "NppPluginIface_ExtLexer.h"
+
+#include <cstdlib>
+#include "Accessor.h"
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+class ByteScanner {
+public:
+	//  stopBytes is NUL terminated, so NUL can't be one of them.
+	explicit ByteScanner( const char* stopBytes );
+
+	//  Returns how many bytes at the start of text aren't stop bytes, length if none are.
+	size_t span( const char* text, size_t length ) const;
+
+	bool isStop( unsigned char ch ) const { return ( _stop[ch] ); }
+
+private:
+	static const int MAX_VECTOR_BYTES = 16;	//  More stop bytes than this are scanned a byte at a time.
+
+	bool _stop[256];
+	char _bytes[MAX_VECTOR_BYTES];
+	int _nbBytes;							//  -1 when there are too many for the vector compare.
+};
+
+
+class TextSnapshot {
+	//  Private so the compiler doesn't generate them.
+	TextSnapshot( const TextSnapshot& source );
+	TextSnapshot& operator=( const TextSnapshot& );
+
+public:
+	explicit TextSnapshot( Accessor& styler );
+
+	//  Returns the text at position, and in length how much of it up to endPos the snapshot
+	//  holds.  The pointer is good until the next call.
+	const char* textAt( int position, int endPos, int& length );
+
+	//  Returns the character at position, only going back to the Accessor when position
+	//  leaves the current block.  Positions at or past endPos are read from the Accessor.
+	char charAt( int position, int endPos ) {
+		if ( position >= _start && position < _end ) return ( _text[position - _start] );
+		return ( fetch( position, endPos ) );
+	}
+
+	//  Returns how many bytes from position on, stopping at endPos, aren't stop bytes.
+	int span( const ByteScanner& scanner, int position, int endPos );
+
+private:
+	static const int BLOCK_SIZE = 16384;
+
+	char fetch( int position, int endPos );
+
+	Accessor& _styler;
+	const char* _held;						//  Text the Accessor holds, from _heldStart to _heldEnd.
+	int _heldStart;
+	int _heldEnd;
+	const char* _text;						//  _held or _block, from _start to _end.
+	int _start;
+	int _end;
+	char _block[BLOCK_SIZE];
+};
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_BYTESCAN_H
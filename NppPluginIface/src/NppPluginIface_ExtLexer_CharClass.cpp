@@ -0,0 +1,38 @@
+/* NppPluginIface_ExtLexer_CharClass.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing character classification tables.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_CharClass.h"
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+namespace char_class {
+
+const Flags ascii[256] = { NPP_CHARCLASS_TABLE( NPP_CHARCLASS_BASE ) };
+
+}  // End namespace:  char_class
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
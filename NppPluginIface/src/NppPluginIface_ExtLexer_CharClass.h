@@ -0,0 +1,135 @@
+/* NppPluginIface_ExtLexer_CharClass.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing character classification tables.
+ *
+ *  A lexer's inner loop asks the same questions of every character: is it a word character,
+ *  an operator, a bracket?  Scintilla's CharacterSet answers one question per object, with a
+ *  bounds check on each call, and the objects are built by constructors when the dll loads.
+ *  The C runtime's isalpha() and friends also depend on the current locale.
+ *
+ *  Here a lexer gets one table of 256 flag words holding all of its classes, so "a word
+ *  start, an operator or a bracket" is a single load and a mask.  The table is a const array
+ *  whose every entry is a constant expression, built by NPP_CHARCLASS_TABLE from a macro
+ *  giving the flags of a character code.  The compiler fills it in at build time, there is no
+ *  code run to set it up.
+ *
+ *      #define MY_CHAR_CLASS( c ) ( NPP_CHARCLASS_BASE( c ) | \
+ *          ( ( ( c ) == '_' ) ? WORD : 0 ) | ( ( ( c ) == '{' ) ? GROUP : 0 ) )
+ *
+ *      const lIface::char_class::Flags myClass[256] = { NPP_CHARCLASS_TABLE( MY_CHAR_CLASS ) };
+ *
+ *      if ( lIface::char_class::is( myClass, sc.ch, WORD | GROUP ) ) ...
+ *
+ *  The base classes follow the "C" locale and only hold ASCII characters.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_CHARCLASS_H
+#define NPP_PLUGININTERFACE_EXTLEXER_CHARCLASS_H
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+namespace char_class {
+
+typedef unsigned short Flags;
+
+//  The base classes.  A lexer's own classes start at FIRST_LEXER_FLAG.
+enum {
+	DIGIT				= 0x0001,		//  0-9
+	UPPER				= 0x0002,		//  A-Z
+	LOWER				= 0x0004,		//  a-z
+	BLANK				= 0x0008,		//  Space and tab.
+	SPACE				= 0x0010,		//  Space, \t \n \v \f and \r.
+	PUNCT				= 0x0020,		//  Printable ASCII that isn't a letter, digit or space.
+	HEXDIGIT			= 0x0040,		//  0-9 a-f A-F
+	ALPHA				= UPPER | LOWER,
+	ALNUM				= ALPHA | DIGIT,
+	FIRST_LEXER_FLAG	= 0x0080
+};
+
+//  The base classes of every byte.
+extern const Flags ascii[256];
+
+//  Character values past 0xFF ( as StyleContext gives for some multi-byte characters ) are
+//  classed as 0xFF, the way CharacterSet answers its valueAfter for them.
+inline Flags of( const Flags* table, int ch )
+{
+	return ( table[( ch & ~0xFF ) ? 0xFF : ch] );
+}
+
+inline bool is( const Flags* table, int ch, Flags mask )
+{
+	return ( ( of( table, ch ) & mask ) != 0 );
+}
+
+inline bool is( int ch, Flags mask )
+{
+	return ( is( ascii, ch, mask ) );
+}
+
+//  ASCII only, whatever the locale.
+inline int toLower( int ch )
+{
+	return ( is( ch, UPPER ) ? ( ch + ( 'a' - 'A' ) ) : ( ch ) );
+}
+
+inline int toUpper( int ch )
+{
+	return ( is( ch, LOWER ) ? ( ch - ( 'a' - 'A' ) ) : ( ch ) );
+}
+
+}  // End namespace:  char_class
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+
+//  The base class flags of character code c, as a constant expression.
+#define NPP_CHARCLASS_BASE( c ) ( \
+	( ( ( c ) >= '0' && ( c ) <= '9' ) ? npp_plugin::external_lexer::char_class::DIGIT : 0 ) | \
+	( ( ( c ) >= 'A' && ( c ) <= 'Z' ) ? npp_plugin::external_lexer::char_class::UPPER : 0 ) | \
+	( ( ( c ) >= 'a' && ( c ) <= 'z' ) ? npp_plugin::external_lexer::char_class::LOWER : 0 ) | \
+	( ( ( c ) == ' ' || ( c ) == '\t' ) ? npp_plugin::external_lexer::char_class::BLANK : 0 ) | \
+	( ( ( c ) == ' ' || ( ( c ) >= 0x09 && ( c ) <= 0x0D ) ) ? npp_plugin::external_lexer::char_class::SPACE : 0 ) | \
+	( ( ( c ) > 0x20 && ( c ) < 0x7F && !( ( c ) >= '0' && ( c ) <= '9' ) && \
+		!( ( c ) >= 'A' && ( c ) <= 'Z' ) && !( ( c ) >= 'a' && ( c ) <= 'z' ) ) ? \
+		npp_plugin::external_lexer::char_class::PUNCT : 0 ) | \
+	( ( ( ( c ) >= '0' && ( c ) <= '9' ) || ( ( c ) >= 'a' && ( c ) <= 'f' ) || \
+		( ( c ) >= 'A' && ( c ) <= 'F' ) ) ? npp_plugin::external_lexer::char_class::HEXDIGIT : 0 ) )
+
+//  The 256 initializers of a class table, F( c ) giving the flags of character code c.
+#define NPP_CHARCLASS_ROW( F, r ) \
+	F( r + 0x0 ), F( r + 0x1 ), F( r + 0x2 ), F( r + 0x3 ), F( r + 0x4 ), F( r + 0x5 ), \
+	F( r + 0x6 ), F( r + 0x7 ), F( r + 0x8 ), F( r + 0x9 ), F( r + 0xA ), F( r + 0xB ), \
+	F( r + 0xC ), F( r + 0xD ), F( r + 0xE ), F( r + 0xF )
+
+#define NPP_CHARCLASS_TABLE( F ) \
+	NPP_CHARCLASS_ROW( F, 0x00 ), NPP_CHARCLASS_ROW( F, 0x10 ), NPP_CHARCLASS_ROW( F, 0x20 ), \
+	NPP_CHARCLASS_ROW( F, 0x30 ), NPP_CHARCLASS_ROW( F, 0x40 ), NPP_CHARCLASS_ROW( F, 0x50 ), \
+	NPP_CHARCLASS_ROW( F, 0x60 ), NPP_CHARCLASS_ROW( F, 0x70 ), NPP_CHARCLASS_ROW( F, 0x80 ), \
+	NPP_CHARCLASS_ROW( F, 0x90 ), NPP_CHARCLASS_ROW( F, 0xA0 ), NPP_CHARCLASS_ROW( F, 0xB0 ), \
+	NPP_CHARCLASS_ROW( F, 0xC0 ), NPP_CHARCLASS_ROW( F, 0xD0 ), NPP_CHARCLASS_ROW( F, 0xE0 ), \
+	NPP_CHARCLASS_ROW( F, 0xF0 )
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_CHARCLASS_H
@@ -0,0 +1,336 @@
+/* NppPluginIface_ExtLexer_DirectAccessor.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a Scintilla Accessor that reads the
+ *  document text in place.
+ *
+ *  Anything not covered by the text pointer, the line starts scanned, or the style block read
+ *  is asked of Scintilla with the same message WindowAccessor would have sent.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_DirectAccessor.h"
+
+#include <cstring>
+#include <algorithm>
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+DirectAccessor::DirectAccessor( WindowID id, PropSet& props, unsigned int startPos, int length )
+	:_hView(static_cast<HWND>(id)), _props(props), _text(NULL), _textStart(0), _textEnd(0),
+	_lenDoc(0), _firstLine(-1), _scanPos(0), _styleBlockStart(0), _stylingStart(0),
+	_stylingMask(31), _startSeg(0), _chFlags(0), _chWhile(0)
+{
+	_lenDoc = send( SCI_GETLENGTH );
+
+	int start = static_cast<int>( startPos );
+	if ( ( length >= POINTER_MIN_RANGE ) || ( ( start == 0 ) && ( length >= _lenDoc ) ) )
+		_text = reinterpret_cast<const char*>( send( SCI_GETCHARACTERPOINTER ) );
+
+	if ( _text ) {
+		_textEnd = _lenDoc;
+	}
+	else {
+		//  Small ranges, and Scintillas without SCI_GETCHARACTERPOINTER, get a copied window.
+		_textStart = ( std::max )( start - bufferSize, 0 );
+		_textEnd = ( std::min )( start + length + bufferSize, _lenDoc );
+		_window.resize( _textEnd - _textStart + 1 );
+		TextRange tr = { { _textStart, _textEnd }, &_window[0] };
+		send( SCI_GETTEXTRANGE, 0, reinterpret_cast<LPARAM>( &tr ) );
+		_text = &_window[0];
+	}
+}
+
+DirectAccessor::~DirectAccessor()
+{
+	Flush();
+}
+
+LRESULT DirectAccessor::send( UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+	return ( ::SendMessage( _hView, Msg, wParam, lParam ) );
+}
+
+bool DirectAccessor::InternalIsLeadByte( char ch )
+{
+	if ( SC_CP_UTF8 == codePage ) return ( false );
+	return ( Platform::IsDBCSLeadByte( codePage, ch ) );
+}
+
+//  Loads the buffer around position the same way WindowAccessor does, but from the text itself.
+void DirectAccessor::Fill( int position )
+{
+	startPos = position - slopSize;
+	if ( startPos + bufferSize > _lenDoc ) startPos = _lenDoc - bufferSize;
+	if ( startPos < 0 ) startPos = 0;
+	endPos = startPos + bufferSize;
+	if ( endPos > _lenDoc ) endPos = _lenDoc;
+
+	if ( ( startPos >= _textStart ) && ( endPos <= _textEnd ) ) {
+		::memcpy( buf, _text + ( startPos - _textStart ), endPos - startPos );
+		buf[endPos - startPos] = '\0';
+	}
+	else {
+		TextRange tr = { { startPos, endPos }, buf };
+		send( SCI_GETTEXTRANGE, 0, reinterpret_cast<LPARAM>( &tr ) );
+	}
+}
+
+bool DirectAccessor::Match( int pos, const char* s )
+{
+	for ( int i = 0; *s; i++, s++ ) {
+		if ( *s != SafeGetCharAt( pos + i ) ) return ( false );
+	}
+	return ( true );
+}
+
+//  Styles still held answer for their positions, merged under the styling mask the way
+//  SCI_SETSTYLINGEX will merge them.
+char DirectAccessor::StyleAt( int position )
+{
+	char style = readStyle( position );
+
+	int held = position - _stylingStart;
+	if ( ( held >= 0 ) && ( held < int( _heldStyles.length() ) ) )
+		style = static_cast<char>( ( style & ~_stylingMask ) | ( _heldStyles[held] & _stylingMask ) );
+
+	return ( style );
+}
+
+//  Reads a block of styles around position; lexers step backwards as well as forwards.
+char DirectAccessor::readStyle( int position )
+{
+	if ( ( position < 0 ) || ( position >= _lenDoc ) ) return ( 0 );
+
+	int offset = position - _styleBlockStart;
+	if ( ( offset < 0 ) || ( offset >= int( _styleBlock.length() ) ) ) {
+		_styleBlockStart = position - STYLE_BLOCK_SIZE / 2;
+		if ( _styleBlockStart < 0 ) _styleBlockStart = 0;
+		int blockEnd = _styleBlockStart + STYLE_BLOCK_SIZE;
+		if ( blockEnd > _lenDoc ) blockEnd = _lenDoc;
+
+		//  SCI_GETSTYLEDTEXT gives a character and style byte for each position, then two NULs.
+		std::vector<char> styled( 2 * ( blockEnd - _styleBlockStart ) + 2 );
+		TextRange tr = { { _styleBlockStart, blockEnd }, &styled[0] };
+		send( SCI_GETSTYLEDTEXT, 0, reinterpret_cast<LPARAM>( &tr ) );
+
+		_styleBlock.resize( blockEnd - _styleBlockStart );
+		for ( size_t i = 0; i < _styleBlock.length(); i++ ) _styleBlock[i] = styled[2 * i + 1];
+		offset = position - _styleBlockStart;
+	}
+
+	return ( _styleBlock[offset] );
+}
+
+//  Line starts are scanned out of the text from the first line asked about, so going forward
+//  through the document costs no messages.  Lines before that one, and lines outside the
+//  text held, are asked of Scintilla.
+bool DirectAccessor::startLines( int line )
+{
+	int lineStart = send( SCI_POSITIONFROMLINE, line );
+	if ( ( lineStart < _textStart ) || ( lineStart > _textEnd ) ) return ( false );
+
+	_firstLine = line;
+	_lineStarts.assign( 1, lineStart );
+	_scanPos = lineStart;
+	return ( true );
+}
+
+//  Line ends are \r\n, \n, or a lone \r.
+bool DirectAccessor::scanNextLine()
+{
+	for ( int pos = _scanPos; pos < _textEnd; pos++ ) {
+		char ch = _text[pos - _textStart];
+		if ( ( ch == '\r' ) || ( ch == '\n' ) ) {
+			if ( ch == '\r' ) {
+				if ( pos + 1 < _textEnd ) {
+					if ( _text[pos + 1 - _textStart] == '\n' ) pos++;
+				}
+				else if ( _textEnd < _lenDoc ) {
+					//  The \n that may follow is past the window.
+					_scanPos = pos;
+					return ( false );
+				}
+			}
+			_scanPos = pos + 1;
+			_lineStarts.push_back( _scanPos );
+			return ( true );
+		}
+	}
+	_scanPos = _textEnd;
+	return ( false );
+}
+
+int DirectAccessor::GetLine( int position )
+{
+	//  A position is only placed from the text when every character up to it is held.
+	if ( ( position >= _textStart ) &&
+			( ( position < _textEnd ) || ( ( position == _lenDoc ) && ( _textEnd == _lenDoc ) ) ) ) {
+		if ( ( _firstLine >= 0 ) || startLines( send( SCI_LINEFROMPOSITION, position ) ) ) {
+			if ( position >= _lineStarts.front() ) {
+				while ( ( _lineStarts.back() <= position ) && scanNextLine() ) ;
+				std::vector<int>::const_iterator next =
+					std::upper_bound( _lineStarts.begin(), _lineStarts.end(), position );
+				return ( _firstLine + ( next - _lineStarts.begin() ) - 1 );
+			}
+		}
+	}
+	return ( send( SCI_LINEFROMPOSITION, position ) );
+}
+
+int DirectAccessor::LineStart( int line )
+{
+	if ( line == 0 ) return ( 0 );
+
+	if ( line > 0 ) {
+		if ( ( _firstLine >= 0 ) || startLines( line ) ) {
+			int index = line - _firstLine;
+			if ( index >= 0 ) {
+				while ( ( index >= int( _lineStarts.size() ) ) && scanNextLine() ) ;
+				if ( index < int( _lineStarts.size() ) ) return ( _lineStarts[index] );
+			}
+		}
+	}
+	return ( send( SCI_POSITIONFROMLINE, line ) );
+}
+
+int DirectAccessor::LevelAt( int line ) { return ( send( SCI_GETFOLDLEVEL, line ) ); }
+
+int DirectAccessor::Length() { return ( _lenDoc ); }
+
+//  Sends every style held since the last Flush() in one message.
+void DirectAccessor::Flush()
+{
+	startPos = extremePosition;
+
+	if ( !_heldStyles.empty() ) {
+		send( SCI_STARTSTYLING, _stylingStart, static_cast<unsigned char>( _stylingMask ) );
+		send( SCI_SETSTYLINGEX, _heldStyles.length(), reinterpret_cast<LPARAM>( _heldStyles.data() ) );
+		_stylingStart += _heldStyles.length();
+		_heldStyles.clear();
+		_styleBlock.clear();
+	}
+}
+
+int DirectAccessor::GetLineState( int line ) { return ( send( SCI_GETLINESTATE, line ) ); }
+
+int DirectAccessor::SetLineState( int line, int state ) { return ( send( SCI_SETLINESTATE, line, state ) ); }
+
+int DirectAccessor::GetPropertyInt( const char* key, int defaultValue )
+{
+	return ( _props.GetInt( key, defaultValue ) );
+}
+
+//  Same as WindowAccessor; the caller owns the returned string.
+char* DirectAccessor::GetProperties()
+{
+	return ( _props.ToString() );
+}
+
+//  Held styles belong to the old start, so they go out first.  Scintilla is told about the new
+//  start straight away, as WindowAccessor does, so its end styled position moves at the same time.
+void DirectAccessor::StartAt( unsigned int start, char chMask )
+{
+	Flush();
+	_stylingStart = start;
+	_stylingMask = chMask;
+	send( SCI_STARTSTYLING, start, static_cast<unsigned char>( chMask ) );
+}
+
+void DirectAccessor::SetFlags( char chFlags_, char chWhile_ )
+{
+	_chFlags = chFlags_;
+	_chWhile = chWhile_;
+}
+
+unsigned int DirectAccessor::GetStartSegment() { return ( _startSeg ); }
+
+void DirectAccessor::StartSegment( unsigned int pos ) { _startSeg = pos; }
+
+void DirectAccessor::ColourTo( unsigned int pos, int chAttr )
+{
+	//  Only perform styling if non empty range
+	if ( pos >= _startSeg ) {
+		if ( chAttr != _chWhile ) _chFlags = 0;
+		chAttr |= _chFlags;
+		_heldStyles.append( pos - _startSeg + 1, static_cast<char>( chAttr ) );
+	}
+	_startSeg = pos + 1;
+}
+
+void DirectAccessor::SetLevel( int line, int level ) { send( SCI_SETFOLDLEVEL, line, level ); }
+
+//  Same calculation as WindowAccessor::IndentAmount.
+int DirectAccessor::IndentAmount( int line, int* flags, PFNIsCommentLeader pfnIsCommentLeader )
+{
+	int end = Length();
+	int spaceFlags = 0;
+	int pos = LineStart( line );
+	char ch = ( *this )[pos];
+	int indent = 0;
+	bool inPrevPrefix = line > 0;
+	int posPrev = inPrevPrefix ? LineStart( line - 1 ) : 0;
+
+	while ( ( ch == ' ' || ch == '\t' ) && ( pos < end ) ) {
+		if ( inPrevPrefix ) {
+			char chPrev = ( *this )[posPrev++];
+			if ( chPrev == ' ' || chPrev == '\t' ) {
+				if ( chPrev != ch ) spaceFlags |= wsInconsistent;
+			}
+			else {
+				inPrevPrefix = false;
+			}
+		}
+		if ( ch == ' ' ) {
+			spaceFlags |= wsSpace;
+			indent++;
+		}
+		else {	// Tab
+			spaceFlags |= wsTab;
+			if ( spaceFlags & wsSpace ) spaceFlags |= wsSpaceTab;
+			indent = ( indent / 8 + 1 ) * 8;
+		}
+		ch = ( *this )[++pos];
+	}
+
+	*flags = spaceFlags;
+	indent += SC_FOLDLEVELBASE;
+	if ( ( LineStart( line ) == Length() ) || ( ch == ' ' ) || ( ch == '\t' ) || ( ch == '\n' ) ||
+			( ch == '\r' ) || ( pfnIsCommentLeader && ( *pfnIsCommentLeader )( *this, pos, end - pos ) ) )
+		return ( indent | SC_FOLDLEVELWHITEFLAG );
+	else
+		return ( indent );
+}
+
+void DirectAccessor::IndicatorFill( int start, int end, int indicator, int value )
+{
+	send( SCI_SETINDICATORCURRENT, indicator );
+	if ( value ) {
+		send( SCI_SETINDICATORVALUE, value );
+		send( SCI_INDICATORFILLRANGE, start, end - start );
+	}
+	else {
+		send( SCI_INDICATORCLEARRANGE, start, end - start );
+	}
+}
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
@@ -0,0 +1,143 @@
+/* NppPluginIface_ExtLexer_DirectAccessor.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a Scintilla Accessor that reads the
+ *  document text in place.
+ *
+ *  WindowAccessor copies the text a few thousand bytes at a time with SCI_GETTEXTRANGE, asks
+ *  Scintilla for every line and style it is given a position for, and sends its styles back
+ *  each time its small style buffer fills.  The DirectAccessor gets the text of the range
+ *  being lexed in one go and works from that instead:
+ *
+ *    # The Accessor buffer is refilled with a memcpy rather than a message.
+ *    # Line starts are found by scanning the text, starting from the first line asked for.
+ *    # Existing styles are read a block at a time with SCI_GETSTYLEDTEXT.
+ *    # Styles are held until Flush() and sent with one SCI_STARTSTYLING and SCI_SETSTYLINGEX.
+ *
+ *  SCI_GETCHARACTERPOINTER reads the text in place, but Scintilla has to move its gap to the
+ *  end of the document to hand it out, which copies everything after the caret.  That only
+ *  pays for large ranges and whole documents, the ones that the parallel colourising and fold
+ *  levels also need the whole text for.  Anything smaller ( a keystroke's relex ) is copied
+ *  with one SCI_GETTEXTRANGE of the range and a buffer's worth on either side, so the gap
+ *  stays put; positions outside that window are fetched with messages like WindowAccessor
+ *  does.  The pointer stays good because nothing edits the document while a lexer runs.
+ *  Lexers use it through the same Accessor interface.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_DIRECTACCESSOR_H
+#define NPP_PLUGININTERFACE_EXTLEXER_DIRECTACCESSOR_H
+
+#include "NppPluginIface_ExtLexer.h"
+
+#include <cstdlib>
+#include "Accessor.h"
+#include "PropSet.h"
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+class DirectAccessor : public Accessor {
+	//  Private so the compiler doesn't generate them.
+	DirectAccessor( const DirectAccessor& source );
+	DirectAccessor& operator=( const DirectAccessor& );
+
+public:
+	//  startPos and length are the range the lexer was asked for.
+	DirectAccessor( WindowID id, PropSet& props, unsigned int startPos, int length );
+	virtual ~DirectAccessor();				//  Flushes any styles still held.
+
+	//  <--- Accessor Interface --->
+	virtual bool Match( int pos, const char* s );
+	virtual char StyleAt( int position );
+	virtual int GetLine( int position );
+	virtual int LineStart( int line );
+	virtual int LevelAt( int line );
+	virtual int Length();
+	virtual void Flush();
+	virtual int GetLineState( int line );
+	virtual int SetLineState( int line, int state );
+	virtual int GetPropertyInt( const char* key, int defaultValue = 0 );
+	virtual char* GetProperties();
+
+	virtual void StartAt( unsigned int start, char chMask = 31 );
+	virtual void SetFlags( char chFlags_, char chWhile_ );
+	virtual unsigned int GetStartSegment();
+	virtual void StartSegment( unsigned int pos );
+	virtual void ColourTo( unsigned int pos, int chAttr );
+	virtual void SetLevel( int line, int level );
+	virtual int IndentAmount( int line, int* flags, PFNIsCommentLeader pfnIsCommentLeader = 0 );
+	virtual void IndicatorFill( int start, int end, int indicator, int value );
+
+	//  The whole document text, or NULL when only a window of it was copied.
+	const char* characterPointer() const
+	{
+		return ( ( _text && ( _textStart == 0 ) && ( _textEnd == _lenDoc ) ) ? ( _text ) : ( NULL ) );
+	}
+
+	//  The text held in memory, whole document or window, from start to end.
+	const char* heldText( int& start, int& end ) const
+	{
+		start = _textStart;
+		end = _textEnd;
+		return ( _text );
+	}
+
+protected:
+	virtual bool InternalIsLeadByte( char ch );
+	virtual void Fill( int position );
+
+private:
+	static const int STYLE_BLOCK_SIZE = 4096;
+	static const int POINTER_MIN_RANGE = 1 << 18;	//  Smallest range given the document pointer.
+
+	LRESULT send( UINT Msg, WPARAM wParam = 0, LPARAM lParam = 0 );
+	bool startLines( int line );			//  Scans lines from this one on, false if there's no such line.
+	bool scanNextLine();					//  Adds the next line start, false at the end.
+	char readStyle( int position );			//  What Scintilla has now, ignoring held styles.
+
+	HWND _hView;
+	PropSet& _props;
+	const char* _text;						//  Text from _textStart to _textEnd.
+	int _textStart;
+	int _textEnd;
+	std::vector<char> _window;				//  Owns _text when it is only a window.
+	int _lenDoc;
+
+	int _firstLine;							//  Line of _lineStarts[0], -1 until first used.
+	std::vector<int> _lineStarts;
+	int _scanPos;							//  Where the next line end search starts.
+
+	std::string _styleBlock;				//  Styles read from Scintilla, from _styleBlockStart.
+	int _styleBlockStart;
+
+	std::string _heldStyles;				//  Styles not sent yet, from _stylingStart.
+	int _stylingStart;
+	char _stylingMask;
+	unsigned int _startSeg;
+	char _chFlags;
+	char _chWhile;
+};
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_DIRECTACCESSOR_H
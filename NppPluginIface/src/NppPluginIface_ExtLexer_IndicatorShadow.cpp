@@ -0,0 +1,297 @@
+/* NppPluginIface_ExtLexer_IndicatorShadow.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension keeping a copy of the indicators a lexer has drawn
+ *  on one document.
+ *
+ *  Runs are kept in a sorted vector per indicator; a highlighter pass fills in document order,
+ *  so nearly every paint lands at or near the end of the vector.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_IndicatorShadow.h"
+
+#include <climits>
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+IndicatorShadow::IndicatorShadow()
+	:_runs(NB_INDICATORS), _tracked(NB_INDICATORS, false)
+{
+}
+
+//  Text inserted at pos pushes later runs along; nothing is known about the new text itself.
+void IndicatorShadow::insertText( int pos, int length )
+{
+	if ( length <= 0 ) return;
+
+	for ( int indicator = 0; indicator < NB_INDICATORS; indicator++ ) {
+		if ( !_tracked[indicator] ) continue;
+		Runs& runs = _runs[indicator];
+
+		size_t i = firstEndingAfter( runs, pos );
+		if ( i < runs.size() && runs[i].start < pos ) {
+			Run tail = runs[i];
+			tail.start = pos;
+			runs[i].end = pos;
+			runs.insert( runs.begin() + i + 1, tail );
+			i++;
+		}
+		for ( ; i < runs.size(); i++ ) {
+			runs[i].start += length;
+			runs[i].end += length;
+		}
+
+		paint( runs, pos, pos + length, UNKNOWN );
+	}
+}
+
+//  Runs inside deleted text go, later runs move back.
+void IndicatorShadow::deleteText( int pos, int length )
+{
+	if ( length <= 0 ) return;
+	int deleteEnd = pos + length;
+
+	for ( int indicator = 0; indicator < NB_INDICATORS; indicator++ ) {
+		if ( !_tracked[indicator] ) continue;
+		Runs& runs = _runs[indicator];
+
+		size_t first = firstEndingAfter( runs, pos );
+		size_t kept = first;
+		for ( size_t i = first; i < runs.size(); i++ ) {
+			Run run = runs[i];
+			run.start = ( run.start <= pos ) ? ( run.start ) :
+					( ( run.start < deleteEnd ) ? ( pos ) : ( run.start - length ) );
+			run.end = ( run.end < deleteEnd ) ? ( pos ) : ( run.end - length );
+			if ( run.end > run.start ) runs[kept++] = run;
+		}
+		runs.erase( runs.begin() + kept, runs.end() );
+
+		if ( first > 0 ) first--;
+		mergeAround( runs, first, first + 1 );
+	}
+}
+
+void IndicatorShadow::clear()
+{
+	for ( int indicator = 0; indicator < NB_INDICATORS; indicator++ ) {
+		_runs[indicator].clear();
+		_tracked[indicator] = false;
+	}
+}
+
+//  Replays fills over a copy of the covered span and sends only what differs from the shadow.
+int IndicatorShadow::apply( Accessor& target, const std::vector<Fill>& fills )
+{
+	int nbSent = 0;
+	int docLength = target.Length();
+	int spanStart = INT_MAX;
+	int spanEnd = 0;
+	std::vector<bool> touched( NB_INDICATORS, false );
+
+	std::vector<Fill>::const_iterator iFill;
+	for ( iFill = fills.begin(); iFill != fills.end(); iFill++ ) {
+		if ( iFill->indicator < 0 || iFill->indicator >= NB_INDICATORS ) {
+			//  Not something this shadow keeps, pass it straight on.
+			target.IndicatorFill( iFill->start, iFill->end, iFill->indicator, iFill->value );
+			nbSent++;
+			continue;
+		}
+		if ( iFill->end <= iFill->start ) continue;
+
+		touched[iFill->indicator] = true;
+		if ( iFill->start < spanStart ) spanStart = iFill->start;
+		if ( iFill->end > spanEnd ) spanEnd = iFill->end;
+	}
+	if ( spanStart < 0 ) spanStart = 0;
+	if ( spanEnd > docLength ) spanEnd = docLength;
+	if ( spanStart >= spanEnd ) return ( nbSent );
+
+	for ( int indicator = 0; indicator < NB_INDICATORS; indicator++ ) {
+		if ( !touched[indicator] ) continue;
+		Runs& runs = _runs[indicator];
+
+		if ( !_tracked[indicator] ) {
+			runs.clear();
+			paint( runs, 0, docLength, UNKNOWN );
+			_tracked[indicator] = true;
+		}
+
+		Runs drawn = clip( runs, spanStart, spanEnd );
+		Runs wanted = drawn;
+		for ( iFill = fills.begin(); iFill != fills.end(); iFill++ ) {
+			if ( iFill->indicator != indicator ) continue;
+			paint( wanted, ( iFill->start < spanStart ) ? ( spanStart ) : ( iFill->start ),
+					( iFill->end > spanEnd ) ? ( spanEnd ) : ( iFill->end ), iFill->value );
+		}
+
+		nbSent += sendDifferences( target, indicator, drawn, wanted, spanStart, spanEnd );
+
+		//  Splice what the span looks like now into the shadow.
+		paint( runs, spanStart, spanEnd, 0 );
+		size_t index = firstEndingAfter( runs, spanStart );
+		runs.insert( runs.begin() + index, wanted.begin(), wanted.end() );
+		mergeAround( runs, ( index > 0 ) ? ( index - 1 ) : ( 0 ), index + wanted.size() );
+	}
+
+	return ( nbSent );
+}
+
+//  Index of the first run ending after pos, a binary search since runs don't overlap.
+size_t IndicatorShadow::firstEndingAfter( const Runs& runs, int pos )
+{
+	size_t low = 0;
+	size_t high = runs.size();
+	while ( low < high ) {
+		size_t middle = ( low + high ) / 2;
+		if ( runs[middle].end <= pos ) low = middle + 1;
+		else high = middle;
+	}
+	return ( low );
+}
+
+//  Sets start to end to value, zero leaving no run there.
+void IndicatorShadow::paint( Runs& runs, int start, int end, int value )
+{
+	if ( end <= start ) return;
+
+	size_t first = firstEndingAfter( runs, start );
+	size_t last = first;
+	while ( last < runs.size() && runs[last].start < end ) last++;
+
+	Runs pieces;
+	if ( first < last && runs[first].start < start ) {
+		Run head = { runs[first].start, start, runs[first].value };
+		pieces.push_back( head );
+	}
+	if ( value != 0 ) {
+		Run run = { start, end, value };
+		pieces.push_back( run );
+	}
+	if ( first < last && runs[last - 1].end > end ) {
+		Run tail = { end, runs[last - 1].end, runs[last - 1].value };
+		pieces.push_back( tail );
+	}
+
+	runs.erase( runs.begin() + first, runs.begin() + last );
+	runs.insert( runs.begin() + first, pieces.begin(), pieces.end() );
+	mergeAround( runs, ( first > 0 ) ? ( first - 1 ) : ( 0 ), first + pieces.size() );
+}
+
+//  Joins touching runs of the same value from first up to and including last.
+void IndicatorShadow::mergeAround( Runs& runs, size_t first, size_t last )
+{
+	if ( runs.empty() ) return;
+	if ( last >= runs.size() ) last = runs.size() - 1;
+
+	for ( size_t i = last; i > first; i-- ) {
+		if ( runs[i - 1].end == runs[i].start && runs[i - 1].value == runs[i].value ) {
+			runs[i - 1].end = runs[i].end;
+			runs.erase( runs.begin() + i );
+		}
+	}
+}
+
+//  Copy of the runs within start to end.
+IndicatorShadow::Runs IndicatorShadow::clip( const Runs& runs, int start, int end )
+{
+	Runs clipped;
+	for ( size_t i = firstEndingAfter( runs, start ); i < runs.size() && runs[i].start < end; i++ ) {
+		Run run = runs[i];
+		if ( run.start < start ) run.start = start;
+		if ( run.end > end ) run.end = end;
+		clipped.push_back( run );
+	}
+	return ( clipped );
+}
+
+//  Walks both run lists together and sends one fill or clear per stretch that changed.
+int IndicatorShadow::sendDifferences( Accessor& target, int indicator, const Runs& drawn,
+		const Runs& wanted, int start, int end )
+{
+	int nbSent = 0;
+	size_t iDrawn = 0;
+	size_t iWanted = 0;
+	int pendingStart = -1;
+	int pendingEnd = -1;
+	int pendingValue = 0;
+
+	for ( int pos = start; pos < end; ) {
+		while ( iDrawn < drawn.size() && drawn[iDrawn].end <= pos ) iDrawn++;
+		while ( iWanted < wanted.size() && wanted[iWanted].end <= pos ) iWanted++;
+
+		int drawnValue = 0;
+		int next = end;
+		if ( iDrawn < drawn.size() ) {
+			if ( drawn[iDrawn].start <= pos ) {
+				drawnValue = drawn[iDrawn].value;
+				next = drawn[iDrawn].end;
+			}
+			else {
+				next = drawn[iDrawn].start;
+			}
+		}
+
+		int wantedValue = 0;
+		if ( iWanted < wanted.size() ) {
+			if ( wanted[iWanted].start <= pos ) {
+				wantedValue = wanted[iWanted].value;
+				if ( wanted[iWanted].end < next ) next = wanted[iWanted].end;
+			}
+			else if ( wanted[iWanted].start < next ) {
+				next = wanted[iWanted].start;
+			}
+		}
+		if ( next > end ) next = end;
+
+		//  Still unknown means no fill touched it; leave whatever is there alone.
+		bool changed = ( wantedValue != UNKNOWN && wantedValue != drawnValue );
+
+		if ( changed && pendingEnd == pos && pendingValue == wantedValue ) {
+			pendingEnd = next;
+		}
+		else {
+			if ( pendingStart != -1 ) {
+				target.IndicatorFill( pendingStart, pendingEnd, indicator, pendingValue );
+				nbSent++;
+				pendingStart = -1;
+			}
+			if ( changed ) {
+				pendingStart = pos;
+				pendingEnd = next;
+				pendingValue = wantedValue;
+			}
+		}
+
+		pos = next;
+	}
+
+	if ( pendingStart != -1 ) {
+		target.IndicatorFill( pendingStart, pendingEnd, indicator, pendingValue );
+		nbSent++;
+	}
+
+	return ( nbSent );
+}
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
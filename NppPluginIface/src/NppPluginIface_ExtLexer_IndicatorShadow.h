@@ -0,0 +1,93 @@
+/* NppPluginIface_ExtLexer_IndicatorShadow.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension keeping a copy of the indicators a lexer has drawn
+ *  on one document, so a relex only sends the fills and clears that actually change something.
+ *
+ *  A lexer's highlighter pass clears its range and fills each highlight again.  Given that
+ *  list of fills, apply() works out what the range should look like, compares it with what
+ *  was drawn last time, and sends only the differences to the Accessor.
+ *
+ *  The owner keeps the copy in step with the document by passing on text inserts and deletes.
+ *  Positions nothing is known about, an indicator's whole document the first time it is used
+ *  and inserted text, are treated as unknown and always get sent.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_INDICATORSHADOW_H
+#define NPP_PLUGININTERFACE_EXTLEXER_INDICATORSHADOW_H
+
+#include "NppPluginIface_ExtLexer.h"
+
+#include <cstdlib>
+#include "Accessor.h"
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+class IndicatorShadow {
+public:
+	//  One IndicatorFill() call, a zero value clears.
+	struct Fill {
+		int start;
+		int end;
+		int indicator;
+		int value;
+	};
+
+	IndicatorShadow();
+
+	//  <--- Document Changes --->
+	void insertText( int pos, int length );
+	void deleteText( int pos, int length );
+	void clear();								//  Forget everything; all positions are unknown.
+
+	//  Sends target the fills and clears that leave the span the fills cover looking the same as
+	//  replaying every fill would, and returns how many were sent.
+	int apply( Accessor& target, const std::vector<Fill>& fills );
+
+private:
+	static const int UNKNOWN = -1;
+	static const int NB_INDICATORS = 32;
+
+	struct Run {
+		int start;
+		int end;
+		int value;				//  Non-zero; UNKNOWN where nothing is known.
+	};
+	typedef std::vector<Run> Runs;
+
+	static size_t firstEndingAfter( const Runs& runs, int pos );
+	static void paint( Runs& runs, int start, int end, int value );
+	static void mergeAround( Runs& runs, size_t first, size_t last );
+	static Runs clip( const Runs& runs, int start, int end );
+	static int sendDifferences( Accessor& target, int indicator, const Runs& drawn,
+			const Runs& wanted, int start, int end );
+
+	std::vector<Runs> _runs;					//  Sorted, non-overlapping runs per indicator.
+	std::vector<bool> _tracked;
+};
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_INDICATORSHADOW_H
@@ -0,0 +1,292 @@
+/* NppPluginIface_ExtLexer_Keywords.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a keyword classifier for external lexers.
+ *
+ *  Whole identifier words live in a hash table, one slot per distinct folded word.  Prefix
+ *  words live in a trie.  classify() folds each character of the identifier once, adding it
+ *  to the hash and stepping the trie with it, so every prefix word the identifier starts with
+ *  is seen in the same pass that finds the whole identifier.  The trie walk usually ends
+ *  after a character or two, and the hash stops once the identifier is longer than any word.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_Keywords.h"
+
+#include <climits>
+#include <cstring>
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const unsigned int FNV_OFFSET = 2166136261U;
+const unsigned int FNV_PRIME = 16777619U;
+const int INITIAL_SLOTS = 64;
+
+inline bool isWordSeparator( char ch )
+{
+	return ( ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' );
+}
+
+}  // End: Un-named namespace
+
+
+KeywordClassifier::KeywordClassifier( bool ignoreCase )
+{
+	clear( ignoreCase );
+}
+
+//  Drops all words and sets how case is compared for the words added next.
+void KeywordClassifier::clear( bool ignoreCase )
+{
+	for ( int ch = 0; ch < 256; ch++ ) {
+		_fold[ch] = static_cast<unsigned char>(
+				( ignoreCase && ch >= 'A' && ch <= 'Z' ) ? ( ch - 'A' + 'a' ) : ( ch ) );
+	}
+
+	Slot empty = { -1, 0, 0, INT_MAX, NO_MATCH };
+	_slots.assign( INITIAL_SLOTS, empty );
+	_pool.clear();
+
+	PrefixNode root = { 0, -1, -1, INT_MAX, NO_MATCH };
+	_prefixNodes.assign( 1, root );
+	for ( int ch = 0; ch < 256; ch++ ) _rootChildren[ch] = -1;
+
+	_nbWords = 0;
+	_maxLength = 0;
+	_nextRank = 0;
+}
+
+//  Adds each whitespace separated word of a keyword list.
+void KeywordClassifier::addWords( const char* wordList, int style, MatchMode mode )
+{
+	if ( !wordList ) return;
+
+	const char* p = wordList;
+	while ( *p ) {
+		while ( *p && isWordSeparator( *p ) ) p++;
+		const char* wordStart = p;
+		while ( *p && !isWordSeparator( *p ) ) p++;
+		if ( p > wordStart ) {
+			if ( mode == MATCH_WORDLIST && *wordStart == '^' ) {
+				if ( p - wordStart > 1 ) insert( wordStart + 1, p - wordStart - 1, style, true );
+			}
+			else {
+				insert( wordStart, p - wordStart, style, ( mode == MATCH_PREFIX ) );
+			}
+		}
+	}
+}
+
+//  Adds a single word.
+void KeywordClassifier::addWord( const char* word, int style, MatchMode mode )
+{
+	if ( !word || !*word ) return;
+
+	if ( mode == MATCH_WORDLIST && *word == '^' ) {
+		if ( word[1] ) insert( word + 1, strlen( word + 1 ), style, true );
+	}
+	else {
+		insert( word, strlen( word ), style, ( mode == MATCH_PREFIX ) );
+	}
+}
+
+//  Compares source with the one the classifier was last built from.
+bool KeywordClassifier::needsRebuild( const std::string& source )
+{
+	if ( source == _source ) return ( false );
+
+	_source = source;
+	return ( true );
+}
+
+//  Returns the style of the highest precedence list matching s, or NO_MATCH.
+int KeywordClassifier::classify( const char* s ) const
+{
+	if ( _nbWords == 0 || !s ) return ( NO_MATCH );
+
+	int bestRank = INT_MAX;
+	int bestStyle = NO_MATCH;
+	unsigned int hash = FNV_OFFSET;
+	int length = 0;
+	int node = ( _prefixNodes.size() > 1 ) ? ( 0 ) : ( -1 );
+
+	for ( const unsigned char* p = reinterpret_cast<const unsigned char*>( s ); *p; p++ ) {
+		unsigned char ch = _fold[*p];
+
+		if ( node != -1 ) {
+			node = ( node == 0 ) ? ( _rootChildren[ch] ) : ( findChild( node, ch ) );
+			if ( node != -1 && _prefixNodes[node].rank < bestRank ) {
+				bestRank = _prefixNodes[node].rank;
+				bestStyle = _prefixNodes[node].style;
+			}
+		}
+
+		//  Nothing longer than the longest word can match whole, only prefixes are left.
+		length++;
+		if ( length > _maxLength ) {
+			if ( node == -1 ) return ( bestStyle );
+			continue;
+		}
+		hash = ( hash ^ ch ) * FNV_PRIME;
+	}
+
+	if ( length <= _maxLength ) {
+		const Slot* slot = find( s, length, hash );
+		if ( slot && slot->rank < bestRank ) bestStyle = slot->style;
+	}
+
+	return ( bestStyle );
+}
+
+//  Adds a word, keeping the first style given for it as the one with the higher precedence.
+void KeywordClassifier::insert( const char* word, int length, int style, bool prefix )
+{
+	std::string folded( word, length );
+	unsigned int hash = FNV_OFFSET;
+	for ( int i = 0; i < length; i++ ) {
+		folded[i] = static_cast<char>( _fold[static_cast<unsigned char>( folded[i] )] );
+		hash = ( hash ^ static_cast<unsigned char>( folded[i] ) ) * FNV_PRIME;
+	}
+
+	if ( prefix ) {
+		insertPrefix( folded, style );
+		return;
+	}
+
+	Slot* slot = const_cast<Slot*>( find( folded.c_str(), length, hash ) );
+	if ( !slot ) {
+		if ( ( _nbWords + 1 ) * 2 > static_cast<int>( _slots.size() ) ) grow();
+
+		unsigned int mask = _slots.size() - 1;
+		unsigned int index = hash & mask;
+		while ( _slots[index].offset != -1 ) index = ( index + 1 ) & mask;
+
+		slot = &_slots[index];
+		slot->offset = _pool.size();
+		slot->length = length;
+		slot->hash = hash;
+		_pool.append( folded );
+		_nbWords++;
+		if ( length > _maxLength ) _maxLength = length;
+	}
+
+	int rank = _nextRank++;
+	if ( slot->rank == INT_MAX ) {
+		slot->rank = rank;
+		slot->style = style;
+	}
+}
+
+//  Adds the nodes a folded prefix word needs, children kept in character order.
+void KeywordClassifier::insertPrefix( const std::string& folded, int style )
+{
+	int node = 0;
+	for ( size_t i = 0; i < folded.size(); i++ ) {
+		unsigned char ch = static_cast<unsigned char>( folded[i] );
+
+		int child = ( node == 0 ) ? ( _rootChildren[ch] ) : ( findChild( node, ch ) );
+		if ( child == -1 ) {
+			PrefixNode added = { ch, -1, -1, INT_MAX, NO_MATCH };
+			child = _prefixNodes.size();
+
+			if ( node == 0 ) {
+				_rootChildren[ch] = child;
+			}
+			else {
+				//  Find the sibling to link after, the vector may move once the node is added.
+				int prev = -1;
+				int next = _prefixNodes[node].firstChild;
+				while ( next != -1 && _prefixNodes[next].ch < ch ) {
+					prev = next;
+					next = _prefixNodes[next].nextSibling;
+				}
+				added.nextSibling = next;
+				if ( prev == -1 ) _prefixNodes[node].firstChild = child;
+				else _prefixNodes[prev].nextSibling = child;
+			}
+			_prefixNodes.push_back( added );
+		}
+		node = child;
+	}
+
+	int rank = _nextRank++;
+	if ( _prefixNodes[node].rank == INT_MAX ) {
+		_prefixNodes[node].rank = rank;
+		_prefixNodes[node].style = style;
+		_nbWords++;
+	}
+}
+
+//  Returns the child of node for ch, or -1.
+int KeywordClassifier::findChild( int node, unsigned char ch ) const
+{
+	for ( int child = _prefixNodes[node].firstChild; child != -1; child = _prefixNodes[child].nextSibling ) {
+		if ( _prefixNodes[child].ch >= ch ) return ( ( _prefixNodes[child].ch == ch ) ? ( child ) : ( -1 ) );
+	}
+	return ( -1 );
+}
+
+//  Finds the slot of the folded word equal to the first length characters of s.
+const KeywordClassifier::Slot* KeywordClassifier::find( const char* s, int length,
+		unsigned int hash ) const
+{
+	unsigned int mask = _slots.size() - 1;
+	unsigned int index = hash & mask;
+
+	while ( _slots[index].offset != -1 ) {
+		const Slot& slot = _slots[index];
+		if ( slot.hash == hash && slot.length == length ) {
+			const char* word = _pool.data() + slot.offset;
+			int i = 0;
+			while ( i < length && word[i] == static_cast<char>( _fold[static_cast<unsigned char>( s[i] )] ) ) i++;
+			if ( i == length ) return ( &slot );
+		}
+		index = ( index + 1 ) & mask;
+	}
+
+	return ( NULL );
+}
+
+//  Doubles the table and places every word again.
+void KeywordClassifier::grow()
+{
+	std::vector<Slot> oldSlots;
+	oldSlots.swap( _slots );
+
+	Slot empty = { -1, 0, 0, INT_MAX, NO_MATCH };
+	_slots.assign( oldSlots.size() * 2, empty );
+	unsigned int mask = _slots.size() - 1;
+
+	std::vector<Slot>::const_iterator iSlot;
+	for ( iSlot = oldSlots.begin(); iSlot != oldSlots.end(); iSlot++ ) {
+		if ( iSlot->offset == -1 ) continue;
+		unsigned int index = iSlot->hash & mask;
+		while ( _slots[index].offset != -1 ) index = ( index + 1 ) & mask;
+		_slots[index] = *iSlot;
+	}
+}
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
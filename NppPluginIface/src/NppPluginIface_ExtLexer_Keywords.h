@@ -0,0 +1,111 @@
+/* NppPluginIface_ExtLexer_Keywords.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a keyword classifier for external lexers.
+ *
+ *  Instead of testing an identifier against each of a lexer's keyword lists in turn, all of
+ *  the lists are added to one KeywordClassifier in precedence order, each with the style its
+ *  words get.  classify() then walks the identifier once and returns the style of the first
+ *  list that holds it, or NO_MATCH.
+ *
+ *  Words can match whole identifiers only, the beginning of identifiers ( the user defined
+ *  language 'prefix mode' ), or follow Scintilla's WordList::InList() where a word starting
+ *  with '^' matches the beginning of identifiers and all others match whole identifiers.
+ *
+ *  When built to ignore case, words and identifiers are compared with A-Z folded to a-z.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_KEYWORDS_H
+#define NPP_PLUGININTERFACE_EXTLEXER_KEYWORDS_H
+
+#include "NppPluginIface_ExtLexer.h"
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+class KeywordClassifier {
+public:
+	static const int NO_MATCH = -1;
+
+	enum MatchMode {
+		MATCH_WORD,				//  Words match whole identifiers.
+		MATCH_PREFIX,			//  Words match identifiers beginning with them.
+		MATCH_WORDLIST			//  As WordList::InList(), '^' words match as prefixes.
+	};
+
+	explicit KeywordClassifier( bool ignoreCase = false );
+
+	//  <--- Building --->
+	//  Lists must be added from the highest precedence to the lowest.
+	void clear( bool ignoreCase );
+	void addWords( const char* wordList, int style, MatchMode mode = MATCH_WORDLIST );	//  Whitespace separated.
+	void addWord( const char* word, int style, MatchMode mode = MATCH_WORDLIST );
+
+	//  Returns true, and remembers source, when source differs from the one last given.  Lets
+	//  a lexer rebuild only when its keyword lists or the settings it builds with change.
+	bool needsRebuild( const std::string& source );
+
+	//  <--- Lookup --->
+	int classify( const char* s ) const;			//  Style of the winning list or NO_MATCH.
+	bool empty() const { return ( _nbWords == 0 ); }
+
+private:
+	//  A whole identifier word.
+	struct Slot {
+		int offset;					//  Into _pool, -1 for an empty slot.
+		int length;
+		unsigned int hash;
+		int rank;					//  Precedence, lower wins.
+		int style;
+	};
+
+	//  A character of a prefix word; siblings are kept in character order.
+	struct PrefixNode {
+		unsigned char ch;
+		int firstChild;				//  -1 for none.
+		int nextSibling;			//  -1 for none.
+		int rank;					//  Precedence of the prefix ending here, INT_MAX for none.
+		int style;
+	};
+
+	void insert( const char* word, int length, int style, bool prefix );
+	void insertPrefix( const std::string& folded, int style );
+	const Slot* find( const char* s, int length, unsigned int hash ) const;
+	int findChild( int node, unsigned char ch ) const;
+	void grow();
+
+	unsigned char _fold[256];
+	std::vector<Slot> _slots;		//  Open addressing, size is a power of two.
+	std::string _pool;				//  Folded words.
+	std::vector<PrefixNode> _prefixNodes;	//  Trie of the folded prefix words, [0] is the root.
+	int _rootChildren[256];			//  The root's children by character, -1 for none.
+	std::string _source;
+	int _nbWords;
+	int _maxLength;
+	int _nextRank;
+};
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_KEYWORDS_H
@@ -0,0 +1,96 @@
+/* NppPluginIface_ExtLexer_LexerInputs.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*
+ *  Notepad++ Plugin Interface Lib extension keeping a lexer's keyword lists and properties
+ *  ready to use between calls.
+ *
+ *  The text each was built from is kept and compared in full, the same way the keyword
+ *  classifier decides on a rebuild; the comparison stops at the first difference and costs
+ *  far less than tokenizing or sorting the lists again.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_LexerInputs.h"
+
+#include <cstring>
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+LexerInputs::LexerInputs()
+	:_props(NULL), _lists(1, static_cast<WordList*>(NULL)), _listsVersion(0)
+{
+}
+
+LexerInputs::~LexerInputs()
+{
+	for ( size_t i = 0; i < _lists.size(); i++ ) delete _lists[i];
+	delete _props;
+}
+
+PropSet& LexerInputs::properties( const char* props )
+{
+	if ( props == NULL ) props = "";
+
+	//  PropSet::SetMultiple() only adds and replaces, so a change starts a new PropSet.
+	if ( _props == NULL || _propsText != props ) {
+		delete _props;
+		_props = new PropSet();
+		_props->SetMultiple( props );
+		_propsText = props;
+	}
+
+	return ( *_props );
+}
+
+WordList** LexerInputs::wordLists( char* words[] )
+{
+	size_t nbLists = 0;
+	while ( words[nbLists] ) nbLists++;
+
+	//  Drop the lists beyond the ones given, keeping the terminating NULL.
+	while ( _listTexts.size() > nbLists ) {
+		delete _lists[_listTexts.size() - 1];
+		_lists[_listTexts.size() - 1] = NULL;
+		_listTexts.pop_back();
+		_lists.pop_back();
+		_listsVersion++;
+	}
+
+	for ( size_t i = 0; i < nbLists; i++ ) {
+		if ( i == _listTexts.size() ) {
+			_listTexts.push_back( std::string() );
+			_lists.back() = new WordList();		//  (works or THROWS bad_alloc EXCEPTION)
+			_lists.push_back( NULL );
+		}
+		else if ( _listTexts[i] == words[i] ) {
+			continue;
+		}
+
+		_lists[i]->Set( words[i] );
+		_listTexts[i] = words[i];
+		_listsVersion++;
+	}
+
+	return ( &_lists[0] );
+}
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
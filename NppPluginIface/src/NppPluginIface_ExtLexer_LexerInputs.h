@@ -0,0 +1,77 @@
+/* NppPluginIface_ExtLexer_LexerInputs.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*
+ *  Notepad++ Plugin Interface Lib extension keeping a lexer's keyword lists and properties
+ *  ready to use between calls.
+ *
+ *  Scintilla hands an external lexer its keyword lists and properties as text on every call,
+ *  and the usual entry point parses the properties into a fresh PropSet and builds a fresh
+ *  WordList from each list, only to throw them all away on return.  A lexer that keeps one
+ *  LexerInputs instead gets back the same PropSet and WordLists for as long as the text they
+ *  came from stays the same; only a list or property string that changed is parsed again.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_LEXERINPUTS_H
+#define NPP_PLUGININTERFACE_EXTLEXER_LEXERINPUTS_H
+
+#include "NppPluginIface_ExtLexer.h"
+
+#include <cstdlib>
+#include "PropSet.h"
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+class LexerInputs {
+	//  Private so the compiler doesn't generate them.
+	LexerInputs( const LexerInputs& source );
+	LexerInputs& operator=( const LexerInputs& );
+
+public:
+	LexerInputs();
+	~LexerInputs();
+
+	//  Returns a PropSet holding props, parsed again only when props differs from last time.
+	PropSet& properties( const char* props );
+
+	//  Returns a NULL terminated array with a WordList for each of words' lists.  A WordList is
+	//  only rebuilt when the text of its list changed.  The array is good until the next call.
+	WordList** wordLists( char* words[] );
+	int wordListCount() const { return ( _listTexts.size() ); }
+
+	//  Goes up each time wordLists() rebuilds, adds, or drops a list, so a lexer can key what it
+	//  builds from the lists on this instead of on their text.
+	unsigned int listsVersion() const { return ( _listsVersion ); }
+
+private:
+	std::string _propsText;
+	PropSet* _props;
+
+	std::vector<std::string> _listTexts;
+	std::vector<WordList*> _lists;			//  One more than _listTexts, ending with NULL.
+	unsigned int _listsVersion;
+};
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_LEXERINPUTS_H
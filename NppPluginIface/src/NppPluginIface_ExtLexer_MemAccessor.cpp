@@ -0,0 +1,383 @@
+/* NppPluginIface_ExtLexer_MemAccessor.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a Scintilla Accessor over an in-memory
+ *  document.
+ *
+ *  The style setting functions mirror WindowAccessor, except that styles are written straight
+ *  into the style bytes instead of being buffered and sent with SCI_SETSTYLINGEX.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_MemAccessor.h"
+
+//  <--- STL --->
+#include <sstream>
+#include <iomanip>
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const int NB_STORED_INDICATORS = 8;
+
+//  FNV-1a hash, enough to tell whether two runs produced the same bytes.
+ULONGLONG hashBytes( const void* data, size_t length )
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>( data );
+	ULONGLONG hash = 14695981039346656037ULL;
+	for ( size_t i = 0; i < length; i++ ) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return ( hash );
+}
+
+}  // End: Un-named namespace
+
+
+MemAccessor::MemAccessor( const std::string& text, const char* props )
+	:_text(text), _styles(text.length(), '\0'), _indicators(text.length(), '\0'),
+	_stylingPos(0), _stylingMask(31), _startSeg(0), _chFlags(0), _chWhile(0), _endStyled(0),
+	_nbIndicatorFills(0)
+{
+	if ( props ) _props.SetMultiple( props );
+	rebuildLineStarts( 0 );
+	_levels.resize( _lineStarts.size(), SC_FOLDLEVELBASE );
+	_lineStates.resize( _lineStarts.size(), 0 );
+}
+
+MemAccessor::~MemAccessor()
+{
+}
+
+//  Loads the buffer around position the same way WindowAccessor does.
+void MemAccessor::Fill( int position )
+{
+	int lenDoc = _text.length();
+	startPos = position - slopSize;
+	if ( startPos + bufferSize > lenDoc ) startPos = lenDoc - bufferSize;
+	if ( startPos < 0 ) startPos = 0;
+	endPos = startPos + bufferSize;
+	if ( endPos > lenDoc ) endPos = lenDoc;
+
+	_text.copy( buf, endPos - startPos, startPos );
+	buf[endPos - startPos] = '\0';
+}
+
+bool MemAccessor::Match( int pos, const char* s )
+{
+	for ( int i = 0; *s; i++, s++ ) {
+		if ( *s != SafeGetCharAt( pos + i ) ) return ( false );
+	}
+	return ( true );
+}
+
+char MemAccessor::StyleAt( int position )
+{
+	if ( ( position < 0 ) || ( position >= int( _styles.length() ) ) ) return ( 0 );
+	return ( _styles[position] );
+}
+
+int MemAccessor::GetLine( int position )
+{
+	if ( position <= 0 ) return ( 0 );
+	std::vector<int>::const_iterator next =
+		std::upper_bound( _lineStarts.begin(), _lineStarts.end(), position );
+	return ( ( next - _lineStarts.begin() ) - 1 );
+}
+
+int MemAccessor::LineStart( int line )
+{
+	if ( line <= 0 ) return ( 0 );
+	if ( line >= int( _lineStarts.size() ) ) return ( _text.length() );
+	return ( _lineStarts[line] );
+}
+
+int MemAccessor::LevelAt( int line )
+{
+	if ( ( line < 0 ) || ( line >= int( _levels.size() ) ) ) return ( SC_FOLDLEVELBASE );
+	return ( _levels[line] );
+}
+
+int MemAccessor::Length() { return ( _text.length() ); }
+
+//  Nothing is buffered, but the text buffer is dropped like WindowAccessor does.
+void MemAccessor::Flush()
+{
+	startPos = extremePosition;
+}
+
+int MemAccessor::GetLineState( int line )
+{
+	if ( ( line < 0 ) || ( line >= int( _lineStates.size() ) ) ) return ( 0 );
+	return ( _lineStates[line] );
+}
+
+int MemAccessor::SetLineState( int line, int state )
+{
+	if ( ( line < 0 ) || ( line >= int( _lineStates.size() ) ) ) return ( 0 );
+	int prevState = _lineStates[line];
+	_lineStates[line] = state;
+	return ( prevState );
+}
+
+int MemAccessor::GetPropertyInt( const char* key, int defaultValue )
+{
+	return ( _props.GetInt( key, defaultValue ) );
+}
+
+//  Same as WindowAccessor; the caller owns the returned string.
+char* MemAccessor::GetProperties()
+{
+	return ( _props.ToString() );
+}
+
+void MemAccessor::StartAt( unsigned int start, char chMask )
+{
+	_stylingPos = start;
+	_stylingMask = chMask;
+}
+
+void MemAccessor::SetFlags( char chFlags_, char chWhile_ )
+{
+	_chFlags = chFlags_;
+	_chWhile = chWhile_;
+}
+
+unsigned int MemAccessor::GetStartSegment() { return ( _startSeg ); }
+
+void MemAccessor::StartSegment( unsigned int pos ) { _startSeg = pos; }
+
+void MemAccessor::ColourTo( unsigned int pos, int chAttr )
+{
+	//  Only perform styling if non empty range
+	if ( pos != _startSeg - 1 ) {
+		if ( chAttr != _chWhile ) _chFlags = 0;
+		chAttr |= _chFlags;
+
+		int count = pos - _startSeg + 1;
+		for ( int i = 0; ( i < count ) && ( _stylingPos < int( _styles.length() ) ); i++ ) {
+			char& style = _styles[_stylingPos++];
+			style = static_cast<char>( ( style & ~_stylingMask ) | ( chAttr & _stylingMask ) );
+		}
+		if ( _stylingPos > _endStyled ) _endStyled = _stylingPos;
+	}
+	_startSeg = pos + 1;
+}
+
+void MemAccessor::SetLevel( int line, int level )
+{
+	if ( ( line < 0 ) || ( line >= int( _levels.size() ) ) ) return;
+	_levels[line] = level;
+}
+
+//  Same calculation as WindowAccessor::IndentAmount.
+int MemAccessor::IndentAmount( int line, int* flags, PFNIsCommentLeader pfnIsCommentLeader )
+{
+	int end = Length();
+	int spaceFlags = 0;
+	int pos = LineStart( line );
+	char ch = ( *this )[pos];
+	int indent = 0;
+	bool inPrevPrefix = line > 0;
+	int posPrev = inPrevPrefix ? LineStart( line - 1 ) : 0;
+
+	while ( ( ch == ' ' || ch == '\t' ) && ( pos < end ) ) {
+		if ( inPrevPrefix ) {
+			char chPrev = ( *this )[posPrev++];
+			if ( chPrev == ' ' || chPrev == '\t' ) {
+				if ( chPrev != ch ) spaceFlags |= wsInconsistent;
+			}
+			else {
+				inPrevPrefix = false;
+			}
+		}
+		if ( ch == ' ' ) {
+			spaceFlags |= wsSpace;
+			indent++;
+		}
+		else {	// Tab
+			spaceFlags |= wsTab;
+			if ( spaceFlags & wsSpace ) spaceFlags |= wsSpaceTab;
+			indent = ( indent / 8 + 1 ) * 8;
+		}
+		ch = ( *this )[++pos];
+	}
+
+	*flags = spaceFlags;
+	indent += SC_FOLDLEVELBASE;
+	if ( ( LineStart( line ) == Length() ) || ( ch == ' ' ) || ( ch == '\t' ) || ( ch == '\n' ) ||
+			( ch == '\r' ) || ( pfnIsCommentLeader && ( *pfnIsCommentLeader )( *this, pos, end - pos ) ) )
+		return ( indent | SC_FOLDLEVELWHITEFLAG );
+	else
+		return ( indent );
+}
+
+void MemAccessor::IndicatorFill( int start, int end, int indicator, int value )
+{
+	_nbIndicatorFills++;
+	if ( ( indicator < 0 ) || ( indicator >= NB_STORED_INDICATORS ) ) return;
+
+	if ( start < 0 ) start = 0;
+	if ( end > int( _indicators.length() ) ) end = _indicators.length();
+
+	char bit = static_cast<char>( 1 << indicator );
+	for ( int pos = start; pos < end; pos++ ) {
+		if ( value ) _indicators[pos] |= bit;
+		else _indicators[pos] &= ~bit;
+	}
+}
+
+//  Inserts text with zeroed styles and indicators.  New lines get the fold level of the line
+//  above and a zero line state, the same as Scintilla's CellBuffer.
+void MemAccessor::insertText( int pos, const std::string& text )
+{
+	if ( ( pos < 0 ) || ( pos > int( _text.length() ) ) || text.empty() ) return;
+
+	int line = GetLine( pos );
+	int nbLinesBefore = _lineStarts.size();
+
+	_text.insert( pos, text );
+	_styles.insert( pos, text.length(), '\0' );
+	_indicators.insert( pos, text.length(), '\0' );
+	rebuildLineStarts( line );
+
+	int nbAdded = _lineStarts.size() - nbLinesBefore;
+	if ( nbAdded > 0 ) {
+		int level = _levels[line] & ~SC_FOLDLEVELWHITEFLAG;
+		_levels.insert( _levels.begin() + line + 1, nbAdded, level );
+		_lineStates.insert( _lineStates.begin() + line + 1, nbAdded, 0 );
+	}
+
+	if ( _endStyled > pos ) _endStyled = pos;
+	Flush();
+}
+
+//  Deletes text along with the levels and line states of any lines removed.
+void MemAccessor::deleteText( int pos, int length )
+{
+	if ( ( pos < 0 ) || ( length <= 0 ) || ( pos + length > int( _text.length() ) ) ) return;
+
+	int line = GetLine( pos );
+	int nbLinesBefore = _lineStarts.size();
+
+	_text.erase( pos, length );
+	_styles.erase( pos, length );
+	_indicators.erase( pos, length );
+	rebuildLineStarts( line );
+
+	int nbRemoved = nbLinesBefore - _lineStarts.size();
+	if ( nbRemoved > 0 ) {
+		_levels.erase( _levels.begin() + line + 1, _levels.begin() + line + 1 + nbRemoved );
+		_lineStates.erase( _lineStates.begin() + line + 1, _lineStates.begin() + line + 1 + nbRemoved );
+	}
+
+	if ( _endStyled > pos ) _endStyled = pos;
+	Flush();
+}
+
+//  Sizes and hashes of each kind of output, one per line.
+std::string MemAccessor::getSummary() const
+{
+	std::ostringstream out;
+	out << std::hex << std::setfill( '0' );
+
+	out << "length " << std::dec << _text.length() << std::hex << "\n";
+	out << "lines " << std::dec << _lineStarts.size() << std::hex << "\n";
+	out << "styles " << std::setw( 16 ) << hashBytes( _styles.data(), _styles.length() ) << "\n";
+	out << "levels " << std::setw( 16 ) << hashBytes( &_levels[0], _levels.size() * sizeof( int ) ) << "\n";
+	out << "linestates " << std::setw( 16 ) << hashBytes( &_lineStates[0], _lineStates.size() * sizeof( int ) ) << "\n";
+	out << "indicators " << std::setw( 16 ) << hashBytes( _indicators.data(), _indicators.length() ) << "\n";
+
+	return ( out.str() );
+}
+
+//  One line of text per document line:
+//    <line> <fold level> <line state> | <style>x<count> ... [| ind <bits>x<count> ...]
+//  Levels and line states are in hex, the rest in decimal.  Runs cover the line end as well.
+//  The indicator runs, a bitmask of indicators 0 - 7, only appear for lines that have some.
+std::string MemAccessor::getDump() const
+{
+	std::ostringstream out;
+	out << std::setfill( '0' );
+
+	int lenDoc = _text.length();
+	for ( size_t line = 0; line < _lineStarts.size(); line++ ) {
+		int start = _lineStarts[line];
+		int end = ( line + 1 < _lineStarts.size() ) ? ( _lineStarts[line + 1] ) : ( lenDoc );
+
+		out << std::dec << line << std::hex << " " << std::setw( 4 ) << _levels[line]
+			<< " " << std::setw( 8 ) << _lineStates[line] << std::dec << " |";
+
+		bool hasIndicators = false;
+		for ( int pos = start; pos < end; ) {
+			int runEnd = pos + 1;
+			while ( ( runEnd < end ) && ( _styles[runEnd] == _styles[pos] ) ) runEnd++;
+			out << " " << int( static_cast<unsigned char>( _styles[pos] ) ) << "x" << ( runEnd - pos );
+			pos = runEnd;
+		}
+		for ( int pos = start; pos < end; pos++ ) {
+			if ( _indicators[pos] ) hasIndicators = true;
+		}
+
+		if ( hasIndicators ) {
+			out << " | ind";
+			for ( int pos = start; pos < end; ) {
+				int runEnd = pos + 1;
+				while ( ( runEnd < end ) && ( _indicators[runEnd] == _indicators[pos] ) ) runEnd++;
+				out << " " << int( static_cast<unsigned char>( _indicators[pos] ) ) << "x" << ( runEnd - pos );
+				pos = runEnd;
+			}
+		}
+		out << "\n";
+	}
+
+	return ( out.str() );
+}
+
+//  Recomputes the line starts after fromLine.  The line before an edit is rescanned as well
+//  since its \r may have joined with an inserted \n.  Line ends are \r\n, \n, or a lone \r.
+void MemAccessor::rebuildLineStarts( int fromLine )
+{
+	int keep = ( fromLine > 0 ) ? ( fromLine - 1 ) : ( 0 );
+	if ( keep >= int( _lineStarts.size() ) ) keep = _lineStarts.size() - 1;
+	if ( keep < 0 ) keep = 0;
+
+	_lineStarts.resize( keep + 1, 0 );
+
+	int lenDoc = _text.length();
+	for ( int pos = _lineStarts.back(); pos < lenDoc; pos++ ) {
+		char ch = _text[pos];
+		if ( ch == '\r' ) {
+			if ( ( pos + 1 < lenDoc ) && ( _text[pos + 1] == '\n' ) ) pos++;
+			_lineStarts.push_back( pos + 1 );
+		}
+		else if ( ch == '\n' ) {
+			_lineStarts.push_back( pos + 1 );
+		}
+	}
+}
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
@@ -0,0 +1,125 @@
+/* NppPluginIface_ExtLexer_MemAccessor.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a Scintilla Accessor over an in-memory
+ *  document.
+ *
+ *  The MemAccessor behaves the way WindowAccessor does against a Scintilla view, but the text,
+ *  style bytes, fold levels, line states, and indicators all live in this object.  A lexer's
+ *  Accessor& entry point can be run against it without Notepad++ or a window, and the results
+ *  can be read back, hashed to check that two runs styled the document identically, or dumped
+ *  line by line for a golden file that can be read and diffed.
+ *
+ *  Only indicators 0 to 7 ( the ones set aside for lexers ) are kept per position; fills on
+ *  higher indicators are counted but not stored.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_MEMACCESSOR_H
+#define NPP_PLUGININTERFACE_EXTLEXER_MEMACCESSOR_H
+
+#include "NppPluginIface_ExtLexer.h"
+
+#include <cstdlib>
+#include "Accessor.h"
+#include "PropSet.h"
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+class MemAccessor : public Accessor {
+	//  Private so the compiler doesn't generate them.
+	MemAccessor( const MemAccessor& source );
+	MemAccessor& operator=( const MemAccessor& );
+
+public:
+	MemAccessor( const std::string& text, const char* props );
+	virtual ~MemAccessor();
+
+	//  <--- Accessor Interface --->
+	virtual bool Match( int pos, const char* s );
+	virtual char StyleAt( int position );
+	virtual int GetLine( int position );
+	virtual int LineStart( int line );
+	virtual int LevelAt( int line );
+	virtual int Length();
+	virtual void Flush();
+	virtual int GetLineState( int line );
+	virtual int SetLineState( int line, int state );
+	virtual int GetPropertyInt( const char* key, int defaultValue = 0 );
+	virtual char* GetProperties();
+
+	virtual void StartAt( unsigned int start, char chMask = 31 );
+	virtual void SetFlags( char chFlags_, char chWhile_ );
+	virtual unsigned int GetStartSegment();
+	virtual void StartSegment( unsigned int pos );
+	virtual void ColourTo( unsigned int pos, int chAttr );
+	virtual void SetLevel( int line, int level );
+	virtual int IndentAmount( int line, int* flags, PFNIsCommentLeader pfnIsCommentLeader = 0 );
+	virtual void IndicatorFill( int start, int end, int indicator, int value );
+
+	//  <--- Editing --->
+	//  These follow Scintilla's handling of styles, levels and line states for the change, but
+	//  leave re-styling to the caller just like a real edit would.
+	void insertText( int pos, const std::string& text );
+	void deleteText( int pos, int length );
+
+	//  <--- Inspection --->
+	int getLineCount() const { return ( _lineStarts.size() ); }
+	int getEndStyled() const { return ( _endStyled ); }
+	const std::string& getText() const { return ( _text ); }
+	const std::string& getStyles() const { return ( _styles ); }
+	const std::vector<int>& getLevels() const { return ( _levels ); }
+	const std::vector<int>& getLineStates() const { return ( _lineStates ); }
+	const std::string& getIndicators() const { return ( _indicators ); }
+	int getIndicatorFillCount() const { return ( _nbIndicatorFills ); }
+	std::string getSummary() const;			//  Sizes and hashes of each kind of output, one per line.
+	std::string getDump() const;			//  Each line's level, line state, style and indicator runs.
+
+protected:
+	virtual bool InternalIsLeadByte( char /*ch*/ ) { return ( false ); }
+	virtual void Fill( int position );
+
+private:
+	void rebuildLineStarts( int fromLine );
+
+	std::string _text;
+	std::string _styles;
+	std::string _indicators;			//  Bitmask of indicators 0 - 7 for each position.
+	std::vector<int> _lineStarts;
+	std::vector<int> _levels;
+	std::vector<int> _lineStates;
+	PropSet _props;
+
+	int _stylingPos;					//  Next position ColourTo() writes to.
+	char _stylingMask;
+	unsigned int _startSeg;
+	char _chFlags;
+	char _chWhile;
+	int _endStyled;
+	int _nbIndicatorFills;
+};
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_MEMACCESSOR_H
@@ -0,0 +1,789 @@
+/* NppPluginIface_ExtLexer_ParallelLex.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing parallel lexing of large ranges for
+ *  line oriented languages.
+ *
+ *  The tasks run on the Windows thread pool with QueueUserWorkItem; each helper and the
+ *  calling thread take the next task index with an interlocked increment until none are
+ *  left, so an uneven chunk doesn't hold the others up.
+ *
+ *  Fold levels are a prefix sum: each chunk of lines is scanned for its lines' deltas and its
+ *  total, the totals are added up on the calling thread to give each chunk's starting level,
+ *  and the chunks then turn their deltas into levels, again in parallel.  The lines of the
+ *  FoldText copy are found and classified in parallel slices before that, so chunks start on
+ *  a line and a comment line's neighbours are one lookup away.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_ParallelLex.h"
+#include "NppPluginIface_ExtLexer_DirectAccessor.h"
+#include "NppPluginIface_ExtLexer_MemAccessor.h"
+#include "NppPluginIface_ExtLexer_RunAccessor.h"
+
+//  <--- STL --->
+#include <algorithm>
+#include <map>
+#include <cstring>
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const int MIN_CHUNK_SIZE = 1 << 20;		//  Smaller chunks cost more to hand out than they save.
+const int CHUNKS_PER_WORKER = 4;		//  Spare chunks even out lines that lex slower.
+const int MIN_FOLD_CHUNK_SIZE = 1 << 18;	//  Folding does much less per character than lexing.
+
+//---------------------------------------------------------------------------------------------
+//  <--- Task Running --->
+
+struct TaskBatch {
+	TaskFunction task;
+	void* context;
+	LONG nbTasks;
+	volatile LONG nextTask;
+	volatile LONG nbRunning;			//  Threads still taking tasks.
+	HANDLE done;						//  Set when nbRunning drops to zero.
+};
+
+DWORD WINAPI runBatch( LPVOID param )
+{
+	TaskBatch* batch = static_cast<TaskBatch*>( param );
+
+	for ( LONG index = ::InterlockedIncrement( &batch->nextTask ) - 1; index < batch->nbTasks;
+			index = ::InterlockedIncrement( &batch->nextTask ) - 1 )
+		batch->task( batch->context, index );
+
+	if ( ::InterlockedDecrement( &batch->nbRunning ) == 0 ) ::SetEvent( batch->done );
+	return ( 0 );
+}
+
+
+//---------------------------------------------------------------------------------------------
+//  <--- Chunk Accessor --->
+
+struct IndicatorFillCall {
+	int start;
+	int end;
+	int indicator;
+	int value;
+};
+
+//  Lexes one chunk of the document text, keeping what the lexer sets until it is replayed
+//  onto the real Accessor.
+class ChunkAccessor : public Accessor {
+	//  Private so the compiler doesn't generate them.
+	ChunkAccessor( const ChunkAccessor& source );
+	ChunkAccessor& operator=( const ChunkAccessor& );
+
+public:
+	ChunkAccessor( Accessor& styler, CRITICAL_SECTION& stylerLock, const char* text, int lenDoc,
+		int start, int end, int firstLine, int firstLineStart );
+
+	//  <--- Accessor Interface --->
+	virtual bool Match( int pos, const char* s );
+	virtual char StyleAt( int position );
+	virtual int GetLine( int position );
+	virtual int LineStart( int line );
+	virtual int LevelAt( int line );
+	virtual int Length() { return ( _lenDoc ); }
+	virtual void Flush() { startPos = extremePosition; }
+	virtual int GetLineState( int line );
+	virtual int SetLineState( int line, int state );
+	virtual int GetPropertyInt( const char* key, int defaultValue = 0 );
+	virtual char* GetProperties();
+
+	virtual void StartAt( unsigned int start, char chMask = 31 );
+	virtual void SetFlags( char chFlags_, char chWhile_ );
+	virtual unsigned int GetStartSegment() { return ( _startSeg ); }
+	virtual void StartSegment( unsigned int pos ) { _startSeg = pos; }
+	virtual void ColourTo( unsigned int pos, int chAttr );
+	virtual void SetLevel( int line, int level );
+	virtual int IndentAmount( int line, int* flags, PFNIsCommentLeader pfnIsCommentLeader = 0 );
+	virtual void IndicatorFill( int start, int end, int indicator, int value );
+
+	//  Sends what the lexer set to styler, which has to be styling from this chunk's start.
+	void replay( Accessor& styler );
+	char stylingMask() const { return ( _stylingMask ); }
+
+protected:
+	virtual bool InternalIsLeadByte( char ch );
+	virtual void Fill( int position );
+
+private:
+	bool isLineStart( int position ) const;
+	bool scanNextLine();						//  Adds the next line start, false at the end.
+	int countLineStarts( int from, int to ) const;	//  In ( from, to ].
+
+	Accessor& _styler;							//  Only used under _stylerLock.
+	CRITICAL_SECTION& _stylerLock;
+	const char* _text;
+	int _lenDoc;
+	int _start;
+	int _end;
+
+	int _firstLine;								//  Line of _lineStarts[0].
+	std::vector<int> _lineStarts;
+	int _scanPos;								//  Where the next line end search starts.
+
+	std::string _styles;						//  From _start, only up to _styledEnd are set.
+	int _styledEnd;
+	int _stylingPos;
+	char _stylingMask;
+	unsigned int _startSeg;
+	char _chFlags;
+	char _chWhile;
+
+	signed char _leadBytes[256];				//  1 or 0 once asked, -1 before.
+
+	std::map<int, int> _lineStates;
+	std::map<int, int> _levels;
+	std::vector<IndicatorFillCall> _indicatorFills;
+};
+
+ChunkAccessor::ChunkAccessor( Accessor& styler, CRITICAL_SECTION& stylerLock, const char* text,
+		int lenDoc, int start, int end, int firstLine, int firstLineStart )
+	:_styler(styler), _stylerLock(stylerLock), _text(text), _lenDoc(lenDoc), _start(start),
+	_end(end), _firstLine(firstLine), _lineStarts(1, firstLineStart), _scanPos(firstLineStart),
+	_styles(end - start, '\0'), _styledEnd(start), _stylingPos(start), _stylingMask(31),
+	_startSeg(start), _chFlags(0), _chWhile(0)
+{
+	//  Lead bytes are left to the real Accessor's code page.
+	SetCodePage( 1 );
+	memset( _leadBytes, -1, sizeof( _leadBytes ) );
+}
+
+//  Each byte value is asked of the real Accessor once, under the lock.
+bool ChunkAccessor::InternalIsLeadByte( char ch )
+{
+	unsigned char uch = static_cast<unsigned char>( ch );
+	if ( _leadBytes[uch] < 0 ) {
+		::EnterCriticalSection( &_stylerLock );
+		_leadBytes[uch] = _styler.IsLeadByte( ch ) ? 1 : 0;
+		::LeaveCriticalSection( &_stylerLock );
+	}
+	return ( _leadBytes[uch] != 0 );
+}
+
+void ChunkAccessor::Fill( int position )
+{
+	startPos = position - slopSize;
+	if ( startPos + bufferSize > _lenDoc ) startPos = _lenDoc - bufferSize;
+	if ( startPos < 0 ) startPos = 0;
+	endPos = startPos + bufferSize;
+	if ( endPos > _lenDoc ) endPos = _lenDoc;
+
+	::memcpy( buf, _text + startPos, endPos - startPos );
+	buf[endPos - startPos] = '\0';
+}
+
+bool ChunkAccessor::Match( int pos, const char* s )
+{
+	for ( int i = 0; *s; i++, s++ ) {
+		if ( *s != SafeGetCharAt( pos + i ) ) return ( false );
+	}
+	return ( true );
+}
+
+//  Positions outside the chunk, or not styled yet, read as style 0.
+char ChunkAccessor::StyleAt( int position )
+{
+	if ( ( position < _start ) || ( position >= _styledEnd ) ) return ( 0 );
+	return ( _styles[position - _start] );
+}
+
+//  Line ends are \r\n, \n, or a lone \r.
+bool ChunkAccessor::isLineStart( int position ) const
+{
+	if ( ( position <= 0 ) || ( position > _lenDoc ) ) return ( false );
+	char chPrev = _text[position - 1];
+	return ( ( chPrev == '\n' ) ||
+		( ( chPrev == '\r' ) && ( ( position == _lenDoc ) || ( _text[position] != '\n' ) ) ) );
+}
+
+bool ChunkAccessor::scanNextLine()
+{
+	for ( int pos = _scanPos; pos < _lenDoc; pos++ ) {
+		if ( isLineStart( pos + 1 ) ) {
+			_scanPos = pos + 1;
+			_lineStarts.push_back( _scanPos );
+			return ( true );
+		}
+	}
+	_scanPos = _lenDoc;
+	return ( false );
+}
+
+int ChunkAccessor::countLineStarts( int from, int to ) const
+{
+	int count = 0;
+	for ( int pos = from + 1; pos <= to; pos++ ) {
+		if ( isLineStart( pos ) ) count++;
+	}
+	return ( count );
+}
+
+//  Lines before the chunk are counted back from it, lexers rarely ask for them.
+int ChunkAccessor::GetLine( int position )
+{
+	if ( position <= 0 ) return ( 0 );
+	if ( position > _lenDoc ) position = _lenDoc;
+
+	if ( position < _lineStarts.front() )
+		return ( _firstLine - countLineStarts( position, _lineStarts.front() ) );
+
+	while ( ( _lineStarts.back() <= position ) && scanNextLine() ) ;
+	std::vector<int>::const_iterator next =
+		std::upper_bound( _lineStarts.begin(), _lineStarts.end(), position );
+	return ( _firstLine + ( next - _lineStarts.begin() ) - 1 );
+}
+
+int ChunkAccessor::LineStart( int line )
+{
+	if ( line <= 0 ) return ( 0 );
+
+	if ( line < _firstLine ) {
+		int pos = _lineStarts.front();
+		for ( int nbLines = _firstLine - line; nbLines > 0 && pos > 0; ) {
+			pos--;
+			if ( isLineStart( pos ) ) nbLines--;
+		}
+		return ( pos );
+	}
+
+	int index = line - _firstLine;
+	while ( ( index >= int( _lineStarts.size() ) ) && scanNextLine() ) ;
+	if ( index < int( _lineStarts.size() ) ) return ( _lineStarts[index] );
+	return ( _lenDoc );
+}
+
+int ChunkAccessor::LevelAt( int line )
+{
+	std::map<int, int>::const_iterator level = _levels.find( line );
+	return ( ( level == _levels.end() ) ? ( SC_FOLDLEVELBASE ) : ( level->second ) );
+}
+
+void ChunkAccessor::SetLevel( int line, int level )
+{
+	_levels[line] = level;
+}
+
+int ChunkAccessor::GetLineState( int line )
+{
+	std::map<int, int>::const_iterator state = _lineStates.find( line );
+	return ( ( state == _lineStates.end() ) ? ( 0 ) : ( state->second ) );
+}
+
+int ChunkAccessor::SetLineState( int line, int state )
+{
+	int prevState = GetLineState( line );
+	_lineStates[line] = state;
+	return ( prevState );
+}
+
+int ChunkAccessor::GetPropertyInt( const char* key, int defaultValue )
+{
+	::EnterCriticalSection( &_stylerLock );
+	int value = _styler.GetPropertyInt( key, defaultValue );
+	::LeaveCriticalSection( &_stylerLock );
+	return ( value );
+}
+
+char* ChunkAccessor::GetProperties()
+{
+	::EnterCriticalSection( &_stylerLock );
+	char* props = _styler.GetProperties();
+	::LeaveCriticalSection( &_stylerLock );
+	return ( props );
+}
+
+void ChunkAccessor::StartAt( unsigned int start, char chMask )
+{
+	_stylingPos = start;
+	_stylingMask = chMask;
+}
+
+void ChunkAccessor::SetFlags( char chFlags_, char chWhile_ )
+{
+	_chFlags = chFlags_;
+	_chWhile = chWhile_;
+}
+
+//  Same as WindowAccessor, except styles outside the chunk are dropped.
+void ChunkAccessor::ColourTo( unsigned int pos, int chAttr )
+{
+	//  Only perform styling if non empty range
+	if ( pos != _startSeg - 1 ) {
+		if ( chAttr != _chWhile ) _chFlags = 0;
+		chAttr |= _chFlags;
+
+		int last = ( int( pos ) < _end ) ? ( pos ) : ( _end - 1 );
+		for ( ; _stylingPos <= last; _stylingPos++ ) {
+			if ( _stylingPos >= _start ) _styles[_stylingPos - _start] = static_cast<char>( chAttr );
+		}
+		if ( _stylingPos > _styledEnd ) _styledEnd = _stylingPos;
+	}
+	_startSeg = pos + 1;
+}
+
+//  Same calculation as WindowAccessor::IndentAmount.
+int ChunkAccessor::IndentAmount( int line, int* flags, PFNIsCommentLeader pfnIsCommentLeader )
+{
+	int end = Length();
+	int spaceFlags = 0;
+	int pos = LineStart( line );
+	char ch = ( *this )[pos];
+	int indent = 0;
+	bool inPrevPrefix = line > 0;
+	int posPrev = inPrevPrefix ? LineStart( line - 1 ) : 0;
+
+	while ( ( ch == ' ' || ch == '\t' ) && ( pos < end ) ) {
+		if ( inPrevPrefix ) {
+			char chPrev = ( *this )[posPrev++];
+			if ( chPrev == ' ' || chPrev == '\t' ) {
+				if ( chPrev != ch ) spaceFlags |= wsInconsistent;
+			}
+			else {
+				inPrevPrefix = false;
+			}
+		}
+		if ( ch == ' ' ) {
+			spaceFlags |= wsSpace;
+			indent++;
+		}
+		else {	// Tab
+			spaceFlags |= wsTab;
+			if ( spaceFlags & wsSpace ) spaceFlags |= wsSpaceTab;
+			indent = ( indent / 8 + 1 ) * 8;
+		}
+		ch = ( *this )[++pos];
+	}
+
+	*flags = spaceFlags;
+	indent += SC_FOLDLEVELBASE;
+	if ( ( LineStart( line ) == Length() ) || ( ch == ' ' ) || ( ch == '\t' ) || ( ch == '\n' ) ||
+			( ch == '\r' ) || ( pfnIsCommentLeader && ( *pfnIsCommentLeader )( *this, pos, end - pos ) ) )
+		return ( indent | SC_FOLDLEVELWHITEFLAG );
+	else
+		return ( indent );
+}
+
+void ChunkAccessor::IndicatorFill( int start, int end, int indicator, int value )
+{
+	IndicatorFillCall call = { start, end, indicator, value };
+	_indicatorFills.push_back( call );
+}
+
+//  Styles go over as one ColourTo() per run.  A tail the lexer left unstyled is styled by the
+//  next chunk's first run, just as it would have been lexing straight through.
+void ChunkAccessor::replay( Accessor& styler )
+{
+	int pos = _start;
+	while ( pos < _styledEnd ) {
+		char style = _styles[pos - _start];
+		int runEnd = pos + 1;
+		while ( ( runEnd < _styledEnd ) && ( _styles[runEnd - _start] == style ) ) runEnd++;
+		styler.ColourTo( runEnd - 1, static_cast<unsigned char>( style ) );
+		pos = runEnd;
+	}
+
+	std::map<int, int>::const_iterator it;
+	for ( it = _lineStates.begin(); it != _lineStates.end(); ++it ) styler.SetLineState( it->first, it->second );
+	for ( it = _levels.begin(); it != _levels.end(); ++it ) styler.SetLevel( it->first, it->second );
+	for ( size_t i = 0; i < _indicatorFills.size(); i++ ) {
+		const IndicatorFillCall& call = _indicatorFills[i];
+		styler.IndicatorFill( call.start, call.end, call.indicator, call.value );
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------
+//  <--- Parallel Colourise --->
+
+//  The text of the whole document, or NULL for an Accessor that doesn't hold it in memory.
+const char* documentText( Accessor& styler )
+{
+	if ( DirectAccessor* direct = dynamic_cast<DirectAccessor*>( &styler ) )
+		return ( direct->characterPointer() );
+	if ( MemAccessor* mem = dynamic_cast<MemAccessor*>( &styler ) )
+		return ( mem->getText().c_str() );
+	if ( RunAccessor* runs = dynamic_cast<RunAccessor*>( &styler ) )
+		return ( documentText( runs->target() ) );
+	return ( NULL );
+}
+
+struct ColouriseRun {
+	Accessor* styler;
+	CRITICAL_SECTION stylerLock;
+	const char* text;
+	int lenDoc;
+	std::vector<int> bounds;				//  Chunk starts, then the end of the range.
+	std::vector<int> nbLineEnds;			//  Per chunk.
+	std::vector<ChunkAccessor*> chunks;
+	ColouriseFunction colourise;
+	int initStyle;
+	WordList** keywordlists;
+};
+
+//  Line ends are \r\n, \n, or a lone \r.
+void countChunkLineEnds( void* context, int index )
+{
+	ColouriseRun* run = static_cast<ColouriseRun*>( context );
+	const char* text = run->text;
+	int end = run->bounds[index + 1];
+	int count = 0;
+	for ( int pos = run->bounds[index]; pos < end; pos++ ) {
+		if ( ( text[pos] == '\n' ) ||
+				( ( text[pos] == '\r' ) && ( ( pos + 1 == run->lenDoc ) || ( text[pos + 1] != '\n' ) ) ) )
+			count++;
+	}
+	run->nbLineEnds[index] = count;
+}
+
+void colouriseChunk( void* context, int index )
+{
+	ColouriseRun* run = static_cast<ColouriseRun*>( context );
+	int start = run->bounds[index];
+	int initStyle = ( index == 0 ) ? ( run->initStyle ) : ( 0 );
+	run->colourise( start, run->bounds[index + 1] - start, initStyle, run->keywordlists,
+		*run->chunks[index] );
+}
+
+
+//---------------------------------------------------------------------------------------------
+//  <--- Parallel Fold Levels --->
+
+//  The lines of a FoldText copy, found and classified a slice at a time.
+struct ClassifyRun {
+	const char* text;						//  The copy, indexed from 0.
+	int length;
+	int start;								//  Document position of text[0].
+	const char* commentLeader;
+	int leaderLength;
+	std::vector<int> bounds;				//  Slice starts in text, then length.
+	std::vector< std::vector<int> > lineStarts;	//  Per slice.
+	std::vector< std::vector<unsigned char> > lineClasses;
+};
+
+//  Classifies the lines that start in one slice; a line is read past the slice's end as needed.
+void classifyLinesChunk( void* context, int index )
+{
+	ClassifyRun* run = static_cast<ClassifyRun*>( context );
+	const char* text = run->text;
+	int length = run->length;
+	std::vector<int>& lineStarts = run->lineStarts[index];
+	std::vector<unsigned char>& lineClasses = run->lineClasses[index];
+
+	for ( int i = run->bounds[index]; i < run->bounds[index + 1]; i++ ) {
+		if ( i > 0 ) {
+			char chPrev = text[i - 1];
+			if ( !( ( chPrev == '\n' ) || ( ( chPrev == '\r' ) && ( text[i] != '\n' ) ) ) ) continue;
+		}
+
+		unsigned char lineClass = 0;
+		int pos = i;
+		while ( ( pos < length ) && ( ( text[pos] == ' ' ) || ( text[pos] == '\t' ) ) ) pos++;
+		if ( ( run->leaderLength > 0 ) && ( pos + run->leaderLength <= length ) &&
+				( strncmp( text + pos, run->commentLeader, run->leaderLength ) == 0 ) )
+			lineClass |= FoldText::LINE_COMMENT;
+
+		for ( ; pos < length; pos++ ) {
+			char ch = text[pos];
+			if ( ( ch == '\r' ) || ( ch == '\n' ) ) break;
+			if ( ( ch != ' ' ) && ( ( ch < 0x09 ) || ( ch > 0x0D ) ) ) {
+				lineClass |= FoldText::LINE_VISIBLE;
+				break;
+			}
+		}
+
+		lineStarts.push_back( run->start + i );
+		lineClasses.push_back( lineClass );
+	}
+}
+
+struct FoldRun {
+	const FoldText* text;
+	int startPos;
+	int endPos;
+	FoldLineFunction foldLine;
+	void* context;
+	std::vector<int> bounds;				//  Chunk first lines, then the line after the range.
+	std::vector< std::vector<LineFold> > lines;		//  Per chunk.
+	std::vector<int> deltas;				//  Per chunk, the sum of its lines' deltas.
+	std::vector<int> firstLevels;			//  Per chunk, the level its first line starts at.
+	std::vector<int> firstLines;			//  Per chunk, the index of its first line in levels.
+	std::vector<LineLevels>* levels;
+};
+
+//  The range's first and last lines are cut to the range.
+void scanFoldChunk( void* context, int index )
+{
+	FoldRun* run = static_cast<FoldRun*>( context );
+	const FoldText& text = *run->text;
+	std::vector<LineFold>& lines = run->lines[index];
+	int delta = 0;
+
+	for ( int line = run->bounds[index]; line < run->bounds[index + 1]; line++ ) {
+		int lineStart = ( std::max )( text.lineStart( line ), run->startPos );
+		int lineEnd = ( std::min )( text.lineEnd( line ), run->endPos );
+
+		LineFold fold = { 0, 0, text.isVisibleLine( line ) };
+		run->foldLine( text, line, lineStart, lineEnd, run->context, fold );
+		lines.push_back( fold );
+		delta += fold.delta;
+	}
+	run->deltas[index] = delta;
+}
+
+void levelFoldChunk( void* context, int index )
+{
+	FoldRun* run = static_cast<FoldRun*>( context );
+	const std::vector<LineFold>& lines = run->lines[index];
+	std::vector<LineLevels>::iterator level = run->levels->begin() + run->firstLines[index];
+	int levelCurrent = run->firstLevels[index];
+
+	for ( size_t i = 0; i < lines.size(); i++, ++level ) {
+		level->start = levelCurrent;
+		level->min = levelCurrent + lines[i].minDelta;
+		levelCurrent += lines[i].delta;
+		level->end = levelCurrent;
+		level->visible = lines[i].visible;
+		level->ended = true;
+	}
+}
+
+}  // End: Un-named namespace
+
+
+int workerCount()
+{
+	SYSTEM_INFO info;
+	::GetSystemInfo( &info );
+	return ( info.dwNumberOfProcessors );
+}
+
+void runTasks( int nbTasks, TaskFunction task, void* context )
+{
+	if ( nbTasks <= 0 ) return;
+
+	int nbHelpers = ( std::min )( workerCount(), nbTasks ) - 1;
+	TaskBatch batch = { task, context, nbTasks, 0, 1, NULL };
+	if ( nbHelpers > 0 ) batch.done = ::CreateEvent( NULL, TRUE, FALSE, NULL );
+
+	//  A helper that can't be queued just leaves its share to the others.
+	for ( int i = 0; ( i < nbHelpers ) && batch.done; i++ ) {
+		::InterlockedIncrement( &batch.nbRunning );
+		if ( !::QueueUserWorkItem( runBatch, &batch, WT_EXECUTEDEFAULT ) )
+			::InterlockedDecrement( &batch.nbRunning );
+	}
+
+	if ( batch.done ) {
+		runBatch( &batch );
+		::WaitForSingleObject( batch.done, INFINITE );
+		::CloseHandle( batch.done );
+	}
+	else {
+		//  No event to wait on, so no helpers were queued.
+		for ( int index = 0; index < nbTasks; index++ ) task( context, index );
+	}
+}
+
+bool colouriseInParallel( Accessor& styler, unsigned int startPos, int length, int initStyle,
+	WordList* keywordlists[], ColouriseFunction colourise, SafeLineStartFunction safeLineStart )
+{
+	int nbWorkers = workerCount();
+	if ( ( nbWorkers < 2 ) || ( length < 2 * MIN_CHUNK_SIZE ) ) return ( false );
+	if ( styler.GetPropertyInt( "lexer.parallel", 1 ) == 0 ) return ( false );
+
+	const char* text = documentText( styler );
+	if ( !text ) return ( false );
+
+	int lenDoc = styler.Length();
+	int endPos = ( std::min )( int( startPos ) + length, lenDoc );
+
+	//  Split at the first safe line start after each even share of the range.
+	int nbChunks = ( std::min )( length / MIN_CHUNK_SIZE, nbWorkers * CHUNKS_PER_WORKER );
+	ColouriseRun run;
+	run.bounds.push_back( startPos );
+	for ( int i = 1; i < nbChunks; i++ ) {
+		int pos = startPos + int( ( LONGLONG( length ) * i ) / nbChunks );
+		if ( pos <= run.bounds.back() ) pos = run.bounds.back() + 1;
+		for ( ; pos < endPos; pos++ ) {
+			bool atLineStart = ( text[pos - 1] == '\n' ) || ( ( text[pos - 1] == '\r' ) && ( text[pos] != '\n' ) );
+			if ( atLineStart && safeLineStart( styler, text, pos ) ) break;
+		}
+		if ( pos >= endPos ) break;
+		run.bounds.push_back( pos );
+	}
+	nbChunks = run.bounds.size();
+	run.bounds.push_back( endPos );
+	if ( nbChunks < 2 ) return ( false );
+
+	run.styler = &styler;
+	run.text = text;
+	run.lenDoc = lenDoc;
+	run.colourise = colourise;
+	run.initStyle = initStyle;
+	run.keywordlists = keywordlists;
+
+	//  Number each chunk's lines from the line ends before it.
+	run.nbLineEnds.resize( nbChunks );
+	runTasks( nbChunks, countChunkLineEnds, &run );
+
+	::InitializeCriticalSection( &run.stylerLock );
+	int firstLine = styler.GetLine( startPos );
+	int firstLineStart = styler.LineStart( firstLine );
+	for ( int i = 0; i < nbChunks; i++ ) {
+		run.chunks.push_back( new ChunkAccessor( styler, run.stylerLock, text, lenDoc,
+			run.bounds[i], run.bounds[i + 1], firstLine, firstLineStart ) );
+		firstLine += run.nbLineEnds[i];
+		firstLineStart = run.bounds[i + 1];
+	}
+
+	runTasks( nbChunks, colouriseChunk, &run );
+	::DeleteCriticalSection( &run.stylerLock );
+
+	styler.StartAt( startPos, run.chunks[0]->stylingMask() );
+	styler.StartSegment( startPos );
+	for ( int i = 0; i < nbChunks; i++ ) {
+		run.chunks[i]->replay( styler );
+		delete run.chunks[i];
+	}
+	return ( true );
+}
+
+//  Copies from the start of the line before startPos's to the end of the line after endPos's,
+//  and a character further for look ahead, then classifies its lines.
+FoldText::FoldText( Accessor& styler, int startPos, int endPos, const char* commentLeader )
+{
+	int lenDoc = styler.Length();
+	int line = styler.GetLine( startPos );
+	_start = ( line > 0 ) ? ( styler.LineStart( line - 1 ) ) : ( 0 );
+
+	_end = ( std::min )( endPos, lenDoc );
+	for ( int nbLineEnds = 0; ( _end < lenDoc ) && ( nbLineEnds < 2 ); _end++ ) {
+		char ch = styler.SafeGetCharAt( _end );
+		if ( ( ch == '\n' ) || ( ( ch == '\r' ) && ( styler.SafeGetCharAt( _end + 1 ) != '\n' ) ) )
+			nbLineEnds++;
+	}
+	_end = ( std::min )( _end + 1, lenDoc );
+	if ( _end < _start ) _end = _start;
+
+	_text = documentText( styler );
+	if ( _text ) {
+		_text += _start;
+	}
+	else {
+		_copy.resize( _end - _start );
+		for ( int pos = _start; pos < _end; pos++ ) _copy[pos - _start] = styler.SafeGetCharAt( pos );
+		_text = _copy.data();
+	}
+
+	_styles.resize( _end - _start );
+	for ( int pos = _start; pos < _end; pos++ ) _styles[pos - _start] = styler.StyleAt( pos );
+
+	//  Even slices, a line belonging to the slice it starts in.
+	ClassifyRun run;
+	run.text = _text;
+	run.length = _end - _start;
+	run.start = _start;
+	run.commentLeader = commentLeader;
+	run.leaderLength = strlen( commentLeader );
+
+	int nbSlices = 1;
+	if ( styler.GetPropertyInt( "lexer.parallel", 1 ) != 0 )
+		nbSlices = ( std::max )( 1, ( std::min )( run.length / MIN_FOLD_CHUNK_SIZE, workerCount() * CHUNKS_PER_WORKER ) );
+	for ( int i = 0; i < nbSlices; i++ ) run.bounds.push_back( int( ( LONGLONG( run.length ) * i ) / nbSlices ) );
+	run.bounds.push_back( run.length );
+
+	run.lineStarts.resize( nbSlices );
+	run.lineClasses.resize( nbSlices );
+	runTasks( nbSlices, classifyLinesChunk, &run );
+
+	for ( int i = 0; i < nbSlices; i++ ) {
+		_lineStarts.insert( _lineStarts.end(), run.lineStarts[i].begin(), run.lineStarts[i].end() );
+		_lineClasses.insert( _lineClasses.end(), run.lineClasses[i].begin(), run.lineClasses[i].end() );
+	}
+}
+
+int FoldText::lineOf( int position ) const
+{
+	std::vector<int>::const_iterator next = std::upper_bound( _lineStarts.begin(), _lineStarts.end(), position );
+	return ( int( next - _lineStarts.begin() ) - 1 );
+}
+
+void foldLevels( Accessor& styler, unsigned int startPos, int length, int levelStart,
+	const char* commentLeader, FoldLineFunction foldLine, void* context,
+	std::vector<LineLevels>& levels )
+{
+	levels.clear();
+	int endPos = ( std::min )( int( startPos ) + length, styler.Length() );
+	if ( endPos <= int( startPos ) ) return;
+
+	FoldText text( styler, startPos, endPos, commentLeader );
+	FoldRun run;
+	run.text = &text;
+	run.startPos = startPos;
+	run.endPos = endPos;
+	run.foldLine = foldLine;
+	run.context = context;
+	run.levels = &levels;
+
+	//  Split at the first line starting at or after each even share of the range.
+	int endLine = text.lineOf( endPos - 1 ) + 1;
+	int nbChunks = 1;
+	if ( styler.GetPropertyInt( "lexer.parallel", 1 ) != 0 )
+		nbChunks = ( std::min )( length / MIN_FOLD_CHUNK_SIZE, workerCount() * CHUNKS_PER_WORKER );
+	run.bounds.push_back( text.lineOf( startPos ) );
+	for ( int i = 1; i < nbChunks; i++ ) {
+		int pos = startPos + int( ( LONGLONG( length ) * i ) / nbChunks );
+		int line = ( std::max )( text.lineOf( pos - 1 ) + 1, run.bounds.back() + 1 );
+		if ( line >= endLine ) break;
+		run.bounds.push_back( line );
+	}
+	nbChunks = run.bounds.size();
+	run.bounds.push_back( endLine );
+
+	run.lines.resize( nbChunks );
+	run.deltas.resize( nbChunks );
+	runTasks( nbChunks, scanFoldChunk, &run );
+
+	//  The prefix sum over the chunks, each line's is left to levelFoldChunk.
+	int nbLines = 0;
+	int level = levelStart;
+	for ( int i = 0; i < nbChunks; i++ ) {
+		run.firstLines.push_back( nbLines );
+		run.firstLevels.push_back( level );
+		nbLines += run.lines[i].size();
+		level += run.deltas[i];
+	}
+
+	levels.resize( nbLines );
+	runTasks( nbChunks, levelFoldChunk, &run );
+
+	char chLast = text.charAt( endPos - 1 );
+	if ( !( chLast == '\n' || ( chLast == '\r' && text.charAt( endPos ) != '\n' ) ) ) levels.back().ended = false;
+}
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
@@ -0,0 +1,189 @@
+/* NppPluginIface_ExtLexer_ParallelLex.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing parallel lexing of large ranges for
+ *  line oriented languages.
+ *
+ *  Many formats ( config files, logs, ini and properties files ) drop back to their default
+ *  state at the end of nearly every line.  A lexer for one of them can say so with a
+ *  SafeLineStartFunction, and colouriseInParallel then:
+ *
+ *    # Splits the range into chunks, each starting at a line the lexer says is safe.
+ *    # Counts the lines in each chunk, on all processors, to number each chunk's lines.
+ *    # Runs the lexer's colourise function over each chunk, on all processors.  Each chunk
+ *      is styled through a ChunkAccessor that keeps its styles, line states, fold levels and
+ *      indicators to itself.
+ *    # Replays those onto the lexer's Accessor on the calling thread, which then flushes
+ *      them as usual.
+ *
+ *  The chunks are read straight from the document text, so this is only done with an
+ *  Accessor that has the whole text in memory ( DirectAccessor or MemAccessor, or a
+ *  RunAccessor over one ).  Only the calling thread ever uses that Accessor; the chunks only
+ *  ask it for properties and lead bytes, under a lock.  A chunk asks about each byte value
+ *  once and keeps the answer, so multi-byte code pages don't take the lock per character.
+ *
+ *  A chunk's colourise call starts in style 0 and can't see the styles, line states or levels
+ *  of the text before it, only their defaults.  That is what a safe line start has to promise.
+ *
+ *  Small ranges, single processor machines, and "lexer.parallel=0" all get false back, and
+ *  the lexer then styles the range itself as before.
+ *
+ *  Folding carries the fold level from each line to the next, but what a line does to the
+ *  level rarely depends on the level it starts at.  foldLevels has a lexer's FoldLineFunction
+ *  work out each line's net change ( and the lowest it dips before an opener, for "} else {" )
+ *  on its own, a chunk of lines per processor, then adds the changes up from the level of the
+ *  first line.  The lexer is left with the absolute levels of every line to flag and set.  The
+ *  text and styles are copied from the Accessor on the calling thread first, as only it can
+ *  ask Scintilla for styles.  Every line of the copy is then classified once, as a comment
+ *  line or not and as visible or blank, so the fold functions look the lines around them up
+ *  rather than reading them again.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_PARALLELLEX_H
+#define NPP_PLUGININTERFACE_EXTLEXER_PARALLELLEX_H
+
+#include "NppPluginIface_ExtLexer.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Accessor.h"
+
+class WordList;
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+//  A lexer's styling function, as called for the whole range when not run in parallel.
+typedef void (*ColouriseFunction)( unsigned int startPos, int length, int initStyle,
+	WordList* keywordlists[], Accessor& styler );
+
+//  Returns whether lexing can start over in style 0 at lineStart.  Called on the calling
+//  thread, with text being the whole document.
+typedef bool (*SafeLineStartFunction)( Accessor& styler, const char* text, int lineStart );
+
+//  Styles [startPos, startPos + length) in parallel chunks.  Returns false, having changed
+//  nothing, when the range isn't split; the caller then styles it the usual way.
+bool colouriseInParallel( Accessor& styler, unsigned int startPos, int length, int initStyle,
+	WordList* keywordlists[], ColouriseFunction colourise, SafeLineStartFunction safeLineStart );
+
+//  <--- Task Running --->
+
+//  One of nbTasks independent tasks, index being which one.
+typedef void (*TaskFunction)( void* context, int index );
+
+//  Runs task( context, 0 ) to task( context, nbTasks - 1 ) on the Windows thread pool and the
+//  calling thread, returning when all of them are done.
+void runTasks( int nbTasks, TaskFunction task, void* context );
+
+//  How many threads runTasks will use, the number of processors.
+int workerCount();
+
+//  <--- Fold Levels --->
+
+//  The text and styles of a fold range, with the lines on either side, for FoldLineFunctions to
+//  read from any thread.  Positions are document positions; outside of the copy text reads as
+//  spaces and styles as 0.
+//
+//  Each line of the copy is classified once, right after the copy is made, so a fold asking
+//  about the lines around each comment line reads a flag instead of the line again.  Lines are numbered
+//  from the first line of the copy, the one before the fold range's first line.
+class FoldText {
+	//  Private so the compiler doesn't generate them.
+	FoldText( const FoldText& source );
+	FoldText& operator=( const FoldText& );
+
+public:
+	//  A comment line is one whose first character other than space or tab starts commentLeader.
+	FoldText( Accessor& styler, int startPos, int endPos, const char* commentLeader );
+
+	char charAt( int position ) const {
+		return ( ( position >= _start && position < _end ) ? ( _text[position - _start] ) : ( ' ' ) );
+	}
+	int styleAt( int position ) const {
+		return ( ( position >= _start && position < _end ) ? ( _styles[position - _start] ) : ( 0 ) );
+	}
+
+	enum LineClass {
+		LINE_VISIBLE = 1,					//  Has characters other than space and 0x09 - 0x0D.
+		LINE_COMMENT = 2
+	};
+
+	int lineCount() const { return ( _lineStarts.size() ); }
+	int lineStart( int line ) const { return ( _lineStarts[line] ); }
+	int lineEnd( int line ) const {			//  Start of the next line, line end included.
+		return ( ( line + 1 < lineCount() ) ? ( _lineStarts[line + 1] ) : ( _end ) );
+	}
+	int lineOf( int position ) const;		//  -1 for a position before the copy.
+
+	//  Lines outside of the copy are neither.
+	bool isCommentLine( int line ) const { return ( lineClass( line ) & LINE_COMMENT ) != 0; }
+	bool isVisibleLine( int line ) const { return ( lineClass( line ) & LINE_VISIBLE ) != 0; }
+
+private:
+	unsigned char lineClass( int line ) const {
+		return ( ( line >= 0 && line < lineCount() ) ? ( _lineClasses[line] ) : ( 0 ) );
+	}
+
+	int _start;
+	int _end;
+	const char* _text;						//  Into the document, or into _copy.
+	std::string _copy;
+	std::vector<unsigned char> _styles;
+	std::vector<int> _lineStarts;
+	std::vector<unsigned char> _lineClasses;
+};
+
+//  What one line does to the fold level, relative to the level it starts at.
+struct LineFold {
+	int delta;								//  Net change over the line.
+	int minDelta;							//  Lowest before an opener, 0 or less.
+	bool visible;							//  Has characters other than white space.
+};
+
+//  Works out fold for line, [lineStart, lineEnd) of text, which includes its line end.  fold
+//  comes in with visible set from the line's class and the deltas zeroed.  May be called on
+//  any thread, so only text and context are to be read.
+typedef void (*FoldLineFunction)( const FoldText& text, int line, int lineStart, int lineEnd,
+	void* context, LineFold& fold );
+
+//  A line's absolute fold levels.
+struct LineLevels {
+	int start;								//  Level the line starts at.
+	int min;								//  Lowest before an opener, start if none.
+	int end;								//  Level the next line starts at.
+	bool visible;
+	bool ended;								//  False for a last line cut short by the range.
+};
+
+//  Fills levels with one entry per line of [startPos, startPos + length), from the line at
+//  startPos, whose level is levelStart.  Large ranges are scanned on all processors.
+//  commentLeader is what FoldText classifies comment lines by.
+void foldLevels( Accessor& styler, unsigned int startPos, int length, int levelStart,
+	const char* commentLeader, FoldLineFunction foldLine, void* context,
+	std::vector<LineLevels>& levels );
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_PARALLELLEX_H
@@ -0,0 +1,226 @@
+/* NppPluginIface_ExtLexer_RunAccessor.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing an Accessor that lets a lexer colourise,
+ *  highlight, and fold a range in a single lexer call.
+ *
+ *  Runs are only ever appended; StyleContext colours from StartAt() onward without gaps.  A
+ *  ColourTo() that doesn't continue the last run starts the runs over from there.
+ *
+ */
+
+#include "NppPluginIface_ExtLexer_RunAccessor.h"
+
+//  <--- STL --->
+#include <algorithm>
+
+namespace npp_plugin {
+
+namespace external_lexer {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const int NO_LEVEL = -1;				//  Queue slot for a line whose level wasn't set.
+
+}  // End: Un-named namespace
+
+
+RunAccessor::RunAccessor( Accessor& target )
+	:_target(target), _runsStart(0), _lastRun(0), _stylingMask(31), _pShadow(NULL),
+	_pListener(NULL), _firstLevelLine(0)
+{
+	_lenDoc = _target.Length();
+
+	//  Any non-zero code page routes IsLeadByte() to the wrapped accessor's answer.
+	codePage = 1;
+}
+
+RunAccessor::~RunAccessor()
+{
+}
+
+//  Loads the buffer around position from the wrapped accessor's own buffer.
+void RunAccessor::Fill( int position )
+{
+	startPos = position - slopSize;
+	if ( startPos + bufferSize > _lenDoc ) startPos = _lenDoc - bufferSize;
+	if ( startPos < 0 ) startPos = 0;
+	endPos = startPos + bufferSize;
+	if ( endPos > _lenDoc ) endPos = _lenDoc;
+
+	for ( int i = startPos; i < endPos; i++ ) buf[i - startPos] = _target.SafeGetCharAt( i );
+	buf[endPos - startPos] = '\0';
+}
+
+bool RunAccessor::Match( int pos, const char* s )
+{
+	for ( int i = 0; *s; i++, s++ ) {
+		if ( *s != SafeGetCharAt( pos + i ) ) return ( false );
+	}
+	return ( true );
+}
+
+//  Styles written since StartAt() come from the runs, the rest from the wrapped accessor.
+char RunAccessor::StyleAt( int position )
+{
+	if ( _runEnds.empty() || position < _runsStart || position >= _runEnds.back() ) {
+		return ( _target.StyleAt( position ) );
+	}
+
+	//  Lexers walk forward, so the run is nearly always the last one used or the next.
+	int lastRunStart = ( _lastRun == 0 ) ? ( _runsStart ) : ( _runEnds[_lastRun - 1] );
+	if ( position < lastRunStart || position >= _runEnds[_lastRun] ) {
+		if ( position >= _runEnds[_lastRun] && position < _runEnds[_lastRun + 1] ) {
+			_lastRun++;
+		}
+		else {
+			_lastRun = std::upper_bound( _runEnds.begin(), _runEnds.end(), position ) - _runEnds.begin();
+		}
+	}
+
+	return ( _runStyles[_lastRun] );
+}
+
+int RunAccessor::GetLine( int position ) { return ( _target.GetLine( position ) ); }
+
+int RunAccessor::LineStart( int line ) { return ( _target.LineStart( line ) ); }
+
+//  Queued levels are answered before they have been sent.
+int RunAccessor::LevelAt( int line )
+{
+	int index = line - _firstLevelLine;
+	if ( index >= 0 && index < static_cast<int>( _levels.size() ) && _levels[index] != NO_LEVEL ) {
+		return ( _levels[index] );
+	}
+	return ( _target.LevelAt( line ) );
+}
+
+int RunAccessor::Length() { return ( _lenDoc ); }
+
+//  Sends the styles, then the queued indicator fills and fold levels.
+void RunAccessor::Flush()
+{
+	_target.Flush();
+
+	if ( _pShadow ) {
+		_pShadow->apply( _target, _indicatorRuns );
+	}
+	else {
+		std::vector<IndicatorShadow::Fill>::const_iterator iRun;
+		for ( iRun = _indicatorRuns.begin(); iRun != _indicatorRuns.end(); iRun++ ) {
+			_target.IndicatorFill( iRun->start, iRun->end, iRun->indicator, iRun->value );
+		}
+	}
+	_indicatorRuns.clear();
+
+	flushLevels();
+}
+
+int RunAccessor::GetLineState( int line ) { return ( _target.GetLineState( line ) ); }
+
+int RunAccessor::SetLineState( int line, int state ) { return ( _target.SetLineState( line, state ) ); }
+
+int RunAccessor::GetPropertyInt( const char* key, int defaultValue )
+{
+	return ( _target.GetPropertyInt( key, defaultValue ) );
+}
+
+char* RunAccessor::GetProperties() { return ( _target.GetProperties() ); }
+
+void RunAccessor::StartAt( unsigned int start, char chMask )
+{
+	_target.StartAt( start, chMask );
+	_stylingMask = chMask;
+	_runsStart = start;
+	_runEnds.clear();
+	_runStyles.clear();
+	_lastRun = 0;
+}
+
+void RunAccessor::SetFlags( char chFlags_, char chWhile_ ) { _target.SetFlags( chFlags_, chWhile_ ); }
+
+unsigned int RunAccessor::GetStartSegment() { return ( _target.GetStartSegment() ); }
+
+void RunAccessor::StartSegment( unsigned int pos ) { _target.StartSegment( pos ); }
+
+//  Records the run before passing it on.
+void RunAccessor::ColourTo( unsigned int pos, int chAttr )
+{
+	int segStart = _target.GetStartSegment();
+	_target.ColourTo( pos, chAttr );
+
+	//  Only record non empty ranges
+	if ( static_cast<int>( pos ) < segStart ) return;
+
+	int runEnd = pos + 1;
+	char style = static_cast<char>( chAttr & _stylingMask );
+
+	if ( !_runEnds.empty() && segStart != _runEnds.back() ) {
+		_runEnds.clear();
+		_runStyles.clear();
+		_lastRun = 0;
+	}
+	if ( _runEnds.empty() ) _runsStart = segStart;
+
+	if ( !_runStyles.empty() && _runStyles.back() == style ) {
+		_runEnds.back() = runEnd;
+	}
+	else {
+		_runEnds.push_back( runEnd );
+		_runStyles.push_back( style );
+	}
+
+	if ( _pListener ) _pListener->styled( segStart, runEnd, style );
+}
+
+//  Levels are queued while they stay within one block of lines, lines a lexer leaves alone
+//  are skipped over.
+void RunAccessor::SetLevel( int line, int level )
+{
+	if ( !_levels.empty() && line < _firstLevelLine ) flushLevels();
+	if ( _levels.empty() ) _firstLevelLine = line;
+
+	int index = line - _firstLevelLine;
+	if ( index >= static_cast<int>( _levels.size() ) ) _levels.resize( index + 1, NO_LEVEL );
+	_levels[index] = level;
+}
+
+void RunAccessor::flushLevels()
+{
+	for ( size_t i = 0; i < _levels.size(); i++ ) {
+		if ( _levels[i] != NO_LEVEL ) _target.SetLevel( _firstLevelLine + i, _levels[i] );
+	}
+	_levels.clear();
+}
+
+int RunAccessor::IndentAmount( int line, int* flags, PFNIsCommentLeader pfnIsCommentLeader )
+{
+	return ( _target.IndentAmount( line, flags, pfnIsCommentLeader ) );
+}
+
+void RunAccessor::IndicatorFill( int start, int end, int indicator, int value )
+{
+	IndicatorShadow::Fill run = { start, end, indicator, value };
+	_indicatorRuns.push_back( run );
+}
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
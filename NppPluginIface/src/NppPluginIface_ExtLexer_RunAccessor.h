@@ -0,0 +1,131 @@
+/* NppPluginIface_ExtLexer_RunAccessor.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing an Accessor that lets a lexer colourise,
+ *  highlight, and fold a range in a single lexer call, and in a single scan of the range.
+ *
+ *  The RunAccessor wraps the Accessor Scintilla ( or the benchmark ) handed to the lexer.  The
+ *  style runs written through ColourTo() are recorded as they go by, so StyleAt() inside the
+ *  styled range is answered from memory instead of asking the window for every character.
+ *  IndicatorFill() and SetLevel() are queued and only sent on to the wrapped Accessor, after
+ *  the styles, by Flush().  Given the document's IndicatorShadow, only the indicator changes
+ *  are sent instead of every queued fill.
+ *
+ *  A RunListener is told of each run as it is written, so a lexer can highlight and fold from
+ *  the runs while it colourises instead of reading the range back afterwards.
+ *
+ *  Everything else is passed straight through to the wrapped Accessor.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_EXTLEXER_RUNACCESSOR_H
+#define NPP_PLUGININTERFACE_EXTLEXER_RUNACCESSOR_H
+
+#include "NppPluginIface_ExtLexer.h"
+#include "NppPluginIface_ExtLexer_IndicatorShadow.h"
+
+#include <cstdlib>
+#include "Accessor.h"
+
+namespace npp_plugin {
+
+//  Namespace Extension for External Lexer Interface
+namespace external_lexer {
+
+class RunAccessor : public Accessor {
+	//  Private so the compiler doesn't generate them.
+	RunAccessor( const RunAccessor& source );
+	RunAccessor& operator=( const RunAccessor& );
+
+public:
+	class RunListener {
+	public:
+		virtual ~RunListener() {}
+
+		//  [start, end) was styled style.  Runs come in document order, and one may go on
+		//  with the style of the run before it.
+		virtual void styled( int start, int end, int style ) = 0;
+	};
+
+	explicit RunAccessor( Accessor& target );
+	virtual ~RunAccessor();
+
+	//  <--- Accessor Interface --->
+	virtual bool Match( int pos, const char* s );
+	virtual char StyleAt( int position );
+	virtual int GetLine( int position );
+	virtual int LineStart( int line );
+	virtual int LevelAt( int line );
+	virtual int Length();
+	virtual void Flush();
+	virtual int GetLineState( int line );
+	virtual int SetLineState( int line, int state );
+	virtual int GetPropertyInt( const char* key, int defaultValue = 0 );
+	virtual char* GetProperties();
+
+	virtual void StartAt( unsigned int start, char chMask = 31 );
+	virtual void SetFlags( char chFlags_, char chWhile_ );
+	virtual unsigned int GetStartSegment();
+	virtual void StartSegment( unsigned int pos );
+	virtual void ColourTo( unsigned int pos, int chAttr );
+	virtual void SetLevel( int line, int level );
+	virtual int IndentAmount( int line, int* flags, PFNIsCommentLeader pfnIsCommentLeader = 0 );
+	virtual void IndicatorFill( int start, int end, int indicator, int value );
+
+	//  Indicator fills are diffed against pShadow on Flush(); NULL sends them all.
+	void setIndicatorShadow( IndicatorShadow* pShadow ) { _pShadow = pShadow; }
+
+	//  Runs written from now on are passed to pListener as well; NULL for none.
+	void setRunListener( RunListener* pListener ) { _pListener = pListener; }
+
+	//  The Accessor this one wraps.
+	Accessor& target() { return ( _target ); }
+
+	//  <--- Inspection --->
+	int getRunCount() const { return ( _runEnds.size() ); }
+
+protected:
+	virtual bool InternalIsLeadByte( char ch ) { return ( _target.IsLeadByte( ch ) ); }
+	virtual void Fill( int position );
+
+private:
+	void flushLevels();
+
+	Accessor& _target;
+	int _lenDoc;
+
+	//  Style runs since the last StartAt(), run i ends before _runEnds[i].
+	int _runsStart;
+	std::vector<int> _runEnds;
+	std::vector<char> _runStyles;
+	size_t _lastRun;
+	char _stylingMask;
+
+	std::vector<IndicatorShadow::Fill> _indicatorRuns;
+	IndicatorShadow* _pShadow;
+	RunListener* _pListener;
+	int _firstLevelLine;				//  Line of _levels[0].
+	std::vector<int> _levels;			//  Queued, or NO_LEVEL for lines not set.
+};
+
+}  // End namespace:  external_lexer
+
+}  // End namespace:  npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_EXTLEXER_RUNACCESSOR_H
@@ -0,0 +1,1217 @@
+/* NppPluginIface_HostSim.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a stand-in Notepad++/Scintilla host.
+ *
+ *  Only the messages used by the lib and the plugins in this solution are answered, anything
+ *  else returns 0 just like a SendMessage to a window that doesn't handle it.
+ *
+ *  Line ends are '\n' only, and markers on lines removed by a delete are merged into the
+ *  first line of the deletion, which is close enough to Scintilla for timing the handlers.
+ *
+ */
+
+#include "NppPluginIface.h"
+
+#ifdef NPP_PLUGININTERFACE_HOSTSIM
+
+#include "NppPluginIface_HostSim.h"
+
+//  <--- STL --->
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+//  <--- Windows --->
+#include "Shlwapi.h"
+#pragma comment( lib, "Shlwapi.lib" )
+
+#include "SciLexer.h"
+
+
+namespace npp_plugin {
+
+namespace host_sim {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const int HOST_NPP = 0;
+const int HOST_HIDDENVIEW = 3;			//  N++ lexes/loads unseen documents in a hidden view.
+const int NB_HOSTWINDOWS = 4;
+const int NB_SIMVIEWS = 2;
+const int NB_SIMINDICATORS = 32;
+const int NB_SIMMARGINS = 5;
+const int NB_SIMMARKERS = 32;
+const int NB_SIMSTYLES = 256;
+
+//  The fake window handles are the addresses of these.
+int _hostWindows[NB_HOSTWINDOWS];
+
+HWND hostWnd( int window ) { return ( reinterpret_cast<HWND>( &_hostWindows[window] ) ); }
+
+//  Marker handle details.
+struct SimMarker {
+	int line;
+	int number;
+
+	SimMarker( int line, int number ):line(line), number(number){};
+	SimMarker():line(0), number(0){};
+};
+
+//  A single undoable action.
+struct UndoAction {
+	bool isInsert;
+	int pos;
+	std::string text;
+
+	UndoAction( bool isInsert, int pos, std::string text ):isInsert(isInsert), pos(pos), text(text){};
+};
+
+//  In-memory stand-in for a Scintilla Document.
+struct SimDocument {
+	std::string text;
+	std::string styles;
+	std::vector<int> indicators;		//  One bit per indicator per character.
+	std::vector<int> lineStarts;
+	std::vector<int> lineStates;
+	std::vector<int> foldLevels;
+	std::vector<int> markerMasks;
+	std::map<int, SimMarker> markers;	//  Keyed by marker handle.
+	std::vector<UndoAction> actions;
+	int currAction;						//  Actions below this index are applied.
+	int lastMarkerHandle;
+	int endStyled;
+	int lexer;
+
+	SimDocument():currAction(0), lastMarkerHandle(0), endStyled(0), lexer(SCLEX_NULL)
+	{
+		lineStarts.push_back(0);
+		lineStates.push_back(0);
+		foldLevels.push_back(SC_FOLDLEVELBASE);
+		markerMasks.push_back(0);
+	};
+};
+
+//  Notepad++ Buffer stand-in, the address is the bufferID.
+struct SimBuffer {
+	SimDocument* doc;
+
+	SimBuffer():doc( new SimDocument ){};
+};
+
+//  Per view ( Scintilla window ) settings.
+struct SimView {
+	std::vector<SimBuffer*> tabs;
+	SimDocument emptyDoc;				//  Shown when the view has no tabs.
+	SimDocument* attachedDoc;			//  Hidden view only, the document being worked on.
+	int currTab;
+	int currPos;
+	int stylingPos;
+	int stylingMask;
+	int indicatorCurrent;
+	int indicatorValue;
+	int marginMask[NB_SIMMARGINS];
+	int marginWidth[NB_SIMMARGINS];
+	int marginType[NB_SIMMARGINS];
+	int markerType[NB_SIMMARKERS];
+	int markerFore[NB_SIMMARKERS];
+	int markerBack[NB_SIMMARKERS];
+	int markerAlpha[NB_SIMMARKERS];
+	int indicStyle[NB_SIMINDICATORS];
+	int indicFore[NB_SIMINDICATORS];
+	int indicUnder[NB_SIMINDICATORS];
+	int indicAlpha[NB_SIMINDICATORS];
+	int styleBold[NB_SIMSTYLES];
+	int styleItalic[NB_SIMSTYLES];
+	int styleUnderline[NB_SIMSTYLES];
+	int styleBack[NB_SIMSTYLES];
+
+	SimView():attachedDoc(NULL), currTab(-1), currPos(0), stylingPos(0), stylingMask(0x1f), indicatorCurrent(0),
+		indicatorValue(1)
+	{
+		for ( int i = 0; i < NB_SIMMARGINS; i++ ) marginMask[i] = marginWidth[i] = marginType[i] = 0;
+		for ( int i = 0; i < NB_SIMMARKERS; i++ ) {
+			markerType[i] = SC_MARK_CIRCLE;
+			markerFore[i] = 0;
+			markerBack[i] = 0xffffff;
+			markerAlpha[i] = SC_ALPHA_NOALPHA;
+		}
+		for ( int i = 0; i < NB_SIMINDICATORS; i++ ) {
+			indicStyle[i] = indicFore[i] = indicUnder[i] = 0;
+			indicAlpha[i] = 30;
+		}
+		for ( int i = 0; i < NB_SIMSTYLES; i++ ) {
+			styleBold[i] = styleItalic[i] = styleUnderline[i] = 0;
+			styleBack[i] = 0xffffff;
+		}
+	};
+
+	SimDocument* doc()
+	{
+		if ( attachedDoc ) return ( attachedDoc );
+		return ( tabs.empty() ? &emptyDoc : tabs[currTab]->doc );
+	}
+};
+
+//  <--- Host State --->
+bool _hostStarted = false;
+SimView _views[NB_SIMVIEWS];
+SimView _hiddenView;
+int _currView = MAIN_VIEW;
+TCHAR _configDir[MAX_PATH];
+TCHAR _nppDir[MAX_PATH];
+
+//  <--- Latency Samples --->
+LARGE_INTEGER _perfFreq;
+std::map< int, std::vector<double> > _latencySamples;
+
+//  Returns the SimView a fake window handle refers to, or NULL for anything else.
+SimView* viewFromHandle( HWND hWnd )
+{
+	if ( hWnd == hostWnd( 1 + MAIN_VIEW ) ) return ( &_views[MAIN_VIEW] );
+	if ( hWnd == hostWnd( 1 + SUB_VIEW ) ) return ( &_views[SUB_VIEW] );
+	if ( hWnd == hostWnd( HOST_HIDDENVIEW ) ) return ( &_hiddenView );
+	return ( NULL );
+}
+
+//  Timed forwarding of a notification to the plugin.
+void notify( SCNotification* scn )
+{
+	LARGE_INTEGER start, end;
+	::QueryPerformanceCounter( &start );
+	beNotified( scn );
+	::QueryPerformanceCounter( &end );
+
+	double elapsedMs = ( double( end.QuadPart - start.QuadPart ) * 1000.0 ) / double( _perfFreq.QuadPart );
+	_latencySamples[ scn->nmhdr.code ].push_back( elapsedMs );
+}
+
+//  Sends a Notepad++ notification for a buffer.
+void notifyNpp( int code, int bufferID )
+{
+	SCNotification scn;
+	::memset( &scn, 0, sizeof( scn ) );
+	scn.nmhdr.hwndFrom = hostWnd( HOST_NPP );
+	scn.nmhdr.idFrom = bufferID;
+	scn.nmhdr.code = code;
+	notify( &scn );
+}
+
+//  Sends SCN_MODIFIED from every view showing the document, or from the hidden view when the
+//  document isn't visible, the same way Scintilla's document watchers do.
+void notifyModified( SimDocument* doc, int modType, int pos, int length, int linesAdded, const char* text )
+{
+	SCNotification scn;
+	::memset( &scn, 0, sizeof( scn ) );
+	scn.nmhdr.code = SCN_MODIFIED;
+	scn.modificationType = modType;
+	scn.position = pos;
+	scn.length = length;
+	scn.linesAdded = linesAdded;
+	scn.text = text;
+
+	bool visible = false;
+	for ( int view = MAIN_VIEW; view <= SUB_VIEW; view++ ) {
+		if ( _views[view].doc() == doc ) {
+			visible = true;
+			scn.nmhdr.hwndFrom = hostWnd( 1 + view );
+			notify( &scn );
+		}
+	}
+
+	if (! visible ) {
+		_hiddenView.attachedDoc = doc;
+		scn.nmhdr.hwndFrom = hostWnd( HOST_HIDDENVIEW );
+		notify( &scn );
+	}
+}
+
+//  Returns the line containing pos.
+int lineFromPosition( SimDocument* doc, int pos )
+{
+	std::vector<int>::iterator it = std::upper_bound( doc->lineStarts.begin(), doc->lineStarts.end(), pos );
+	return ( int( it - doc->lineStarts.begin() ) - 1 );
+}
+
+//  Returns the start position of line, -1 if the line doesn't exist.
+int positionFromLine( SimDocument* doc, int line )
+{
+	if ( ( line < 0 ) || ( line >= int( doc->lineStarts.size() ) ) ) return ( -1 );
+	return ( doc->lineStarts[line] );
+}
+
+//  Recalculates the marker mask for a line from the handle map.
+void refreshMarkerMask( SimDocument* doc, int line )
+{
+	int mask = 0;
+	for ( std::map<int, SimMarker>::iterator it = doc->markers.begin(); it != doc->markers.end(); ++it ) {
+		if ( it->second.line == line ) mask |= ( 1 << it->second.number );
+	}
+	doc->markerMasks[line] = mask;
+}
+
+//  Replaces the text of a document without notifications or undo history, like N++ file loading.
+void loadText( SimDocument* doc, const std::string& text )
+{
+	*doc = SimDocument();
+	doc->text = text;
+	doc->styles.assign( text.length(), 0 );
+	doc->indicators.assign( text.length(), 0 );
+	for ( size_t i = 0; i < text.length(); i++ ) {
+		if ( text[i] == '\n' ) {
+			doc->lineStarts.push_back( int( i + 1 ) );
+		}
+	}
+	doc->lineStates.assign( doc->lineStarts.size(), 0 );
+	doc->foldLevels.assign( doc->lineStarts.size(), SC_FOLDLEVELBASE );
+	doc->markerMasks.assign( doc->lineStarts.size(), 0 );
+}
+
+//  Inserts text and sends the surrounding modification notifications.
+void applyInsert( SimDocument* doc, int pos, const std::string& text, int performed )
+{
+	int flags = performed;
+	if ( performed != SC_PERFORMED_USER ) flags |= SC_LASTSTEPINUNDOREDO;
+	int length = int( text.length() );
+
+	notifyModified( doc, ( SC_MOD_BEFOREINSERT | flags ), pos, length, 0, NULL );
+
+	int line = lineFromPosition( doc, pos );
+	doc->text.insert( pos, text );
+	doc->styles.insert( pos, length, 0 );
+	doc->indicators.insert( doc->indicators.begin() + pos, length, 0 );
+
+	for ( size_t i = line + 1; i < doc->lineStarts.size(); i++ ) doc->lineStarts[i] += length;
+
+	std::vector<int> newStarts;
+	for ( int i = 0; i < length; i++ ) {
+		if ( text[i] == '\n' ) newStarts.push_back( pos + i + 1 );
+	}
+	int linesAdded = int( newStarts.size() );
+
+	if ( linesAdded > 0 ) {
+		doc->lineStarts.insert( doc->lineStarts.begin() + line + 1, newStarts.begin(), newStarts.end() );
+		doc->lineStates.insert( doc->lineStates.begin() + line + 1, linesAdded, 0 );
+		doc->foldLevels.insert( doc->foldLevels.begin() + line + 1, linesAdded, doc->foldLevels[line] );
+		doc->markerMasks.insert( doc->markerMasks.begin() + line + 1, linesAdded, 0 );
+		for ( std::map<int, SimMarker>::iterator it = doc->markers.begin(); it != doc->markers.end(); ++it ) {
+			if ( it->second.line > line ) it->second.line += linesAdded;
+		}
+	}
+
+	if ( doc->endStyled > pos ) doc->endStyled = pos;
+
+	notifyModified( doc, ( SC_MOD_INSERTTEXT | flags ), pos, length, linesAdded, text.c_str() );
+}
+
+//  Deletes text and sends the surrounding modification notifications.
+void applyDelete( SimDocument* doc, int pos, int length, int performed )
+{
+	int flags = performed;
+	if ( performed != SC_PERFORMED_USER ) flags |= SC_LASTSTEPINUNDOREDO;
+
+	notifyModified( doc, ( SC_MOD_BEFOREDELETE | flags ), pos, length, 0, NULL );
+
+	std::string removed = doc->text.substr( pos, length );
+	int line = lineFromPosition( doc, pos );
+	int endLine = lineFromPosition( doc, pos + length );
+	int linesRemoved = endLine - line;
+
+	doc->text.erase( pos, length );
+	doc->styles.erase( pos, length );
+	doc->indicators.erase( doc->indicators.begin() + pos, doc->indicators.begin() + pos + length );
+
+	if ( linesRemoved > 0 ) {
+		doc->lineStarts.erase( doc->lineStarts.begin() + line + 1, doc->lineStarts.begin() + endLine + 1 );
+		doc->lineStates.erase( doc->lineStates.begin() + line + 1, doc->lineStates.begin() + endLine + 1 );
+		doc->foldLevels.erase( doc->foldLevels.begin() + line + 1, doc->foldLevels.begin() + endLine + 1 );
+		doc->markerMasks.erase( doc->markerMasks.begin() + line + 1, doc->markerMasks.begin() + endLine + 1 );
+		for ( std::map<int, SimMarker>::iterator it = doc->markers.begin(); it != doc->markers.end(); ++it ) {
+			if ( it->second.line > endLine ) it->second.line -= linesRemoved;
+			else if ( it->second.line > line ) it->second.line = line;
+		}
+		refreshMarkerMask( doc, line );
+	}
+
+	for ( size_t i = line + 1; i < doc->lineStarts.size(); i++ ) doc->lineStarts[i] -= length;
+
+	if ( doc->endStyled > pos ) doc->endStyled = pos;
+
+	notifyModified( doc, ( SC_MOD_DELETETEXT | flags ), pos, length, -linesRemoved, removed.c_str() );
+}
+
+//  Finds the matching brace using the same 'same style' rule as Scintilla.
+int braceMatch( SimDocument* doc, int pos )
+{
+	if ( ( pos < 0 ) || ( pos >= int( doc->text.length() ) ) ) return ( -1 );
+
+	char chBrace = doc->text[pos];
+	char chSeek;
+	int direction;
+	switch ( chBrace )
+	{
+		case '(': chSeek = ')'; direction = 1; break;
+		case ')': chSeek = '('; direction = -1; break;
+		case '[': chSeek = ']'; direction = 1; break;
+		case ']': chSeek = '['; direction = -1; break;
+		case '{': chSeek = '}'; direction = 1; break;
+		case '}': chSeek = '{'; direction = -1; break;
+		case '<': chSeek = '>'; direction = 1; break;
+		case '>': chSeek = '<'; direction = -1; break;
+		default: return ( -1 );
+	}
+
+	char styBrace = doc->styles[pos];
+	int depth = 1;
+	for ( int i = pos + direction; ( i >= 0 ) && ( i < int( doc->text.length() ) ); i += direction ) {
+		if ( doc->styles[i] != styBrace ) continue;
+		if ( doc->text[i] == chBrace ) depth++;
+		else if ( doc->text[i] == chSeek ) {
+			if ( --depth == 0 ) return ( i );
+		}
+	}
+	return ( -1 );
+}
+
+//  Answers Scintilla messages sent to one of the views.
+LRESULT sciMessage( SimView* view, UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+	SimDocument* doc = view->doc();
+	int length = int( doc->text.length() );
+
+	switch ( Msg )
+	{
+		//  <--- Document --->
+		case SCI_GETDOCPOINTER:
+			return ( reinterpret_cast<LRESULT>( doc ) );
+
+		case SCI_GETLENGTH:
+		case SCI_GETTEXTLENGTH:
+			return ( length );
+
+		case SCI_GETCHARAT:
+			if ( ( int( wParam ) < 0 ) || ( int( wParam ) >= length ) ) return ( 0 );
+			return ( doc->text[wParam] );
+
+		case SCI_GETTEXTRANGE:
+		{
+			TextRange* tr = reinterpret_cast<TextRange*>( lParam );
+			int cpMax = ( tr->chrg.cpMax < 0 ) ? ( length ) : ( min( int( tr->chrg.cpMax ), length ) );
+			int cpMin = max( int( tr->chrg.cpMin ), 0 );
+			int n = max( cpMax - cpMin, 0 );
+			::memcpy( tr->lpstrText, doc->text.data() + cpMin, n );
+			tr->lpstrText[n] = '\0';
+			return ( n );
+		}
+
+		case SCI_GETCHARACTERPOINTER:
+			return ( reinterpret_cast<LRESULT>( doc->text.c_str() ) );
+
+		case SCI_GETLINECOUNT:
+			return ( doc->lineStarts.size() );
+
+		case SCI_LINEFROMPOSITION:
+			return ( lineFromPosition( doc, min( int( wParam ), length ) ) );
+
+		case SCI_POSITIONFROMLINE:
+			if ( int( wParam ) < 0 ) return ( positionFromLine( doc, lineFromPosition( doc, view->currPos ) ) );
+			return ( positionFromLine( doc, wParam ) );
+
+		case SCI_GETLINEENDPOSITION:
+		{
+			if ( int( wParam ) + 1 < int( doc->lineStarts.size() ) ) return ( doc->lineStarts[wParam + 1] - 1 );
+			return ( length );
+		}
+
+		case SCI_GETCURRENTPOS:
+			return ( view->currPos );
+
+		case SCI_GOTOPOS:
+			view->currPos = min( int( wParam ), length );
+			return ( 0 );
+
+		case SCI_GOTOLINE:
+			view->currPos = max( positionFromLine( doc, wParam ), 0 );
+			return ( 0 );
+
+		case SCI_CANUNDO:
+			return ( doc->currAction > 0 );
+
+		case SCI_CANREDO:
+			return ( doc->currAction < int( doc->actions.size() ) );
+
+		case SCI_UNDO:
+			return ( undo( ( view == &_views[SUB_VIEW] ) ? ( SUB_VIEW ) : ( MAIN_VIEW ) ) );
+
+		case SCI_REDO:
+			return ( redo( ( view == &_views[SUB_VIEW] ) ? ( SUB_VIEW ) : ( MAIN_VIEW ) ) );
+
+		case SCI_GETLEXER:
+			return ( doc->lexer );
+
+		case SCI_SETLEXER:
+			doc->lexer = wParam;
+			return ( 0 );
+
+		case SCI_BRACEMATCH:
+			return ( braceMatch( doc, wParam ) );
+
+		//  <--- Styling --->
+		case SCI_GETSTYLEAT:
+			if ( ( int( wParam ) < 0 ) || ( int( wParam ) >= length ) ) return ( 0 );
+			return ( static_cast<unsigned char>( doc->styles[wParam] ) );
+
+		case SCI_GETSTYLEDTEXT:
+		{
+			TextRange* tr = reinterpret_cast<TextRange*>( lParam );
+			int cpMax = ( tr->chrg.cpMax < 0 ) ? ( length ) : ( min( int( tr->chrg.cpMax ), length ) );
+			int cpMin = max( int( tr->chrg.cpMin ), 0 );
+			int n = max( cpMax - cpMin, 0 );
+			for ( int i = 0; i < n; i++ ) {
+				tr->lpstrText[2 * i] = doc->text[cpMin + i];
+				tr->lpstrText[2 * i + 1] = doc->styles[cpMin + i];
+			}
+			tr->lpstrText[2 * n] = '\0';
+			tr->lpstrText[2 * n + 1] = '\0';
+			return ( 2 * n );
+		}
+
+		case SCI_GETENDSTYLED:
+			return ( doc->endStyled );
+
+		case SCI_STARTSTYLING:
+			view->stylingPos = wParam;
+			view->stylingMask = lParam;
+			return ( 0 );
+
+		case SCI_SETSTYLING:
+		{
+			for ( int i = 0; ( i < int( wParam ) ) && ( view->stylingPos < length ); i++, view->stylingPos++ ) {
+				char& style = doc->styles[view->stylingPos];
+				style = char( ( style & ~view->stylingMask ) | ( lParam & view->stylingMask ) );
+			}
+			doc->endStyled = view->stylingPos;
+			return ( 0 );
+		}
+
+		case SCI_SETSTYLINGEX:
+		{
+			const char* styles = reinterpret_cast<const char*>( lParam );
+			for ( int i = 0; ( i < int( wParam ) ) && ( view->stylingPos < length ); i++, view->stylingPos++ ) {
+				char& style = doc->styles[view->stylingPos];
+				style = char( ( style & ~view->stylingMask ) | ( styles[i] & view->stylingMask ) );
+			}
+			doc->endStyled = view->stylingPos;
+			return ( 0 );
+		}
+
+		case SCI_GETLINESTATE:
+			if ( int( wParam ) >= int( doc->lineStates.size() ) ) return ( 0 );
+			return ( doc->lineStates[wParam] );
+
+		case SCI_SETLINESTATE:
+			if ( int( wParam ) < int( doc->lineStates.size() ) ) doc->lineStates[wParam] = lParam;
+			return ( 0 );
+
+		case SCI_GETFOLDLEVEL:
+			if ( int( wParam ) >= int( doc->foldLevels.size() ) ) return ( SC_FOLDLEVELBASE );
+			return ( doc->foldLevels[wParam] );
+
+		case SCI_SETFOLDLEVEL:
+			if ( int( wParam ) < int( doc->foldLevels.size() ) ) doc->foldLevels[wParam] = lParam;
+			return ( 0 );
+
+		case SCI_STYLEGETBOLD: return ( view->styleBold[wParam & 0xff] );
+		case SCI_STYLEGETITALIC: return ( view->styleItalic[wParam & 0xff] );
+		case SCI_STYLEGETUNDERLINE: return ( view->styleUnderline[wParam & 0xff] );
+		case SCI_STYLEGETBACK: return ( view->styleBack[wParam & 0xff] );
+		case SCI_STYLESETBOLD: view->styleBold[wParam & 0xff] = lParam; return ( 0 );
+		case SCI_STYLESETITALIC: view->styleItalic[wParam & 0xff] = lParam; return ( 0 );
+		case SCI_STYLESETUNDERLINE: view->styleUnderline[wParam & 0xff] = lParam; return ( 0 );
+		case SCI_STYLESETBACK: view->styleBack[wParam & 0xff] = lParam; return ( 0 );
+
+		//  <--- Indicators --->
+		case SCI_INDICSETSTYLE: view->indicStyle[wParam & 0x1f] = lParam; return ( 0 );
+		case SCI_INDICGETSTYLE: return ( view->indicStyle[wParam & 0x1f] );
+		case SCI_INDICSETFORE: view->indicFore[wParam & 0x1f] = lParam; return ( 0 );
+		case SCI_INDICGETFORE: return ( view->indicFore[wParam & 0x1f] );
+		case SCI_INDICSETUNDER: view->indicUnder[wParam & 0x1f] = lParam; return ( 0 );
+		case SCI_INDICGETUNDER: return ( view->indicUnder[wParam & 0x1f] );
+		case SCI_INDICSETALPHA: view->indicAlpha[wParam & 0x1f] = lParam; return ( 0 );
+		case SCI_INDICGETALPHA: return ( view->indicAlpha[wParam & 0x1f] );
+
+		case SCI_SETINDICATORCURRENT: view->indicatorCurrent = wParam & 0x1f; return ( 0 );
+		case SCI_GETINDICATORCURRENT: return ( view->indicatorCurrent );
+		case SCI_SETINDICATORVALUE: view->indicatorValue = wParam; return ( 0 );
+		case SCI_GETINDICATORVALUE: return ( view->indicatorValue );
+
+		case SCI_INDICATORFILLRANGE:
+		case SCI_INDICATORCLEARRANGE:
+		{
+			int bit = ( 1 << view->indicatorCurrent );
+			bool fill = ( ( Msg == SCI_INDICATORFILLRANGE ) && ( view->indicatorValue != 0 ) );
+			int end = min( int( wParam + lParam ), length );
+			for ( int i = max( int( wParam ), 0 ); i < end; i++ ) {
+				if ( fill ) doc->indicators[i] |= bit;
+				else doc->indicators[i] &= ~bit;
+			}
+			return ( 0 );
+		}
+
+		case SCI_INDICATORALLONFOR:
+			if ( ( int( wParam ) < 0 ) || ( int( wParam ) >= length ) ) return ( 0 );
+			return ( doc->indicators[wParam] );
+
+		case SCI_INDICATORVALUEAT:
+			if ( ( int( lParam ) < 0 ) || ( int( lParam ) >= length ) ) return ( 0 );
+			return ( ( doc->indicators[lParam] >> ( wParam & 0x1f ) ) & 1 );
+
+		//  <--- Margins --->
+		case SCI_GETMARGINMASKN: return ( ( wParam < NB_SIMMARGINS ) ? ( view->marginMask[wParam] ) : ( 0 ) );
+		case SCI_GETMARGINWIDTHN: return ( ( wParam < NB_SIMMARGINS ) ? ( view->marginWidth[wParam] ) : ( 0 ) );
+		case SCI_GETMARGINTYPEN: return ( ( wParam < NB_SIMMARGINS ) ? ( view->marginType[wParam] ) : ( 0 ) );
+		case SCI_SETMARGINMASKN: if ( wParam < NB_SIMMARGINS ) view->marginMask[wParam] = lParam; return ( 0 );
+		case SCI_SETMARGINWIDTHN: if ( wParam < NB_SIMMARGINS ) view->marginWidth[wParam] = lParam; return ( 0 );
+		case SCI_SETMARGINTYPEN: if ( wParam < NB_SIMMARGINS ) view->marginType[wParam] = lParam; return ( 0 );
+
+		//  <--- Markers --->
+		case SCI_MARKERDEFINE: view->markerType[wParam & 0x1f] = lParam; return ( 0 );
+		case SCI_MARKERDEFINEPIXMAP: view->markerType[wParam & 0x1f] = SC_MARK_PIXMAP; return ( 0 );
+		case SCI_MARKERSETFORE: view->markerFore[wParam & 0x1f] = lParam; return ( 0 );
+		case SCI_MARKERSETBACK: view->markerBack[wParam & 0x1f] = lParam; return ( 0 );
+		case SCI_MARKERSETALPHA: view->markerAlpha[wParam & 0x1f] = lParam; return ( 0 );
+
+		case SCI_MARKERADD:
+		{
+			int line = wParam;
+			if ( ( line < 0 ) || ( line >= int( doc->lineStarts.size() ) ) ) return ( -1 );
+			int handle = ++doc->lastMarkerHandle;
+			doc->markers[handle] = SimMarker( line, lParam & 0x1f );
+			doc->markerMasks[line] |= ( 1 << ( lParam & 0x1f ) );
+			return ( handle );
+		}
+
+		case SCI_MARKERDELETE:
+		{
+			int line = wParam;
+			if ( ( line < 0 ) || ( line >= int( doc->lineStarts.size() ) ) ) return ( 0 );
+			for ( std::map<int, SimMarker>::iterator it = doc->markers.begin(); it != doc->markers.end(); ) {
+				if ( ( it->second.line == line ) && ( ( int( lParam ) == -1 ) || ( it->second.number == int( lParam ) ) ) ) {
+					doc->markers.erase( it++ );
+					//  Scintilla only removes one marker per call unless -1 is used.
+					if ( int( lParam ) != -1 ) break;
+				}
+				else ++it;
+			}
+			refreshMarkerMask( doc, line );
+			return ( 0 );
+		}
+
+		case SCI_MARKERDELETEALL:
+		{
+			for ( std::map<int, SimMarker>::iterator it = doc->markers.begin(); it != doc->markers.end(); ) {
+				if ( ( int( wParam ) == -1 ) || ( it->second.number == int( wParam ) ) ) {
+					doc->markerMasks[it->second.line] &= ~( 1 << it->second.number );
+					doc->markers.erase( it++ );
+				}
+				else ++it;
+			}
+			return ( 0 );
+		}
+
+		case SCI_MARKERDELETEHANDLE:
+		{
+			std::map<int, SimMarker>::iterator it = doc->markers.find( wParam );
+			if ( it != doc->markers.end() ) {
+				int line = it->second.line;
+				doc->markers.erase( it );
+				refreshMarkerMask( doc, line );
+			}
+			return ( 0 );
+		}
+
+		case SCI_MARKERLINEFROMHANDLE:
+		{
+			std::map<int, SimMarker>::iterator it = doc->markers.find( wParam );
+			return ( ( it == doc->markers.end() ) ? ( -1 ) : ( it->second.line ) );
+		}
+
+		case SCI_MARKERGET:
+			if ( ( int( wParam ) < 0 ) || ( int( wParam ) >= int( doc->markerMasks.size() ) ) ) return ( 0 );
+			return ( doc->markerMasks[wParam] );
+
+		case SCI_MARKERNEXT:
+		{
+			for ( int line = max( int( wParam ), 0 ); line < int( doc->markerMasks.size() ); line++ ) {
+				if ( doc->markerMasks[line] & lParam ) return ( line );
+			}
+			return ( -1 );
+		}
+
+		case SCI_MARKERPREVIOUS:
+		{
+			for ( int line = min( int( wParam ), int( doc->markerMasks.size() ) - 1 ); line >= 0; line-- ) {
+				if ( doc->markerMasks[line] & lParam ) return ( line );
+			}
+			return ( -1 );
+		}
+
+		default:
+			return ( 0 );
+	}
+}
+
+//  Returns the view and tab index of a bufferID, false if it isn't open.
+bool findBuffer( int bufferID, int& view, int& tab )
+{
+	for ( view = MAIN_VIEW; view <= SUB_VIEW; view++ ) {
+		for ( tab = 0; tab < int( _views[view].tabs.size() ); tab++ ) {
+			if ( reinterpret_cast<int>( _views[view].tabs[tab] ) == bufferID ) return ( true );
+		}
+	}
+	return ( false );
+}
+
+//  Answers Notepad++ messages.
+LRESULT nppMessage( UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+	switch ( Msg )
+	{
+		case NPPM_GETCURRENTSCINTILLA:
+			*( reinterpret_cast<int*>( lParam ) ) = _currView;
+			return ( TRUE );
+
+		case NPPM_GETNBOPENFILES:
+			if ( lParam == PRIMARY_VIEW ) return ( _views[MAIN_VIEW].tabs.size() );
+			if ( lParam == SECOND_VIEW ) return ( _views[SUB_VIEW].tabs.size() );
+			return ( _views[MAIN_VIEW].tabs.size() + _views[SUB_VIEW].tabs.size() );
+
+		case NPPM_GETBUFFERIDFROMPOS:
+			if ( ( lParam < MAIN_VIEW ) || ( lParam > SUB_VIEW ) ) return ( 0 );
+			if ( int( wParam ) >= int( _views[lParam].tabs.size() ) ) return ( 0 );
+			return ( reinterpret_cast<LRESULT>( _views[lParam].tabs[wParam] ) );
+
+		case NPPM_GETCURRENTBUFFERID:
+			if ( _views[_currView].tabs.empty() ) return ( 0 );
+			return ( reinterpret_cast<LRESULT>( _views[_currView].tabs[ _views[_currView].currTab ] ) );
+
+		case NPPM_GETPOSFROMBUFFERID:
+		{
+			int view, tab;
+			if (! findBuffer( wParam, view, tab ) ) return ( -1 );
+			return ( ( view << 30 ) | tab );
+		}
+
+		case NPPM_ACTIVATEDOC:
+			activateDocument( wParam, lParam );
+			return ( TRUE );
+
+		case NPPM_GETCURRENTDOCINDEX:
+			if ( ( wParam > SUB_VIEW ) || _views[wParam].tabs.empty() ) return ( -1 );
+			return ( _views[wParam].currTab );
+
+		case NPPM_GETPLUGINSCONFIGDIR:
+			::lstrcpyn( reinterpret_cast<TCHAR*>( lParam ), _configDir, wParam );
+			return ( TRUE );
+
+		case NPPM_GETNPPDIRECTORY:
+			::lstrcpyn( reinterpret_cast<TCHAR*>( lParam ), _nppDir, wParam );
+			return ( TRUE );
+
+		case NPPM_SETMENUITEMCHECK:
+		case NPPM_MENUCOMMAND:
+			return ( TRUE );
+
+		//  There are no other plugins loaded, so inter-plugin messages never arrive.
+		case NPPM_MSGTOPLUGIN:
+		case NPPM_GETMENUHANDLE:
+		case NPPM_DOOPEN:
+		default:
+			return ( 0 );
+	}
+}
+
+//  Returns the display name for a notification code used in the latency report.
+std::string notificationName( int code )
+{
+	switch ( code )
+	{
+		case SCN_MODIFIED: return ( "SCN_MODIFIED" );
+		case NPPN_READY: return ( "NPPN_READY" );
+		case NPPN_TBMODIFICATION: return ( "NPPN_TBMODIFICATION" );
+		case NPPN_FILEOPENED: return ( "NPPN_FILEOPENED" );
+		case NPPN_FILEBEFORECLOSE: return ( "NPPN_FILEBEFORECLOSE" );
+		case NPPN_FILECLOSED: return ( "NPPN_FILECLOSED" );
+		case NPPN_FILEBEFORESAVE: return ( "NPPN_FILEBEFORESAVE" );
+		case NPPN_FILESAVED: return ( "NPPN_FILESAVED" );
+		case NPPN_BUFFERACTIVATED: return ( "NPPN_BUFFERACTIVATED" );
+		case NPPN_WORDSTYLESUPDATED: return ( "NPPN_WORDSTYLESUPDATED" );
+		default:
+		{
+			std::ostringstream name;
+			name << "code " << code;
+			return ( name.str() );
+		}
+	}
+}
+
+//  Writes the latency summary for all notification codes.
+void writeLatencyReport( std::ostream& out, const std::string& label )
+{
+	out << "[" << label << "]\n";
+	for ( std::map< int, std::vector<double> >::iterator it = _latencySamples.begin();
+			it != _latencySamples.end(); ++it ) {
+		LatencySummary s = getLatency( it->first );
+		out << notificationName( it->first )
+			<< "  count=" << s.count
+			<< "  total_ms=" << s.totalMs
+			<< "  p50_ms=" << s.p50Ms
+			<< "  p99_ms=" << s.p99Ms
+			<< "  max_ms=" << s.maxMs << "\n";
+	}
+}
+
+//  Generates nbLines lines of filler text.
+std::string generateText( int nbLines, const std::string& lineText )
+{
+	std::string text;
+	text.reserve( nbLines * ( lineText.length() + 1 ) );
+	for ( int i = 0; i < nbLines; i++ ) {
+		text.append( lineText );
+		if ( i + 1 < nbLines ) text.append( "\n" );
+	}
+	return ( text );
+}
+
+//  Expands \n and \t escapes in script text arguments.
+std::string unescape( const std::string& s )
+{
+	std::string result;
+	for ( size_t i = 0; i < s.length(); i++ ) {
+		if ( ( s[i] == '\\' ) && ( i + 1 < s.length() ) ) {
+			char next = s[++i];
+			if ( next == 'n' ) result += '\n';
+			else if ( next == 't' ) result += '\t';
+			else result += next;
+		}
+		else result += s[i];
+	}
+	return ( result );
+}
+
+//  Converts a plain ascii string to a tstring.
+tstring toTString( const std::string& s )
+{
+	tstring result( s.length(), '\0' );
+	std::copy( s.begin(), s.end(), result.begin() );
+	return ( result );
+}
+
+}  // End: Un-named namespace
+
+
+//  Sets up the host windows and runs the plugin through a normal Notepad++ start up:
+//  setInfo, getFuncsArray, NPPN_TBMODIFICATION and NPPN_READY.
+void initHost( tstring configDir )
+{
+	if ( _hostStarted ) return;
+	_hostStarted = true;
+
+	::QueryPerformanceFrequency( &_perfFreq );
+
+	if ( configDir.empty() ) {
+		::GetTempPath( MAX_PATH, _configDir );
+		PathAppend( _configDir, TEXT("NppHostSim") );
+	}
+	else {
+		::lstrcpyn( _configDir, configDir.c_str(), MAX_PATH );
+	}
+	::CreateDirectory( _configDir, NULL );
+	::lstrcpyn( _nppDir, _configDir, MAX_PATH );
+
+	//  Notepad++ always starts with an empty 'new 1' tab in the main view.
+	_views[MAIN_VIEW].tabs.push_back( new SimBuffer );
+	_views[MAIN_VIEW].currTab = 0;
+	_currView = MAIN_VIEW;
+
+	NppData nppData;
+	nppData._nppHandle = hostWnd( HOST_NPP );
+	nppData._scintillaMainHandle = hostWnd( 1 + MAIN_VIEW );
+	nppData._scintillaSecondHandle = hostWnd( 1 + SUB_VIEW );
+	setInfo( nppData );
+
+	int nbFuncItems;
+	getFuncsArray( &nbFuncItems );
+
+	notifyNpp( NPPN_TBMODIFICATION, 0 );
+	notifyNpp( NPPN_READY, 0 );
+}
+
+//  Closes every open document and clears the host's latency samples.
+void shutdownHost()
+{
+	for ( int view = SUB_VIEW; view >= MAIN_VIEW; view-- ) {
+		while (! _views[view].tabs.empty() ) {
+			closeDocument( view, int( _views[view].tabs.size() ) - 1 );
+		}
+	}
+	resetLatency();
+}
+
+//  Opens a new tab in view holding text and activates it.
+int openDocument( int view, const std::string& text )
+{
+	SimBuffer* buffer = new SimBuffer;
+	loadText( buffer->doc, text );
+
+	int bufferID = reinterpret_cast<int>( buffer );
+	_views[view].tabs.push_back( buffer );
+	notifyNpp( NPPN_FILEOPENED, bufferID );
+	activateDocument( view, int( _views[view].tabs.size() ) - 1 );
+
+	return ( bufferID );
+}
+
+//  Switches view to the tab and makes it the focused view.
+void activateDocument( int view, int tab )
+{
+	if ( ( view < MAIN_VIEW ) || ( view > SUB_VIEW ) ) return;
+	if ( ( tab < 0 ) || ( tab >= int( _views[view].tabs.size() ) ) ) return;
+
+	_currView = view;
+	_views[view].currTab = tab;
+	_views[view].currPos = 0;
+	notifyNpp( NPPN_BUFFERACTIVATED, reinterpret_cast<int>( _views[view].tabs[tab] ) );
+}
+
+//  Closes a tab, activating its neighbour the way Notepad++ does.
+void closeDocument( int view, int tab )
+{
+	if ( ( tab < 0 ) || ( tab >= int( _views[view].tabs.size() ) ) ) return;
+
+	SimBuffer* buffer = _views[view].tabs[tab];
+	int bufferID = reinterpret_cast<int>( buffer );
+
+	notifyNpp( NPPN_FILEBEFORECLOSE, bufferID );
+	_views[view].tabs.erase( _views[view].tabs.begin() + tab );
+	if ( _hiddenView.attachedDoc == buffer->doc ) _hiddenView.attachedDoc = NULL;
+	delete buffer->doc;
+	delete buffer;
+	notifyNpp( NPPN_FILECLOSED, bufferID );
+
+	if ( _views[view].tabs.empty() ) {
+		_views[view].currTab = -1;
+	}
+	else {
+		activateDocument( view, min( tab, int( _views[view].tabs.size() ) - 1 ) );
+	}
+}
+
+//  Saves the current document of view.
+void saveDocument( int view )
+{
+	if ( _views[view].tabs.empty() ) return;
+
+	int bufferID = reinterpret_cast<int>( _views[view].tabs[ _views[view].currTab ] );
+	_currView = view;
+	notifyNpp( NPPN_FILEBEFORESAVE, bufferID );
+	notifyNpp( NPPN_FILESAVED, bufferID );
+}
+
+//  User insertion into the current document of view.
+void insertText( int view, int pos, const std::string& text )
+{
+	if ( text.empty() ) return;
+
+	SimDocument* doc = _views[view].doc();
+	pos = max( 0, min( pos, int( doc->text.length() ) ) );
+	_currView = view;
+
+	doc->actions.erase( doc->actions.begin() + doc->currAction, doc->actions.end() );
+	doc->actions.push_back( UndoAction( true, pos, text ) );
+	doc->currAction++;
+
+	applyInsert( doc, pos, text, SC_PERFORMED_USER );
+	_views[view].currPos = pos + int( text.length() );
+}
+
+//  User deletion from the current document of view.
+void deleteText( int view, int pos, int length )
+{
+	SimDocument* doc = _views[view].doc();
+	pos = max( 0, min( pos, int( doc->text.length() ) ) );
+	length = min( length, int( doc->text.length() ) - pos );
+	if ( length <= 0 ) return;
+	_currView = view;
+
+	doc->actions.erase( doc->actions.begin() + doc->currAction, doc->actions.end() );
+	doc->actions.push_back( UndoAction( false, pos, doc->text.substr( pos, length ) ) );
+	doc->currAction++;
+
+	applyDelete( doc, pos, length, SC_PERFORMED_USER );
+	_views[view].currPos = pos;
+}
+
+//  Undoes the last action in the current document of view.
+bool undo( int view )
+{
+	SimDocument* doc = _views[view].doc();
+	if ( doc->currAction == 0 ) return ( false );
+	_currView = view;
+
+	UndoAction& action = doc->actions[ --doc->currAction ];
+	if ( action.isInsert ) applyDelete( doc, action.pos, int( action.text.length() ), SC_PERFORMED_UNDO );
+	else applyInsert( doc, action.pos, action.text, SC_PERFORMED_UNDO );
+
+	return ( true );
+}
+
+//  Redoes the next action in the current document of view.
+bool redo( int view )
+{
+	SimDocument* doc = _views[view].doc();
+	if ( doc->currAction >= int( doc->actions.size() ) ) return ( false );
+	_currView = view;
+
+	UndoAction& action = doc->actions[ doc->currAction++ ];
+	if ( action.isInsert ) applyInsert( doc, action.pos, action.text, SC_PERFORMED_REDO );
+	else applyDelete( doc, action.pos, int( action.text.length() ), SC_PERFORMED_REDO );
+
+	return ( true );
+}
+
+//  Style Configurator 'Save & Close'.
+void wordStylesUpdated() { notifyNpp( NPPN_WORDSTYLESUPDATED, 0 ); }
+
+//  Returns the length of the current document of view.
+int getLength( int view ) { return ( int( _views[view].doc()->text.length() ) ); }
+
+//  Returns the line count of the current document of view.
+int getLineCount( int view ) { return ( int( _views[view].doc()->lineStarts.size() ) ); }
+
+//  Returns the start position of a line in the current document of view.
+int positionFromLine( int view, int line ) { return ( positionFromLine( _views[view].doc(), line ) ); }
+
+//  Returns the document pointer of an open bufferID, NULL if the buffer isn't open.
+void* documentFromBufferID( int bufferID )
+{
+	int view, tab;
+	if (! findBuffer( bufferID, view, tab ) ) return ( NULL );
+	return ( _views[view].tabs[tab]->doc );
+}
+
+//  Clears all latency samples.
+void resetLatency() { _latencySamples.clear(); }
+
+//  Returns the latency summary for beNotified() calls with a notification code.
+LatencySummary getLatency( int notificationCode )
+{
+	LatencySummary summary;
+
+	std::map< int, std::vector<double> >::iterator it = _latencySamples.find( notificationCode );
+	if ( ( it == _latencySamples.end() ) || it->second.empty() ) return ( summary );
+
+	std::vector<double> samples( it->second );
+	std::sort( samples.begin(), samples.end() );
+
+	summary.count = int( samples.size() );
+	for ( size_t i = 0; i < samples.size(); i++ ) summary.totalMs += samples[i];
+	summary.p50Ms = samples[ size_t( 0.50 * ( samples.size() - 1 ) ) ];
+	summary.p99Ms = samples[ size_t( 0.99 * ( samples.size() - 1 ) ) ];
+	summary.maxMs = samples.back();
+
+	return ( summary );
+}
+
+//  Runs a scripted editing session, one command per line:
+//
+//    config <dir>                     plugins config dir (must come first, default %TEMP%\NppHostSim)
+//    open <view> <file>               open a file in a new tab
+//    new <view> <nbLines> [text]      open a generated document of nbLines lines
+//    tabs <view> <count> <nbLines>    open count generated documents
+//    activate <view> <tab>
+//    close <view> <tab>
+//    insert <view> <line> <text>      insert text at the start of line ( \n and \t escapes )
+//    type <view> <line> <count>       type count characters, one keystroke each, at line
+//    enter <view> <line> <count>      press enter count times at line
+//    delete <view> <line> <nbLines>   delete whole lines
+//    undo <view> [count]
+//    redo <view> [count]
+//    save <view>
+//    styles                           NPPN_WORDSTYLESUPDATED
+//    reset                            clear latency samples
+//    report <label>                   write the latency summary to the log
+//
+//  Lines starting with '#' are comments.
+int runScript( tstring scriptPath )
+{
+	std::ifstream script( scriptPath.c_str() );
+	tstring logPath( scriptPath );
+	logPath.append( TEXT(".log") );
+	std::ofstream log( logPath.c_str() );
+
+	int nbLines = 0;
+	std::string line;
+	while ( std::getline( script, line ) ) {
+		if ( (! line.empty() ) && ( line[ line.length() - 1 ] == '\r' ) ) line.erase( line.length() - 1 );
+		if ( line.empty() || ( line[0] == '#' ) ) continue;
+
+		std::istringstream args( line );
+		std::string cmd;
+		args >> cmd;
+
+		if ( cmd == "config" ) {
+			std::string dir;
+			std::getline( args >> std::ws, dir );
+			initHost( toTString( dir ) );
+			nbLines++;
+			continue;
+		}
+
+		initHost( tstring() );
+
+		int view = MAIN_VIEW;
+		if ( ( cmd != "styles" ) && ( cmd != "reset" ) && ( cmd != "report" ) ) args >> view;
+		if ( ( view < MAIN_VIEW ) || ( view > SUB_VIEW ) ) view = MAIN_VIEW;
+
+		if ( cmd == "open" ) {
+			std::string fileName;
+			std::getline( args >> std::ws, fileName );
+			std::ifstream file( fileName.c_str(), std::ios::binary );
+			std::string text( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+			openDocument( view, text );
+		}
+		else if ( cmd == "new" ) {
+			int lines = 1;
+			std::string lineText;
+			args >> lines;
+			std::getline( args >> std::ws, lineText );
+			if ( lineText.empty() ) lineText = "The quick brown fox jumps over the lazy dog.";
+			openDocument( view, generateText( lines, lineText ) );
+		}
+		else if ( cmd == "tabs" ) {
+			int count = 0;
+			int lines = 1;
+			args >> count >> lines;
+			std::string text = generateText( lines, "The quick brown fox jumps over the lazy dog." );
+			for ( int i = 0; i < count; i++ ) openDocument( view, text );
+		}
+		else if ( cmd == "activate" ) {
+			int tab = 0;
+			args >> tab;
+			activateDocument( view, tab );
+		}
+		else if ( cmd == "close" ) {
+			int tab = 0;
+			args >> tab;
+			closeDocument( view, tab );
+		}
+		else if ( cmd == "insert" ) {
+			int targetLine = 0;
+			std::string text;
+			args >> targetLine;
+			std::getline( args >> std::ws, text );
+			insertText( view, max( positionFromLine( view, targetLine ), 0 ), unescape( text ) );
+		}
+		else if ( cmd == "type" || cmd == "enter" ) {
+			int targetLine = 0;
+			int count = 0;
+			args >> targetLine >> count;
+			int pos = max( positionFromLine( view, targetLine ), 0 );
+			for ( int i = 0; i < count; i++ ) {
+				insertText( view, pos, ( cmd == "type" ) ? ( "x" ) : ( "\n" ) );
+				pos++;
+			}
+		}
+		else if ( cmd == "delete" ) {
+			int targetLine = 0;
+			int lines = 1;
+			args >> targetLine >> lines;
+			int startPos = positionFromLine( view, targetLine );
+			int endPos = positionFromLine( view, targetLine + lines );
+			if ( endPos < 0 ) endPos = getLength( view );
+			if ( startPos >= 0 ) deleteText( view, startPos, endPos - startPos );
+		}
+		else if ( cmd == "undo" || cmd == "redo" ) {
+			int count = 1;
+			args >> count;
+			for ( int i = 0; i < count; i++ ) {
+				if (! ( ( cmd == "undo" ) ? ( undo( view ) ) : ( redo( view ) ) ) ) break;
+			}
+		}
+		else if ( cmd == "save" ) {
+			saveDocument( view );
+		}
+		else if ( cmd == "styles" ) {
+			wordStylesUpdated();
+		}
+		else if ( cmd == "reset" ) {
+			resetLatency();
+		}
+		else if ( cmd == "report" ) {
+			std::string label;
+			std::getline( args >> std::ws, label );
+			writeLatencyReport( log, label );
+		}
+		else {
+			log << "Unknown command: " << line << "\n";
+		}
+
+		nbLines++;
+	}
+
+	return ( nbLines );
+}
+
+}  // End namespace: host_sim
+
+}  // End namespace: npp_plugin
+
+
+//  rundll32 entry point:  rundll32 <plugin>.dll,HostSimRun <script path>
+extern "C" __declspec(dllexport) void CALLBACK HostSimRun( HWND /*hwnd*/, HINSTANCE /*hinst*/,
+		LPSTR lpszCmdLine, int /*nCmdShow*/ )
+{
+	using namespace npp_plugin::host_sim;
+
+	std::string scriptPath( lpszCmdLine );
+	scriptPath.erase( std::remove( scriptPath.begin(), scriptPath.end(), '\"' ), scriptPath.end() );
+
+	runScript( toTString( scriptPath ) );
+	shutdownHost();
+}
+
+//  Every ::SendMessage in the lib and plugin sources ends up here when the host is enabled.
+LRESULT HostSim_SendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+	using namespace npp_plugin::host_sim;
+
+	if ( hWnd == hostWnd( HOST_NPP ) ) return ( nppMessage( Msg, wParam, lParam ) );
+
+	SimView* view = viewFromHandle( hWnd );
+	if ( view ) return ( sciMessage( view, Msg, wParam, lParam ) );
+
+	return ( 0 );
+}
+
+#endif  // End: NPP_PLUGININTERFACE_HOSTSIM
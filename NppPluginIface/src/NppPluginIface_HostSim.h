@@ -0,0 +1,93 @@
+/* NppPluginIface_HostSim.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing a stand-in Notepad++/Scintilla host.
+ *
+ *  When NPP_PLUGININTERFACE_HOSTSIM is defined the messaging facade answers every ::SendMessage
+ *  made by the lib and by the plugin sources from an in-memory host instead of a real window.
+ *  The host keeps two views, tabs, documents with undo/redo, styles, line states, fold levels,
+ *  markers, and indicators, and it drives the plugin's beNotified() the same way Notepad++ would.
+ *
+ *  A scripted session can be run without a Notepad++ GUI session using:
+ *
+ *    rundll32 NppPlugin_ChangeMarker.dll,HostSimRun C:\path\to\session.txt
+ *
+ *  Results are written next to the script as session.txt.log.  See runScript() for the
+ *  script commands.
+ *
+ *  The Scintilla WindowAccessor and PlatWin objects are linked pre-built and still talk to
+ *  real windows, so external lexer Lex/Fold calls are not driven through this host.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_HOSTSIM_EXTENSION_H
+#define NPP_PLUGININTERFACE_HOSTSIM_EXTENSION_H
+
+#include "NppPluginIface.h"
+
+//  The messaging facade forwards every ::SendMessage here when the host is enabled.
+LRESULT HostSim_SendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam );
+
+namespace npp_plugin {
+
+//  Namespace extension for the stand-in Notepad++ host.
+namespace host_sim {
+
+//  Latency summary of a set of timed beNotified() calls.
+struct LatencySummary {
+	int count;
+	double totalMs;
+	double p50Ms;
+	double p99Ms;
+	double maxMs;
+
+	LatencySummary():count(0), totalMs(0), p50Ms(0), p99Ms(0), maxMs(0){};
+};
+
+//  <--- Session Control --->
+void initHost( tstring configDir );			//  Fake setInfo, TBMODIFICATION and READY.
+void shutdownHost();						//  Close all documents and clear host state.
+
+//  <--- Scripted Editing --->
+int openDocument( int view, const std::string& text );		//  Returns the new bufferID.
+void activateDocument( int view, int tab );
+void closeDocument( int view, int tab );
+void saveDocument( int view );
+void insertText( int view, int pos, const std::string& text );
+void deleteText( int view, int pos, int length );
+bool undo( int view );
+bool redo( int view );
+void wordStylesUpdated();
+
+//  <--- Inspection --->
+int getLength( int view );
+int getLineCount( int view );
+int positionFromLine( int view, int line );
+void* documentFromBufferID( int bufferID );		//  Stand-in for Buffer::getDocument().
+
+//  <--- Measurement --->
+void resetLatency();
+LatencySummary getLatency( int notificationCode );
+int runScript( tstring scriptPath );		//  Returns the number of script lines run.
+
+}  // End namespace: host_sim
+
+}  // End namespace: npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_HOSTSIM_EXTENSION_H
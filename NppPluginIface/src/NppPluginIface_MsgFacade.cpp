@@ -0,0 +1,286 @@
+/* NppPluginIface_MsgFacade.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing the messaging facade's profiler.
+ *
+ *  Messages are only ever sent from Notepad++'s main thread ( lexing included ) so the
+ *  accounting isn't locked.  Time spent in a message includes any notifications Notepad++
+ *  sends back to the plugin before the message returns.
+ *
+ */
+
+#include "NppPluginIface.h"
+
+#ifdef NPP_PLUGININTERFACE_MSGPROFILE
+
+//  <--- STL --->
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+//  <--- Windows --->
+#include "Shlwapi.h"
+#pragma comment( lib, "Shlwapi.lib" )
+
+
+namespace npp_plugin {
+
+namespace msg_facade {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const size_t NB_TOP_OFFENDERS = 25;
+const int MIXED_MSGS = -1;
+
+//  Accumulated calls and time.
+struct MsgStats {
+	bool toNpp;				//  NPPM_ and SCI_ ids overlap, so the target is part of the id.
+	int msg;				//  MIXED_MSGS when a call site sends more than one message id.
+	unsigned long calls;
+	LONGLONG totalTicks;
+	LONGLONG maxTicks;
+
+	MsgStats():toNpp(false), msg(0), calls(0), totalTicks(0), maxTicks(0){};
+
+	void add( bool thisToNpp, int thisMsg, LONGLONG ticks )
+	{
+		if ( calls == 0 ) {
+			toNpp = thisToNpp;
+			msg = thisMsg;
+		}
+		else if ( ( msg != thisMsg ) || ( toNpp != thisToNpp ) ) msg = MIXED_MSGS;
+
+		calls++;
+		totalTicks += ticks;
+		if ( ticks > maxTicks ) maxTicks = ticks;
+	}
+};
+
+typedef std::pair< const char*, int > CallSite;		//  __FILE__ literals are unique per file.
+typedef std::pair< bool, UINT > MsgId;				//  Sent to Notepad++, message.
+typedef std::map< MsgId, MsgStats > MsgStatsMap;
+typedef std::map< CallSite, MsgStats > SiteStatsMap;
+
+MsgStatsMap _byMsg;
+SiteStatsMap _bySite;
+LONGLONG _perfFreq = 0;
+
+//  Orders stats by descending total time.
+template< typename PairT >
+bool byTotalTicks( const PairT* lhs, const PairT* rhs )
+{
+	return ( lhs->second.totalTicks > rhs->second.totalTicks );
+}
+
+//  Returns the symbolic name for the message ids used in this solution.
+std::string msgName( bool toNpp, int msg )
+{
+	if ( msg == MIXED_MSGS ) return ( "(various)" );
+
+	if ( toNpp ) {
+		switch ( msg )
+		{
+			case NPPM_GETCURRENTSCINTILLA: return ( "NPPM_GETCURRENTSCINTILLA" );
+			case NPPM_GETNBOPENFILES: return ( "NPPM_GETNBOPENFILES" );
+			case NPPM_GETBUFFERIDFROMPOS: return ( "NPPM_GETBUFFERIDFROMPOS" );
+			case NPPM_GETCURRENTDOCINDEX: return ( "NPPM_GETCURRENTDOCINDEX" );
+			case NPPM_ACTIVATEDOC: return ( "NPPM_ACTIVATEDOC" );
+			case NPPM_DOOPEN: return ( "NPPM_DOOPEN" );
+			case NPPM_MSGTOPLUGIN: return ( "NPPM_MSGTOPLUGIN" );
+			case NPPM_GETMENUHANDLE: return ( "NPPM_GETMENUHANDLE" );
+			case NPPM_SETMENUITEMCHECK: return ( "NPPM_SETMENUITEMCHECK" );
+			case NPPM_MENUCOMMAND: return ( "NPPM_MENUCOMMAND" );
+			case NPPM_GETPLUGINSCONFIGDIR: return ( "NPPM_GETPLUGINSCONFIGDIR" );
+			case NPPM_GETNPPDIRECTORY: return ( "NPPM_GETNPPDIRECTORY" );
+			default:
+			{
+				std::ostringstream name;
+				name << "npp msg " << msg;
+				return ( name.str() );
+			}
+		}
+	}
+
+	switch ( msg )
+	{
+		case SCI_GETDOCPOINTER: return ( "SCI_GETDOCPOINTER" );
+		case SCI_GETLEXER: return ( "SCI_GETLEXER" );
+		case SCI_GETLINECOUNT: return ( "SCI_GETLINECOUNT" );
+		case SCI_GETCURRENTPOS: return ( "SCI_GETCURRENTPOS" );
+		case SCI_LINEFROMPOSITION: return ( "SCI_LINEFROMPOSITION" );
+		case SCI_GOTOLINE: return ( "SCI_GOTOLINE" );
+		case SCI_ENSUREVISIBLEENFORCEPOLICY: return ( "SCI_ENSUREVISIBLEENFORCEPOLICY" );
+		case SCI_BRACEMATCH: return ( "SCI_BRACEMATCH" );
+		case SCI_STARTSTYLING: return ( "SCI_STARTSTYLING" );
+		case SCI_STYLEGETBACK: return ( "SCI_STYLEGETBACK" );
+		case SCI_STYLEGETBOLD: return ( "SCI_STYLEGETBOLD" );
+		case SCI_STYLEGETITALIC: return ( "SCI_STYLEGETITALIC" );
+		case SCI_STYLEGETUNDERLINE: return ( "SCI_STYLEGETUNDERLINE" );
+		case SCI_INDICSETSTYLE: return ( "SCI_INDICSETSTYLE" );
+		case SCI_INDICSETFORE: return ( "SCI_INDICSETFORE" );
+		case SCI_INDICGETFORE: return ( "SCI_INDICGETFORE" );
+		case SCI_INDICSETUNDER: return ( "SCI_INDICSETUNDER" );
+		case SCI_INDICGETUNDER: return ( "SCI_INDICGETUNDER" );
+		case SCI_INDICSETALPHA: return ( "SCI_INDICSETALPHA" );
+		case SCI_SETMARGINTYPEN: return ( "SCI_SETMARGINTYPEN" );
+		case SCI_SETMARGINWIDTHN: return ( "SCI_SETMARGINWIDTHN" );
+		case SCI_GETMARGINWIDTHN: return ( "SCI_GETMARGINWIDTHN" );
+		case SCI_SETMARGINMASKN: return ( "SCI_SETMARGINMASKN" );
+		case SCI_GETMARGINMASKN: return ( "SCI_GETMARGINMASKN" );
+		case SCI_MARKERDEFINE: return ( "SCI_MARKERDEFINE" );
+		case SCI_MARKERDEFINEPIXMAP: return ( "SCI_MARKERDEFINEPIXMAP" );
+		case SCI_MARKERSETFORE: return ( "SCI_MARKERSETFORE" );
+		case SCI_MARKERSETBACK: return ( "SCI_MARKERSETBACK" );
+		case SCI_MARKERSETALPHA: return ( "SCI_MARKERSETALPHA" );
+		case SCI_MARKERADD: return ( "SCI_MARKERADD" );
+		case SCI_MARKERGET: return ( "SCI_MARKERGET" );
+		case SCI_MARKERDELETEHANDLE: return ( "SCI_MARKERDELETEHANDLE" );
+		case SCI_MARKERLINEFROMHANDLE: return ( "SCI_MARKERLINEFROMHANDLE" );
+		case SCI_MARKERDELETEALL: return ( "SCI_MARKERDELETEALL" );
+
+		default:
+		{
+			std::ostringstream name;
+			name << "sci msg " << msg;
+			return ( name.str() );
+		}
+	}
+}
+
+//  Writes one stats line.
+void writeStats( std::ostream& out, const std::string& label, const MsgStats& stats )
+{
+	double msPerTick = 1000.0 / double( _perfFreq );
+	out << "  " << label
+		<< "  calls=" << stats.calls
+		<< "  total_ms=" << ( stats.totalTicks * msPerTick )
+		<< "  avg_us=" << ( ( stats.totalTicks * msPerTick * 1000.0 ) / stats.calls )
+		<< "  max_us=" << ( stats.maxTicks * msPerTick * 1000.0 ) << "\n";
+}
+
+//  Writes the top offenders of a stats map by total time.
+template< typename MapT, typename LabelF >
+void writeTopOffenders( std::ostream& out, const MapT& statsMap, LabelF label )
+{
+	typedef typename MapT::value_type PairT;
+
+	std::vector< const PairT* > ordered;
+	for ( typename MapT::const_iterator it = statsMap.begin(); it != statsMap.end(); ++it ) {
+		ordered.push_back( &(*it) );
+	}
+	std::sort( ordered.begin(), ordered.end(), byTotalTicks< PairT > );
+
+	size_t nbShown = std::min( NB_TOP_OFFENDERS, ordered.size() );
+	for ( size_t i = 0; i < nbShown; i++ ) {
+		writeStats( out, label( *ordered[i] ), ordered[i]->second );
+	}
+}
+
+std::string msgLabel( const MsgStatsMap::value_type& entry )
+{
+	return ( msgName( entry.first.first, entry.first.second ) );
+}
+
+std::string siteLabel( const SiteStatsMap::value_type& entry )
+{
+	std::ostringstream label;
+	const char* file = entry.first.first;
+	const char* lastSep = std::max( ::strrchr( file, '\\' ), ::strrchr( file, '/' ) );
+	label << ( lastSep ? lastSep + 1 : file ) << "(" << entry.first.second << ") "
+		<< msgName( entry.second.toNpp, entry.second.msg );
+	return ( label.str() );
+}
+
+}  // End: Un-named namespace
+
+
+//  Times and counts one message by id and by call site.
+LRESULT profiledSendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam,
+		const char* file, int line )
+{
+	LARGE_INTEGER start, end;
+	::QueryPerformanceCounter( &start );
+	LRESULT result = hostSendMessage( hWnd, Msg, wParam, lParam );
+	::QueryPerformanceCounter( &end );
+
+	LONGLONG ticks = end.QuadPart - start.QuadPart;
+	bool toNpp = ( hWnd == hNpp() );
+	_byMsg[ MsgId( toNpp, Msg ) ].add( toNpp, int( Msg ), ticks );
+	_bySite[ CallSite( file, line ) ].add( toNpp, int( Msg ), ticks );
+
+	return ( result );
+}
+
+//  Menu command:  Writes the messages and call sites costing the most total time.
+void dumpProfile()
+{
+	if (! _perfFreq ) {
+		LARGE_INTEGER perfFreq;
+		::QueryPerformanceFrequency( &perfFreq );
+		_perfFreq = perfFreq.QuadPart;
+	}
+
+	TCHAR path[MAX_PATH];
+	path[0] = '\0';
+	hostSendMessage( hNpp(), NPPM_GETPLUGINSCONFIGDIR, MAX_PATH, (LPARAM)path );
+	PathAppend( path, getModuleBaseName()->c_str() );
+	PathAddExtension( path, TEXT(".msgprofile.txt") );
+
+	std::ofstream out( path );
+	if (! out.is_open() ) return;
+
+	unsigned long totalCalls = 0;
+	LONGLONG totalTicks = 0;
+	for ( MsgStatsMap::iterator it = _byMsg.begin(); it != _byMsg.end(); ++it ) {
+		totalCalls += it->second.calls;
+		totalTicks += it->second.totalTicks;
+	}
+	out << "messages=" << totalCalls
+		<< "  total_ms=" << ( ( totalTicks * 1000.0 ) / double( _perfFreq ) )
+		<< "  message_ids=" << _byMsg.size()
+		<< "  call_sites=" << _bySite.size() << "\n\n";
+
+	out << "Top message ids by total time:\n";
+	writeTopOffenders( out, _byMsg, msgLabel );
+
+	out << "\nTop call sites by total time:\n";
+	writeTopOffenders( out, _bySite, siteLabel );
+
+	out.close();
+
+	tstring msg( TEXT("Message profile was written to:\r\n\r\n") );
+	msg.append( path );
+	::MessageBox( hNpp(), msg.c_str(), TEXT("Plugin Message Profile"), MB_OK | MB_ICONINFORMATION );
+}
+
+//  Drops all accumulated counts.
+void resetProfile()
+{
+	_byMsg.clear();
+	_bySite.clear();
+}
+
+}  // End namespace: msg_facade
+
+}  // End namespace: npp_plugin
+
+#endif  // End: NPP_PLUGININTERFACE_MSGPROFILE
@@ -0,0 +1,86 @@
+/* NppPluginIface_MsgFacade.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing the single route that every message
+ *  from the lib and the plugin sources takes to Notepad++ and Scintilla.
+ *
+ *  ::SendMessage( hWnd, Msg, wParam, lParam ) is redefined here to msg_facade::sendMessage(),
+ *  which forwards to the stand-in host, the notification tracer, or the real window.
+ *
+ *  With NPP_PLUGININTERFACE_MSGPROFILE defined every message is also counted and timed by
+ *  message id and by call site ( file and line ).  Register msg_facade::dumpProfile as a menu
+ *  item to write the top offenders to <plugins config dir>\<module base name>.msgprofile.txt.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_MSGFACADE_EXTENSION_H
+#define NPP_PLUGININTERFACE_MSGFACADE_EXTENSION_H
+
+#include "NppPluginIface.h"
+
+namespace npp_plugin {
+
+//  Namespace extension for the messaging facade.
+namespace msg_facade {
+
+//  Sends a message straight to whichever host this build talks to.
+inline LRESULT hostSendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+#if defined( NPP_PLUGININTERFACE_HOSTSIM )
+	return ( HostSim_SendMessage( hWnd, Msg, wParam, lParam ) );
+#elif defined( NPP_PLUGININTERFACE_NOTIFYTRACE )
+	return ( NotifyTrace_SendMessage( hWnd, Msg, wParam, lParam ) );
+#elif defined( UNICODE )
+	return ( ::SendMessageW( hWnd, Msg, wParam, lParam ) );
+#else
+	return ( ::SendMessageA( hWnd, Msg, wParam, lParam ) );
+#endif
+}
+
+#ifdef NPP_PLUGININTERFACE_MSGPROFILE
+
+LRESULT profiledSendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam,
+		const char* file, int line );
+void dumpProfile();								//  Menu command to write the report.
+void resetProfile();
+
+#endif  // End: NPP_PLUGININTERFACE_MSGPROFILE
+
+//  Every ::SendMessage in the lib and plugin sources.
+inline LRESULT sendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam,
+		const char* file, int line )
+{
+#ifdef NPP_PLUGININTERFACE_MSGPROFILE
+	return ( profiledSendMessage( hWnd, Msg, wParam, lParam, file, line ) );
+#else
+	return ( hostSendMessage( hWnd, Msg, wParam, lParam ) );
+#endif
+}
+
+}  // End namespace: msg_facade
+
+}  // End namespace: npp_plugin
+
+#ifdef SendMessage
+	#undef SendMessage
+#endif
+#define SendMessage( hWnd, Msg, wParam, lParam ) \
+	npp_plugin::msg_facade::sendMessage( hWnd, Msg, wParam, lParam, __FILE__, __LINE__ )
+
+#endif  // End include guard: NPP_PLUGININTERFACE_MSGFACADE_EXTENSION_H
@@ -0,0 +1,586 @@
+/* NppPluginIface_NotifyTrace.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing record and replay of the notifications
+ *  a plugin receives, along with the replies to every message the plugin sends.
+ *
+ *  The trace is a 'NPTR' header and version byte followed by records, with every integer
+ *  stored as a zig-zag varint so the common small values take a single byte:
+ *
+ *    'N'  code, idFrom, window, modificationType, position, length, linesAdded, pDoc
+ *    'R'  window, msg, wParam, lParam, result, payload size, payload bytes
+ *
+ *  window is 0 for Notepad++, 1 for the main view, 2 for the second view, and 3 for any
+ *  other window ( N++'s hidden view ).  The payload holds what the host wrote through lParam
+ *  for the few messages used here that return data that way.
+ *
+ *  During replay replies are handed back in recorded order for as long as the message ids
+ *  match; a message that doesn't match returns 0 and is counted as a divergence.
+ *
+ */
+
+#include "NppPluginIface.h"
+
+#ifdef NPP_PLUGININTERFACE_NOTIFYTRACE
+
+#include "NppPluginIface_NotifyTrace.h"
+#include "NppPluginIface_DocTabMap.h"
+#include "NppPluginIface_ActionIndex.h"
+#include "NppPluginIface_msgs.h"
+
+//  <--- STL --->
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <sstream>
+
+//  <--- Windows --->
+#include "Shlwapi.h"
+#pragma comment( lib, "Shlwapi.lib" )
+
+
+namespace npp_plugin {
+
+namespace notify_trace {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const char TRACE_MAGIC[] = "NPTR";
+const unsigned char TRACE_VERSION = 1;
+const char REC_NOTIFICATION = 'N';
+const char REC_REPLY = 'R';
+const size_t FLUSH_SIZE = ( 64 * 1024 );
+
+const int TRACE_NPP = 0;
+const int TRACE_OTHERWINDOW = 3;
+const int NB_TRACEWINDOWS = 4;
+
+//  One decoded trace record.
+struct TraceRecord {
+	char type;
+	int window;
+	int code;			//  Notification code or message id.
+	int idFrom;
+	int modificationType;
+	int position;
+	int length;
+	int linesAdded;
+	int pDoc;
+	int wParam;
+	int lParam;
+	int result;
+	std::string payload;
+
+	TraceRecord():type(0), window(0), code(0), idFrom(0), modificationType(0), position(0),
+		length(0), linesAdded(0), pDoc(0), wParam(0), lParam(0), result(0){};
+};
+
+//  A timed notification during replay.
+struct ReplaySample {
+	int sequence;
+	double elapsedMs;
+	const TraceRecord* record;
+
+	ReplaySample( int sequence, double elapsedMs, const TraceRecord* record )
+		:sequence(sequence), elapsedMs(elapsedMs), record(record){};
+
+	bool operator>( const ReplaySample& rhs ) const { return ( elapsedMs > rhs.elapsedMs ); }
+};
+
+//  <--- Recording State --->
+bool _recording = false;
+std::ofstream _traceFile;
+std::string _buffer;
+
+//  <--- Replay State --->
+bool _replaying = false;
+std::vector<TraceRecord> _records;
+size_t _cursor = 0;
+int _divergences = 0;
+int _skippedReplies = 0;
+
+//  Replay window handles are the addresses of these.
+int _replayWindows[NB_TRACEWINDOWS];
+
+HWND replayWnd( int window ) { return ( reinterpret_cast<HWND>( &_replayWindows[window] ) ); }
+
+//  The real SendMessage, for use when a message must not be traced.
+LRESULT realSendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+#ifdef UNICODE
+	return ( ::SendMessageW( hWnd, Msg, wParam, lParam ) );
+#else
+	return ( ::SendMessageA( hWnd, Msg, wParam, lParam ) );
+#endif
+}
+
+//  Returns the trace window number for a handle.
+int windowIndex( HWND hWnd )
+{
+	if ( hWnd == hNpp() ) return ( TRACE_NPP );
+	if ( hWnd == hMainView() ) return ( 1 + MAIN_VIEW );
+	if ( hWnd == hSecondView() ) return ( 1 + SUB_VIEW );
+	return ( TRACE_OTHERWINDOW );
+}
+
+//  <--- Encoding --->
+void putVarint( int value )
+{
+	unsigned int zz = ( (unsigned int)value << 1 ) ^ (unsigned int)( value >> 31 );
+	while ( zz >= 0x80 ) {
+		_buffer += char( ( zz & 0x7F ) | 0x80 );
+		zz >>= 7;
+	}
+	_buffer += char( zz );
+}
+
+bool getVarint( const std::string& data, size_t& pos, int& value )
+{
+	unsigned int zz = 0;
+	int shift = 0;
+	while ( pos < data.size() ) {
+		unsigned char byte = data[pos++];
+		zz |= (unsigned int)( byte & 0x7F ) << shift;
+		if (! ( byte & 0x80 ) ) {
+			value = int( zz >> 1 ) ^ -int( zz & 1 );
+			return ( true );
+		}
+		shift += 7;
+	}
+	return ( false );
+}
+
+//  Writes the buffered records out once enough have collected.
+void flushBuffer( bool force )
+{
+	if ( _buffer.empty() || (! ( force || ( _buffer.size() >= FLUSH_SIZE ) ) ) ) return;
+
+	_traceFile.write( _buffer.data(), std::streamsize( _buffer.size() ) );
+	_buffer.clear();
+	if ( force ) _traceFile.flush();
+}
+
+//  Returns how many bytes the host writes through lParam for a message, or 0.
+size_t payloadSize( UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+	if (! lParam ) return ( 0 );
+
+	switch ( Msg )
+	{
+		case NPPM_GETCURRENTSCINTILLA:
+			return ( sizeof( int ) );
+
+		case NPPM_GETPLUGINSCONFIGDIR:
+		case NPPM_GETNPPDIRECTORY:
+		{
+			const TCHAR* path = reinterpret_cast<const TCHAR*>( lParam );
+			size_t nbChars = 0;
+			while ( ( nbChars < size_t( wParam ) ) && path[nbChars] ) nbChars++;
+			return ( ( nbChars < size_t( wParam ) ? nbChars + 1 : nbChars ) * sizeof( TCHAR ) );
+		}
+
+		case NPPM_MSGTOPLUGIN:
+		{
+			CommunicationInfo* comm = reinterpret_cast<CommunicationInfo*>( lParam );
+			if ( ( comm->internalMsg == messages::NPPP_MSG_MARKERSYMBOL ) && comm->info )
+				return ( sizeof( messages::info_MARKERSYMBOL ) );
+			return ( 0 );
+		}
+
+		default:
+			return ( 0 );
+	}
+}
+
+//  Returns where payload bytes for a message are written.
+void* payloadTarget( UINT Msg, LPARAM lParam )
+{
+	if ( Msg == NPPM_MSGTOPLUGIN ) return ( reinterpret_cast<CommunicationInfo*>( lParam )->info );
+	return ( reinterpret_cast<void*>( lParam ) );
+}
+
+//  Appends a reply record.
+void recordReply( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam, LRESULT result )
+{
+	_buffer += REC_REPLY;
+	putVarint( windowIndex( hWnd ) );
+	putVarint( int( Msg ) );
+	putVarint( int( wParam ) );
+	putVarint( int( lParam ) );
+	putVarint( int( result ) );
+
+	size_t size = payloadSize( Msg, wParam, lParam );
+	putVarint( int( size ) );
+	if ( size ) _buffer.append( reinterpret_cast<const char*>( payloadTarget( Msg, lParam ) ), size );
+
+	flushBuffer( false );
+}
+
+//  Hands back the next recorded reply when it is for the same message.
+LRESULT replayReply( UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+	if ( ( _cursor >= _records.size() ) || ( _records[_cursor].type != REC_REPLY ) ||
+			( _records[_cursor].code != int( Msg ) ) ) {
+		_divergences++;
+		return ( 0 );
+	}
+
+	const TraceRecord& rec = _records[_cursor++];
+	if ( (! rec.payload.empty() ) && lParam ) {
+		//  The path buffers are still empty here, so their capacity is the limit.
+		size_t size = ( ( Msg == NPPM_GETPLUGINSCONFIGDIR ) || ( Msg == NPPM_GETNPPDIRECTORY ) )
+			? ( size_t( wParam ) * sizeof( TCHAR ) ) : ( payloadSize( Msg, wParam, lParam ) );
+		if ( size > rec.payload.size() ) size = rec.payload.size();
+		::memcpy( payloadTarget( Msg, lParam ), rec.payload.data(), size );
+	}
+	return ( rec.result );
+}
+
+//  Reads and decodes a whole trace file.
+bool loadTrace( tstring tracePath )
+{
+	_records.clear();
+
+	std::ifstream in( tracePath.c_str(), std::ios::in | std::ios::binary );
+	if (! in.is_open() ) return ( false );
+
+	std::ostringstream contents;
+	contents << in.rdbuf();
+	std::string data( contents.str() );
+
+	if ( ( data.size() < 5 ) || ( data.compare( 0, 4, TRACE_MAGIC ) != 0 ) ||
+			( (unsigned char)data[4] != TRACE_VERSION ) ) return ( false );
+
+	size_t pos = 5;
+	while ( pos < data.size() ) {
+		TraceRecord rec;
+		rec.type = data[pos++];
+
+		bool ok = true;
+		if ( rec.type == REC_NOTIFICATION ) {
+			ok = getVarint( data, pos, rec.code ) && getVarint( data, pos, rec.idFrom ) &&
+				getVarint( data, pos, rec.window ) && getVarint( data, pos, rec.modificationType ) &&
+				getVarint( data, pos, rec.position ) && getVarint( data, pos, rec.length ) &&
+				getVarint( data, pos, rec.linesAdded ) && getVarint( data, pos, rec.pDoc );
+		}
+		else if ( rec.type == REC_REPLY ) {
+			int size = 0;
+			ok = getVarint( data, pos, rec.window ) && getVarint( data, pos, rec.code ) &&
+				getVarint( data, pos, rec.wParam ) && getVarint( data, pos, rec.lParam ) &&
+				getVarint( data, pos, rec.result ) && getVarint( data, pos, size ) &&
+				( size >= 0 ) && ( pos + size <= data.size() );
+			if ( ok ) {
+				rec.payload.assign( data, pos, size );
+				pos += size;
+			}
+		}
+		else ok = false;
+
+		if (! ok ) break;	//  A truncated tail from a crashed session is expected.
+		_records.push_back( rec );
+	}
+
+	return ( true );
+}
+
+//  Returns the report label for a notification, splitting SCN_MODIFIED by what it reports.
+std::string notificationLabel( const TraceRecord& rec )
+{
+	std::ostringstream label;
+	switch ( rec.code )
+	{
+		case SCN_MODIFIED:
+			label << "SCN_MODIFIED";
+			if ( rec.modificationType & SC_MOD_INSERTTEXT ) label << " insert";
+			else if ( rec.modificationType & SC_MOD_DELETETEXT ) label << " delete";
+			else if ( rec.modificationType & SC_MOD_BEFOREINSERT ) label << " beforeinsert";
+			else if ( rec.modificationType & SC_MOD_BEFOREDELETE ) label << " beforedelete";
+			else label << " other";
+			if ( rec.modificationType & SC_PERFORMED_UNDO ) label << " undo";
+			else if ( rec.modificationType & SC_PERFORMED_REDO ) label << " redo";
+			break;
+		case NPPN_READY: label << "NPPN_READY"; break;
+		case NPPN_TBMODIFICATION: label << "NPPN_TBMODIFICATION"; break;
+		case NPPN_FILEOPENED: label << "NPPN_FILEOPENED"; break;
+		case NPPN_FILEBEFORECLOSE: label << "NPPN_FILEBEFORECLOSE"; break;
+		case NPPN_FILECLOSED: label << "NPPN_FILECLOSED"; break;
+		case NPPN_FILEBEFORESAVE: label << "NPPN_FILEBEFORESAVE"; break;
+		case NPPN_FILESAVED: label << "NPPN_FILESAVED"; break;
+		case NPPN_BUFFERACTIVATED: label << "NPPN_BUFFERACTIVATED"; break;
+		case NPPN_WORDSTYLESUPDATED: label << "NPPN_WORDSTYLESUPDATED"; break;
+		case NPPN_SHUTDOWN: label << "NPPN_SHUTDOWN"; break;
+		default: label << "code " << rec.code; break;
+	}
+	return ( label.str() );
+}
+
+//  Returns the sample at percentile p of a sorted vector.
+double percentile( const std::vector<double>& sorted, double p )
+{
+	return ( sorted[ size_t( p * ( sorted.size() - 1 ) ) ] );
+}
+
+//  Writes latency percentiles by notification and the slowest notifications.
+void writeReplayReport( tstring reportPath, std::vector<ReplaySample>& samples )
+{
+	std::ofstream out( reportPath.c_str() );
+	if (! out.is_open() ) return;
+
+	std::map< std::string, std::vector<double> > byLabel;
+	for ( size_t i = 0; i < samples.size(); i++ ) {
+		byLabel[ notificationLabel( *samples[i].record ) ].push_back( samples[i].elapsedMs );
+	}
+
+	out << "notifications=" << samples.size()
+		<< "  divergences=" << _divergences
+		<< "  skipped_replies=" << _skippedReplies << "\n\n";
+
+	for ( std::map< std::string, std::vector<double> >::iterator it = byLabel.begin();
+			it != byLabel.end(); ++it ) {
+		std::vector<double>& sorted = it->second;
+		std::sort( sorted.begin(), sorted.end() );
+
+		double total = 0;
+		for ( size_t i = 0; i < sorted.size(); i++ ) total += sorted[i];
+
+		out << it->first
+			<< "  count=" << sorted.size()
+			<< "  total_ms=" << total
+			<< "  p50_ms=" << percentile( sorted, 0.50 )
+			<< "  p90_ms=" << percentile( sorted, 0.90 )
+			<< "  p99_ms=" << percentile( sorted, 0.99 )
+			<< "  p999_ms=" << percentile( sorted, 0.999 )
+			<< "  max_ms=" << sorted.back() << "\n";
+	}
+
+	//  The outliers are what matter when chasing a stall, so list them with their details.
+	const size_t NB_SLOWEST = 20;
+	size_t nbSlowest = std::min( NB_SLOWEST, samples.size() );
+	std::partial_sort( samples.begin(), samples.begin() + nbSlowest, samples.end(),
+		std::greater<ReplaySample>() );
+
+	out << "\nslowest:\n";
+	for ( size_t i = 0; i < nbSlowest; i++ ) {
+		const TraceRecord& rec = *samples[i].record;
+		out << "  #" << samples[i].sequence
+			<< "  " << notificationLabel( rec )
+			<< "  ms=" << samples[i].elapsedMs
+			<< "  pos=" << rec.position
+			<< "  len=" << rec.length
+			<< "  linesAdded=" << rec.linesAdded
+			<< "  window=" << rec.window
+			<< "  doc=" << rec.pDoc << "\n";
+	}
+}
+
+}  // End: Un-named namespace
+
+
+//  Starts recording to tracePath, or to <plugins config dir>\<module base name>.nptrace.
+//  Called from setInfo() so the replies to the plugin's start up messages are in the trace.
+bool startRecording( tstring tracePath )
+{
+	if ( _recording || _replaying ) return ( false );
+
+	if ( tracePath.empty() ) {
+		TCHAR configDir[MAX_PATH];
+		configDir[0] = '\0';
+		realSendMessage( hNpp(), NPPM_GETPLUGINSCONFIGDIR, MAX_PATH, (LPARAM)configDir );
+		PathAppend( configDir, getModuleBaseName()->c_str() );
+		PathAddExtension( configDir, TEXT(".nptrace") );
+		tracePath.assign( configDir );
+	}
+
+	_traceFile.open( tracePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if (! _traceFile.is_open() ) return ( false );
+
+	_buffer.assign( TRACE_MAGIC, 4 );
+	_buffer += char( TRACE_VERSION );
+	_recording = true;
+
+	return ( true );
+}
+
+//  Appends a notification record.  NPPN_SHUTDOWN ends the recording.
+void recordNotification( SCNotification* scn )
+{
+	if (! _recording ) return;
+
+	int window = windowIndex( scn->nmhdr.hwndFrom );
+	int pDoc = 0;
+	if ( ( scn->nmhdr.code == SCN_MODIFIED ) && ( window != TRACE_NPP ) ) {
+		pDoc = int( realSendMessage( scn->nmhdr.hwndFrom, SCI_GETDOCPOINTER, 0, 0 ) );
+	}
+
+	_buffer += REC_NOTIFICATION;
+	putVarint( int( scn->nmhdr.code ) );
+	putVarint( int( scn->nmhdr.idFrom ) );
+	putVarint( window );
+	putVarint( scn->modificationType );
+	putVarint( scn->position );
+	putVarint( scn->length );
+	putVarint( scn->linesAdded );
+	putVarint( pDoc );
+
+	if ( scn->nmhdr.code == NPPN_SHUTDOWN ) stopRecording();
+	else flushBuffer( false );
+}
+
+//  Flushes and closes the trace.
+void stopRecording()
+{
+	if (! _recording ) return;
+
+	_recording = false;
+	flushBuffer( true );
+	_traceFile.close();
+}
+
+bool isRecording() { return ( _recording ); }
+
+//  Replay handler driving only the DocTabMap and ActionIndex extensions.
+void actionIndexHandler( SCNotification* scn )
+{
+	switch ( scn->nmhdr.code )
+	{
+		case SCN_MODIFIED:
+			if ( isNppReady() ) actionindex::processSCNotification( scn );
+			break;
+
+		case NPPN_READY:
+			setNppReady();
+			hCurrViewNeedsUpdate();
+			doctabmap::update_DocTabMap();
+			break;
+
+		case NPPN_BUFFERACTIVATED:
+			if ( isNppReady() ) {
+				hCurrViewNeedsUpdate();
+				doctabmap::update_DocTabMap();
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+//  Replays a trace through handler, or beNotified(), the same way Notepad++ started the
+//  recorded session and writes latency percentiles to <trace>.replay.txt.
+int replayTrace( tstring tracePath, NotificationHandler handler )
+{
+	if ( _recording || _replaying ) return ( 0 );
+	if (! loadTrace( tracePath ) ) return ( 0 );
+	if (! handler ) handler = beNotified;
+
+	_replaying = true;
+	_cursor = 0;
+	_divergences = 0;
+	_skippedReplies = 0;
+
+	LARGE_INTEGER perfFreq;
+	::QueryPerformanceFrequency( &perfFreq );
+
+	NppData nppData;
+	nppData._nppHandle = replayWnd( TRACE_NPP );
+	nppData._scintillaMainHandle = replayWnd( 1 + MAIN_VIEW );
+	nppData._scintillaSecondHandle = replayWnd( 1 + SUB_VIEW );
+	setInfo( nppData );
+
+	int nbFuncItems;
+	getFuncsArray( &nbFuncItems );
+
+	std::vector<ReplaySample> samples;
+	while ( _cursor < _records.size() ) {
+		const TraceRecord& rec = _records[_cursor++];
+		if ( rec.type == REC_REPLY ) {
+			_skippedReplies++;		//  The replayed handler didn't ask for this one.
+			continue;
+		}
+
+		SCNotification scn;
+		::memset( &scn, 0, sizeof( scn ) );
+		scn.nmhdr.hwndFrom = replayWnd( rec.window );
+		scn.nmhdr.idFrom = rec.idFrom;
+		scn.nmhdr.code = rec.code;
+		scn.modificationType = rec.modificationType;
+		scn.position = rec.position;
+		scn.length = rec.length;
+		scn.linesAdded = rec.linesAdded;
+
+		LARGE_INTEGER start, end;
+		::QueryPerformanceCounter( &start );
+		handler( &scn );
+		::QueryPerformanceCounter( &end );
+
+		double elapsedMs = ( double( end.QuadPart - start.QuadPart ) * 1000.0 ) / double( perfFreq.QuadPart );
+		samples.push_back( ReplaySample( int( samples.size() ), elapsedMs, &rec ) );
+	}
+
+	writeReplayReport( tracePath + TEXT(".replay.txt"), samples );
+
+	_replaying = false;
+	return ( int( samples.size() ) );
+}
+
+}  // End namespace: notify_trace
+
+}  // End namespace: npp_plugin
+
+
+//  rundll32 entry point:  rundll32 <plugin>.dll,NotifyTraceReplay [actionindex] <trace path>
+extern "C" __declspec(dllexport) void CALLBACK NotifyTraceReplay( HWND /*hwnd*/, HINSTANCE /*hinst*/,
+		LPSTR lpszCmdLine, int /*nCmdShow*/ )
+{
+	using namespace npp_plugin::notify_trace;
+
+	std::string cmdLine( lpszCmdLine );
+	cmdLine.erase( std::remove( cmdLine.begin(), cmdLine.end(), '\"' ), cmdLine.end() );
+
+	NotificationHandler handler = NULL;
+	const std::string actionIndexMode( "actionindex " );
+	if ( cmdLine.compare( 0, actionIndexMode.length(), actionIndexMode ) == 0 ) {
+		handler = actionIndexHandler;
+		cmdLine.erase( 0, actionIndexMode.length() );
+	}
+
+	tstring tracePath( cmdLine.length(), '\0' );
+	std::copy( cmdLine.begin(), cmdLine.end(), tracePath.begin() );
+
+	replayTrace( tracePath, handler );
+}
+
+//  Every ::SendMessage in the lib and plugin sources ends up here when tracing is enabled.
+LRESULT NotifyTrace_SendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam )
+{
+	using namespace npp_plugin::notify_trace;
+
+	if ( _replaying ) return ( replayReply( Msg, wParam, lParam ) );
+
+	LRESULT result = realSendMessage( hWnd, Msg, wParam, lParam );
+	if ( _recording ) recordReply( hWnd, Msg, wParam, lParam, result );
+
+	return ( result );
+}
+
+#endif  // End: NPP_PLUGININTERFACE_NOTIFYTRACE
@@ -0,0 +1,74 @@
+/* NppPluginIface_NotifyTrace.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing record and replay of the notifications
+ *  a plugin receives, along with the replies to every message the plugin sends.
+ *
+ *  With NPP_PLUGININTERFACE_NOTIFYTRACE defined the plugin records to
+ *  <plugins config dir>\<module base name>.nptrace from setInfo until NPPN_SHUTDOWN.
+ *  The same dll replays a trace without Notepad++ using:
+ *
+ *    rundll32 NppPlugin_ChangeMarker.dll,NotifyTraceReplay C:\path\to\NppPlugin_ChangeMarker.nptrace
+ *
+ *  or, to time only the ActionIndex extension:
+ *
+ *    rundll32 NppPlugin_ChangeMarker.dll,NotifyTraceReplay actionindex C:\path\to\trace.nptrace
+ *
+ *  Latency percentiles are written next to the trace as <trace>.replay.txt.
+ *
+ *  Menu commands are not recorded as notifications, so state they change won't be replayed.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_NOTIFYTRACE_EXTENSION_H
+#define NPP_PLUGININTERFACE_NOTIFYTRACE_EXTENSION_H
+
+#include "NppPluginIface.h"
+
+#ifdef NPP_PLUGININTERFACE_HOSTSIM
+	#error "NPP_PLUGININTERFACE_NOTIFYTRACE and NPP_PLUGININTERFACE_HOSTSIM can't be used together."
+#endif
+
+//  The messaging facade forwards every ::SendMessage here to be recorded, or answered from
+//  the trace during replay.
+LRESULT NotifyTrace_SendMessage( HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam );
+
+namespace npp_plugin {
+
+//  Namespace extension for notification record and replay.
+namespace notify_trace {
+
+//  Replay handler, beNotified is used unless another is given.
+typedef void (*NotificationHandler)(SCNotification *notifyCode);
+
+//  <--- Recording --->
+bool startRecording( tstring tracePath = tstring() );	//  Default path is in the plugins config dir.
+void recordNotification( SCNotification* scn );			//  Call first thing in beNotified.
+void stopRecording();									//  Flushes and closes the trace.
+bool isRecording();
+
+//  <--- Replay --->
+void actionIndexHandler( SCNotification* scn );			//  Drives only DocTabMap and ActionIndex.
+int replayTrace( tstring tracePath, NotificationHandler handler = NULL );	//  Returns notifications replayed.
+
+}  // End namespace: notify_trace
+
+}  // End namespace: npp_plugin
+
+#endif  // End include guard: NPP_PLUGININTERFACE_NOTIFYTRACE_EXTENSION_H
@@ -0,0 +1,224 @@
+/* NppPluginIface_Timing.cpp
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing timing of the plugin's hot paths.
+ *
+ *  Samples go into a fixed size ring that a writer claims a slot in with a single interlocked
+ *  increment, so the newest RING_SIZE samples are kept and nothing is allocated or locked on
+ *  the timed paths.  Lifetime call counts are kept separately so they survive the wrap.
+ *
+ */
+
+#include "NppPluginIface.h"
+
+#ifdef NPP_PLUGININTERFACE_TIMING
+
+//  <--- STL --->
+#include <vector>
+#include <algorithm>
+#include <fstream>
+
+//  <--- Windows --->
+#include "Shlwapi.h"
+#pragma comment( lib, "Shlwapi.lib" )
+
+
+namespace npp_plugin {
+
+namespace timing {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+const LONG RING_SIZE = ( 1 << 16 );		//  Must be a power of two.
+const int NB_BUCKETS = 24;				//  Power of two microsecond buckets, the last is open.
+
+const char* PROBE_NAMES[NB_PROBES] = {
+	"beNotified",
+	"messageProc",
+	"Lex",
+	"Fold",
+	"ChangedDocument::processInsert",
+	"ChangedDocument::processDelete",
+	"ChangedDocument::processUndo",
+	"ChangedDocument::processRedo",
+	"update_DocTabMap"
+};
+
+//  One timed call.
+struct Sample {
+	LONGLONG entryTicks;
+	LONGLONG exitTicks;
+	int probe;
+};
+
+//  Summary of one probe's samples.
+struct ProbeStats {
+	LONG count;				//  Lifetime calls.
+	size_t nbSamples;		//  Calls still in the ring.
+	double p50Us;
+	double p99Us;
+	double maxUs;
+	int buckets[NB_BUCKETS];
+
+	ProbeStats():count(0), nbSamples(0), p50Us(0), p99Us(0), maxUs(0)
+	{
+		std::fill( buckets, buckets + NB_BUCKETS, 0 );
+	}
+};
+
+Sample _ring[RING_SIZE];
+volatile LONG _nextSlot = -1;
+volatile LONG _probeCounts[NB_PROBES];
+
+//  Returns the histogram bucket for a duration.
+int bucketOf( double us )
+{
+	int bucket = 0;
+	for ( double limit = 1.0; ( us >= limit ) && ( bucket < NB_BUCKETS - 1 ); limit *= 2 ) bucket++;
+	return ( bucket );
+}
+
+//  Builds the statistics for every probe from the samples in the ring.
+std::vector<ProbeStats> collectStats()
+{
+	LARGE_INTEGER perfFreq;
+	::QueryPerformanceFrequency( &perfFreq );
+	double usPerTick = 1000000.0 / double( perfFreq.QuadPart );
+
+	std::vector< std::vector<double> > durations( NB_PROBES );
+	LONG last = _nextSlot;
+	LONG nbFilled = ( last == -1 ) ? ( 0 ) : ( ( ( last >= 0 ) && ( last < RING_SIZE ) ) ? ( last + 1 ) : ( RING_SIZE ) );
+	for ( LONG slot = 0; slot < nbFilled; slot++ ) {
+		const Sample& s = _ring[slot];
+		if ( ( s.probe < 0 ) || ( s.probe >= NB_PROBES ) ) continue;
+		durations[s.probe].push_back( double( s.exitTicks - s.entryTicks ) * usPerTick );
+	}
+
+	std::vector<ProbeStats> stats( NB_PROBES );
+	for ( int probe = 0; probe < NB_PROBES; probe++ ) {
+		ProbeStats& ps = stats[probe];
+		std::vector<double>& d = durations[probe];
+
+		ps.count = _probeCounts[probe];
+		ps.nbSamples = d.size();
+		if ( d.empty() ) continue;
+
+		std::sort( d.begin(), d.end() );
+		ps.p50Us = d[ size_t( 0.50 * ( d.size() - 1 ) ) ];
+		ps.p99Us = d[ size_t( 0.99 * ( d.size() - 1 ) ) ];
+		ps.maxUs = d.back();
+		for ( size_t i = 0; i < d.size(); i++ ) ps.buckets[ bucketOf( d[i] ) ]++;
+	}
+
+	return ( stats );
+}
+
+//  Returns <plugins config dir>\<module base name><extension>.
+tstring dumpPath( const TCHAR* extension )
+{
+	TCHAR path[MAX_PATH];
+	path[0] = '\0';
+	::SendMessage( hNpp(), NPPM_GETPLUGINSCONFIGDIR, MAX_PATH, (LPARAM)path );
+	PathAppend( path, getModuleBaseName()->c_str() );
+	PathAddExtension( path, extension );
+	return ( tstring( path ) );
+}
+
+void writeCsv( tstring path, const std::vector<ProbeStats>& stats )
+{
+	std::ofstream out( path.c_str() );
+	out << "probe,count,samples,p50_us,p99_us,max_us\n";
+	for ( int probe = 0; probe < NB_PROBES; probe++ ) {
+		const ProbeStats& ps = stats[probe];
+		out << PROBE_NAMES[probe] << "," << ps.count << "," << ps.nbSamples << ","
+			<< ps.p50Us << "," << ps.p99Us << "," << ps.maxUs << "\n";
+	}
+}
+
+void writeJson( tstring path, const std::vector<ProbeStats>& stats )
+{
+	std::ofstream out( path.c_str() );
+	out << "{\n  \"bucket_upper_us\": [";
+	double limit = 1.0;
+	for ( int bucket = 0; bucket < NB_BUCKETS - 1; bucket++, limit *= 2 ) {
+		out << ( bucket ? ", " : "" ) << limit;
+	}
+	out << "],\n  \"probes\": [\n";
+
+	for ( int probe = 0; probe < NB_PROBES; probe++ ) {
+		const ProbeStats& ps = stats[probe];
+		out << "    { \"probe\": \"" << PROBE_NAMES[probe] << "\""
+			<< ", \"count\": " << ps.count
+			<< ", \"samples\": " << ps.nbSamples
+			<< ", \"p50_us\": " << ps.p50Us
+			<< ", \"p99_us\": " << ps.p99Us
+			<< ", \"max_us\": " << ps.maxUs
+			<< ", \"buckets\": [";
+		for ( int bucket = 0; bucket < NB_BUCKETS; bucket++ ) {
+			out << ( bucket ? ", " : "" ) << ps.buckets[bucket];
+		}
+		out << "] }" << ( ( probe + 1 < NB_PROBES ) ? "," : "" ) << "\n";
+	}
+	out << "  ]\n}\n";
+}
+
+}  // End: Un-named namespace
+
+
+//  Stores one timed call.
+//  The ring slot is claimed with an interlocked increment so concurrent writers never share a
+//  slot; a dump taken while a writer is filling its slot may read that one sample torn.
+void addSample( PROBE probe, LONGLONG entryTicks, LONGLONG exitTicks )
+{
+	LONG slot = ::InterlockedIncrement( &_nextSlot ) & ( RING_SIZE - 1 );
+	_ring[slot].entryTicks = entryTicks;
+	_ring[slot].exitTicks = exitTicks;
+	_ring[slot].probe = probe;
+
+	::InterlockedIncrement( &_probeCounts[probe] );
+}
+
+//  Menu command:  Writes count, p50, p99, max and a histogram for every probe.
+void dumpHistograms()
+{
+	std::vector<ProbeStats> stats = collectStats();
+
+	tstring csvPath = dumpPath( TEXT(".timing.csv") );
+	tstring jsonPath = dumpPath( TEXT(".timing.json") );
+	writeCsv( csvPath, stats );
+	writeJson( jsonPath, stats );
+
+	tstring msg( TEXT("Timing histograms were written to:\r\n\r\n") );
+	msg.append( csvPath ).append( TEXT("\r\n") ).append( jsonPath );
+	::MessageBox( hNpp(), msg.c_str(), TEXT("Plugin Timing"), MB_OK | MB_ICONINFORMATION );
+}
+
+//  Drops every sample and count.
+void resetSamples()
+{
+	::InterlockedExchange( &_nextSlot, -1 );
+	for ( int probe = 0; probe < NB_PROBES; probe++ ) ::InterlockedExchange( &_probeCounts[probe], 0 );
+}
+
+}  // End namespace: timing
+
+}  // End namespace: npp_plugin
+
+#endif  // End: NPP_PLUGININTERFACE_TIMING
@@ -0,0 +1,89 @@
+/* NppPluginIface_Timing.h
+ *
+ * This file is part of the Notepad++ Plugin Interface Lib.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ *  Notepad++ Plugin Interface Lib extension providing timing of the plugin's hot paths.
+ *
+ *  Put PIFACE_TIMED_SCOPE( PROBE_x ) at the top of a function to time it from there to its
+ *  return.  Unless NPP_PLUGININTERFACE_TIMING is defined the macro is empty and none of this
+ *  is compiled, so the probes can stay in the sources.
+ *
+ *  Register timing::dumpHistograms as a menu item to write the results to the plugins
+ *  config dir as <module base name>.timing.csv and <module base name>.timing.json.
+ *
+ */
+
+#ifndef NPP_PLUGININTERFACE_TIMING_EXTENSION_H
+#define NPP_PLUGININTERFACE_TIMING_EXTENSION_H
+
+#ifdef NPP_PLUGININTERFACE_TIMING
+
+#include "NppPluginIface.h"
+
+namespace npp_plugin {
+
+//  Namespace extension for hot path timing.
+namespace timing {
+
+//  Timed code paths.  Add new probes before NB_PROBES and give them a name in Timing.cpp.
+enum PROBE {
+	PROBE_BENOTIFIED,
+	PROBE_MESSAGEPROC,
+	PROBE_LEX,
+	PROBE_FOLD,
+	PROBE_PROCESSINSERT,
+	PROBE_PROCESSDELETE,
+	PROBE_PROCESSUNDO,
+	PROBE_PROCESSREDO,
+	PROBE_UPDATEDOCTABMAP,
+	NB_PROBES
+};
+
+void addSample( PROBE probe, LONGLONG entryTicks, LONGLONG exitTicks );	//  Lock-free, any thread.
+void dumpHistograms();							//  Menu command to write the csv and json files.
+void resetSamples();
+
+//  Times the enclosing scope.
+class ScopedTimer {
+	PROBE _probe;
+	LARGE_INTEGER _entry;
+
+public:
+	ScopedTimer( PROBE probe ):_probe(probe) { ::QueryPerformanceCounter( &_entry ); }
+	~ScopedTimer()
+	{
+		LARGE_INTEGER exit;
+		::QueryPerformanceCounter( &exit );
+		addSample( _probe, _entry.QuadPart, exit.QuadPart );
+	}
+};
+
+}  // End namespace: timing
+
+}  // End namespace: npp_plugin
+
+#define PIFACE_TIMED_SCOPE( probe ) \
+	npp_plugin::timing::ScopedTimer pifaceTimedScope( npp_plugin::timing::probe )
+
+#else
+
+#define PIFACE_TIMED_SCOPE( probe )
+
+#endif  // End: NPP_PLUGININTERFACE_TIMING
+
+#endif  // End include guard: NPP_PLUGININTERFACE_TIMING_EXTENSION_H
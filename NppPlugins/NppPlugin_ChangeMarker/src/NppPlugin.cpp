@@ -64,6 +64,12 @@ BOOL APIENTRY DllMain(HANDLE hModule, DWORD reasonForCall, LPVOID /*lpReserved*/
 		setPluginFuncItem(TEXT(""), NULL);	//  A separator line.
 		setPluginFuncItem(TEXT("Disable Tracking for this Document"), p_cm::disableDoc, p_cm::CMD_DISABLEDOC, true);
 		setPluginFuncItem(TEXT("Disable Plugin"), p_cm::disablePlugin, p_cm::CMD_DISABLEPLUGIN, true);
+#ifdef NPP_PLUGININTERFACE_TIMING
+		setPluginFuncItem(TEXT("Dump Timing Histograms"), npp_plugin::timing::dumpHistograms);
+#endif
+#ifdef NPP_PLUGININTERFACE_MSGPROFILE
+		setPluginFuncItem(TEXT("Dump Message Profile"), npp_plugin::msg_facade::dumpProfile);
+#endif
 		setPluginFuncItem(TEXT("About..."), npp_plugin::About_func);
 
 #ifdef NPP_PLUGININTERFACE_CMDMAP_EXTENSION_H
@@ -108,6 +114,12 @@ extern "C" __declspec(dllexport) void beNotified(SCNotification *notifyCode)
 {
 	using namespace npp_plugin;
 
+	PIFACE_TIMED_SCOPE( PROBE_BENOTIFIED );
+
+#ifdef NPP_PLUGININTERFACE_NOTIFYTRACE
+	notify_trace::recordNotification( notifyCode );
+#endif
+
 	switch (notifyCode->nmhdr.code) 
 	{
 	case SCN_MODIFIED:
@@ -164,6 +176,8 @@ extern "C" __declspec(dllexport) LRESULT messageProc(UINT Message, WPARAM wParam
 	//  Normally a plugin would use a switch case to check the Messages, but
 	//  this plugin only makes use of a single internal message...
 
+	PIFACE_TIMED_SCOPE( PROBE_MESSAGEPROC );
+
 	if ( Message == npp_plugin::PIFACE_MSG_NPPDATASET ) {
 		//  Confirm availability of the config file.
 		TiXmlDocument * xmlDoc( npp_plugin::xmlconfig::get_pXmlPluginConfigDoc( true ) );
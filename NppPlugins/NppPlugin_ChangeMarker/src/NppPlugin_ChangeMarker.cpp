@@ -266,6 +266,8 @@ void ChangedDocument::modifyMarkerHandle( int oldHandle, int newHandle )
 //  Processes new line action entries.
 void ChangedDocument::processInsert(int startLine, int endLine)
 {
+	PIFACE_TIMED_SCOPE( PROBE_PROCESSINSERT );
+
 	int currLine = startLine;
 
 	//  Check the startLine for an existing changemark.
@@ -304,6 +306,8 @@ void ChangedDocument::processInsert(int startLine, int endLine)
 //  Process an exisitng marker on a WHOLE LINE being deleted for proper undo/redo.
 void ChangedDocument::processDelete( int startLine, int endLine )
 {
+	PIFACE_TIMED_SCOPE( PROBE_PROCESSDELETE );
+
 	//  Update the history
 	int currLine = startLine;
 	int prevMark_State = 0;
@@ -368,6 +372,8 @@ void ChangedDocument::processDelete( int startLine, int endLine )
 //  modified, else returns false and null.
 void ChangedDocument::processUndo()
 {
+	PIFACE_TIMED_SCOPE( PROBE_PROCESSUNDO );
+
 	int nb_actions_at_index = hist.action_index.count( targetIndex );
 	if ( nb_actions_at_index > 1 ) advance( hist.a_iter, ( nb_actions_at_index - 1 ) );
 
@@ -452,6 +458,7 @@ bool ChangedDocument::doUndo( npp_plugin::actionhistory::ActionHistory *thisActi
 //  modified, else returns false and null.
 void ChangedDocument::processRedo()
 {
+	PIFACE_TIMED_SCOPE( PROBE_PROCESSREDO );
 
 	while ( hist.a_iter->_index == targetIndex ) {
 		ActionHistory thisAction = *(hist.a_iter);
@@ -0,0 +1,55 @@
+<#
+    Lexer bench sample: comments, strings, here-strings, variables,
+    operators, cmdlets, aliases, attributes and nested blocks.
+#>
+#requires -version 2.0
+
+function Get-Sample {
+    [CmdletBinding(SupportsShouldProcess = $true)]
+    param(
+        [Parameter(Mandatory = $true, Position = 0)]
+        [ValidateNotNullOrEmpty()]
+        [string] $Path,
+
+        [int] $Count = 10
+    )
+
+    begin {
+        $items = @()
+        $table = @{ Name = 'sample'; Size = 0x1F; Ratio = 1.5e3 }
+    }
+
+    process {
+        foreach ($line in (Get-Content -Path $Path)) {
+            if ($line -match '^\s*#' -or $line -eq '') {
+                continue
+            }
+            elseif ($line -like "*$($table.Name)*") {
+                $items += $line.Trim()
+            }
+            else {
+                Write-Verbose "Skipped: `"$line`" ($($items.Count))"
+            }
+        }
+    }
+
+    end {
+        $items | Sort-Object | Select-Object -First $Count | ft -AutoSize
+    }
+}
+
+$here = @"
+Expandable here-string with $env:USERNAME and $(Get-Date)
+"@
+
+$literal = @'
+Literal here-string, $nothing expands here.
+'@
+
+switch -regex ($here) {
+    'USER' { "matched user"; break }
+    default { 'no match' }
+}
+
+gci . -Recurse | ? { $_.Length -gt 1KB -band 1 } | % { $_.FullName }
+$script:total = [math]::Max(3, 7) -shl 2
@@ -0,0 +1,7 @@
+# Non-ASCII text in comments, strings and names: café, naïve, Grüße, 日本語.
+$größe = "Größe: $(12 * 3) Meter"
+$name = 'Ärger über Übergrößen'
+function Show-Größe([string] $text = "§ ¤ ©") {
+    Write-Host "$text — $größe" -ForegroundColor Cyan
+}
+Show-Größe $name
@@ -0,0 +1,78 @@
+/* LexerBenchMain.cpp
+ *
+ * This file is part of the Notepad++ External Lexers Plugin.
+ * Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program;
+ * if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*
+ *  The lexer benchmark as a Linux program, standing in for NppPlugin.cpp and the rundll32
+ *  LexerBench entry point.  It registers the lexers that have an Accessor& entry point the
+ *  way DllMain does and runs the corpus:
+ *
+ *    lexerbench [record] <corpus dir> [max MB]
+ *
+ *  Documents sized over max MB are skipped.  The exit code is the number of mismatches.
+ *
+ */
+
+#include "NppPlugin.h"
+
+#include "NppExtLexer_Conf.h"
+#include "NppExtLexer_MYUSERLANG.h"
+#include "NppExtLexer_PowerShell.h"
+
+#include <cstdio>
+#include <cstring>
+
+//  <--- Namespace Aliases --->
+namespace lIface = npp_plugin::external_lexer;
+namespace l_conf = NppExtLexer_Conf;
+namespace l_myuserlang = NppExtLexer_MYUSERLANG;
+namespace l_powershell = NppExtLexer_PowerShell;
+
+//  Notepad++ isn't there to answer, as with rundll32 where the messages go to no window.
+extern "C" LRESULT messageProc(UINT /*Message*/, WPARAM /*wParam*/, LPARAM /*lParam*/)
+{
+	return ( 0 );
+}
+
+int main( int argc, char* argv[] )
+{
+	int arg = 1;
+	bool recordGoldens = ( ( arg < argc ) && ( std::strcmp( argv[arg], "record" ) == 0 ) );
+	if ( recordGoldens ) arg++;
+
+	if ( arg >= argc ) {
+		std::fprintf( stderr, "usage: %s [record] <corpus dir> [max MB]\n", argv[0] );
+		return ( -1 );
+	}
+	npp_plugin::tstring corpusDir( argv[arg++] );
+	size_t maxBytes = ( arg < argc ) ? ( size_t( std::atoi( argv[arg] ) ) << 20 ) : ( 0 );
+
+	npp_plugin::initPlugin( TEXT("NppExternalLexers"), NULL );
+
+	lIface::initLexer( "Conf*", TEXT("Apache Config File. *Ext"),
+		l_conf::LexOrFold, l_conf::menuDlg, l_conf::LexOrFold );
+
+	lIface::initLexer( "MYUSERLANG*", TEXT("MYUSERLANG File. *Ext"),
+		l_myuserlang::LexOrFold, l_myuserlang::menuDlg, l_myuserlang::LexOrFold );
+
+	lIface::initLexer( "PowerShell*", TEXT("PowerShell Scipt File. *Ext"),
+		l_powershell::LexOrFold, l_powershell::menuDlg, l_powershell::LexOrFold );
+	lIface::bench::setLexerSetup( "PowerShell*", l_powershell::benchSetup );
+
+	int nbMismatches = lIface::bench::runBenchmark( corpusDir, recordGoldens, maxBytes );
+	std::printf( "%d mismatches, see %s/lexerbench.txt\n", nbMismatches, corpusDir.c_str() );
+	return ( nbMismatches );
+}
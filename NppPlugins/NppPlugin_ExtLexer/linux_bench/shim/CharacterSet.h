@@ -0,0 +1,19 @@
+//  Lexer bench stand-in:  Scintilla's CharacterSet.
+#pragma once
+#include <cstring>
+class CharacterSet {
+	int size; bool valueAfter; bool *bset;
+public:
+	enum setBase { setNone=0, setLower=1, setUpper=2, setDigits=4, setAlpha=setLower|setUpper, setAlphaNum=setAlpha|setDigits };
+	CharacterSet(setBase base=setNone, const char *initialSet="", int size_=0x80, bool valueAfter_=false) {
+		size=size_; valueAfter=valueAfter_; bset=new bool[size]; for(int i=0;i<size;i++) bset[i]=false;
+		AddString(initialSet);
+		if(base&setLower) AddString("abcdefghijklmnopqrstuvwxyz");
+		if(base&setUpper) AddString("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+		if(base&setDigits) AddString("0123456789");
+	}
+	~CharacterSet(){ delete[] bset; }
+	void Add(int val){ if(val>=0 && val<size) bset[val]=true; }
+	void AddString(const char *s){ for(const char* c=s;*c;c++) Add((unsigned char)*c); }
+	bool Contains(int val) const { return (val<0)?false:(val<size)?bset[val]:valueAfter; }
+};
@@ -0,0 +1,7 @@
+//  Lexer bench stand-in:  The external lexer entry point typedefs from Scintilla's ExternalLexer.h.
+#pragma once
+typedef void*(__stdcall *GetLexerFunction)(unsigned int Index);
+typedef int (__stdcall *GetLexerCountFn)();
+typedef void (__stdcall *GetLexerNameFn)(unsigned int Index, char *name, int buflength);
+typedef void (__stdcall *ExtLexerFunction)(unsigned int lexer, unsigned int startPos, int length, int initStyle, char *words[], WindowID window, char *props);
+typedef void (__stdcall *ExtFoldFunction)(unsigned int lexer, unsigned int startPos, int length, int initStyle, char *words[], WindowID window, char *props);
@@ -0,0 +1,5 @@
+//  Lexer bench stand-in:  Scintilla's LexerFunction typedef.
+#pragma once
+#include "PropSet.h"
+class Accessor;
+typedef void (*LexerFunction)(unsigned int startPos, int lengthDoc, int initStyle, WordList *keywordlists[], Accessor &styler);
@@ -0,0 +1,48 @@
+//  Lexer bench stand-in:  The Notepad++ messages the lib sends; messageProc in LexerBenchMain.cpp answers 0 to all of them.
+#pragma once
+#include "windows.h"
+#define NPPM_ACTIVATEDOC 2024
+#define NPPM_DOOPEN 2025
+#define NPPM_GETBUFFERIDFROMPOS 2026
+#define NPPM_GETCURRENTBUFFERID 2027
+#define NPPM_GETCURRENTDOCINDEX 2028
+#define NPPM_GETCURRENTSCINTILLA 2029
+#define NPPM_GETMENUHANDLE 2030
+#define NPPM_GETNBOPENFILES 2031
+#define NPPM_GETNPPDIRECTORY 2032
+#define NPPM_GETPLUGINSCONFIGDIR 2033
+#define NPPM_MENUCOMMAND 2034
+#define NPPM_MSGTOPLUGIN 2035
+#define NPPM_SETMENUITEMCHECK 2036
+#define NPPM_GETFULLCURRENTPATH 2037
+#define NPPM_GETCURRENTLANGTYPE 2038
+#define NPPM_SAVECURRENTFILE 2039
+#define NPPM_RELOADFILE 2040
+#define NPPM_GETFULLPATHFROMBUFFERID 2041
+#define NPPM_SWITCHTOFILE 2042
+#define NPPM_GETNPPVERSION 2043
+#define NPPN_FIRST 1000
+#define NPPN_READY (NPPN_FIRST + 1)
+#define NPPN_TBMODIFICATION (NPPN_FIRST + 2)
+#define NPPN_FILEBEFORECLOSE (NPPN_FIRST + 3)
+#define NPPN_FILEOPENED (NPPN_FIRST + 4)
+#define NPPN_FILECLOSED (NPPN_FIRST + 5)
+#define NPPN_FILEBEFOREOPEN (NPPN_FIRST + 6)
+#define NPPN_FILEBEFORESAVE (NPPN_FIRST + 7)
+#define NPPN_FILESAVED (NPPN_FIRST + 8)
+#define NPPN_SHUTDOWN (NPPN_FIRST + 9)
+#define NPPN_BUFFERACTIVATED (NPPN_FIRST + 10)
+#define NPPN_LANGCHANGED (NPPN_FIRST + 11)
+#define NPPN_WORDSTYLESUPDATED (NPPN_FIRST + 12)
+#define NPPN_SHORTCUTREMAPPED (NPPN_FIRST + 13)
+#define NPPN_FILEBEFORELOAD (NPPN_FIRST + 14)
+#define NPPN_FILELOADFAILED (NPPN_FIRST + 15)
+#define NPPN_READONLYCHANGED (NPPN_FIRST + 16)
+#define NPPN_DOCORDERCHANGED (NPPN_FIRST + 17)
+#define MAIN_VIEW 0
+#define SUB_VIEW 1
+#define PRIMARY_VIEW 1
+#define SECOND_VIEW 2
+#define ALL_OPEN_FILES 0
+#define MAIN_VIEW_FILES 1
+struct CommunicationInfo { long internalMsg; const char* srcModuleName; void* info; };
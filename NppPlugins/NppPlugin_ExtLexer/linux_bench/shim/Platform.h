@@ -0,0 +1,4 @@
+//  Lexer bench stand-in:  Scintilla's Platform, only the DBCS lead byte test.
+#pragma once
+#define PLAT_WIN 1
+class Platform { public: static bool IsDBCSLeadByte(int codePage, char ch){ unsigned char u=ch; return codePage==932 && ((u>=0x81&&u<=0x9F)||(u>=0xE0&&u<=0xFC)); } };
@@ -0,0 +1,16 @@
+//  Lexer bench stand-in:  The Notepad++ plugin interface types and the messageProc every plugin defines.
+#pragma once
+#include "windows.h"
+#include "TCHAR.h"
+#include "Scintilla.h"
+#include "Notepad_plus_msgs.h"
+const int nbChar = 64;
+typedef const TCHAR * (__cdecl * PFUNCGETNAME)();
+struct NppData { HWND _nppHandle; HWND _scintillaMainHandle; HWND _scintillaSecondHandle; };
+typedef void (__cdecl * PFUNCSETINFO)(NppData);
+typedef void (__cdecl * PFUNCPLUGINCMD)();
+typedef void (__cdecl * PBENOTIFIED)(SCNotification *);
+typedef LRESULT (__cdecl * PMESSAGEPROC)(UINT Message, WPARAM wParam, LPARAM lParam);
+struct ShortcutKey { bool _isCtrl; bool _isAlt; bool _isShift; unsigned char _key; };
+struct FuncItem { TCHAR _itemName[nbChar]; PFUNCPLUGINCMD _pFunc; int _cmdID; bool _init2Check; ShortcutKey *_pShKey; };
+extern "C" LRESULT messageProc(UINT Message, WPARAM wParam, LPARAM lParam);
@@ -0,0 +1,31 @@
+//  Lexer bench stand-in:  Scintilla's PropSet and WordList.
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+class PropSet {
+	std::map<std::string,std::string> m;
+public:
+	void Set(const char* k, const char* v){ m[k]=v; }
+	void SetMultiple(const char* s){ std::string all(s); size_t p=0; while(p<all.size()){ size_t e=all.find('\n',p); if(e==std::string::npos) e=all.size(); std::string l=all.substr(p,e-p); size_t q=l.find('='); if(q!=std::string::npos) m[l.substr(0,q)]=l.substr(q+1); p=e+1; } }
+	int GetInt(const char* k, int d = 0){ std::map<std::string,std::string>::iterator i=m.find(k); if(i==m.end()||i->second.empty()) return d; return atoi(i->second.c_str()); }
+	char* ToString(){ std::string s; for(std::map<std::string,std::string>::iterator i=m.begin();i!=m.end();++i){ s+=i->first+"="+i->second+"\n"; } char* p=(char*)malloc(s.size()+1); strcpy(p,s.c_str()); return p; }
+};
+#include <strings.h>
+inline bool isspacechar(unsigned char ch){ return (ch == ' ') || ((ch >= 0x09) && (ch <= 0x0d)); }
+inline int CompareCaseInsensitive(const char *a, const char *b){ return strcasecmp(a,b); }
+inline int CompareNCaseInsensitive(const char *a, const char *b, size_t n){ return strncasecmp(a,b,n); }
+class WordList {
+public:
+	char **words; char *list; int len; bool onlyLineEnds; bool sorted; int starts[256];
+	WordList(bool o=false) : words(0), list(0), len(0), onlyLineEnds(o), sorted(false) {}
+	~WordList(){ Clear(); }
+	operator bool(){ return len ? true : false; }
+	char *operator[](int ind){ return words[ind]; }
+	void Clear(){ if(words){ delete[] list; delete[] words; } words=0; list=0; len=0; sorted=false; }
+	void Set(const char *s){ Clear(); list=new char[strlen(s)+1]; strcpy(list,s); int n=0; bool w=false; for(char* p=list;*p;p++){ bool sp=(*p==' '||*p=='\t'||*p=='\n'||*p=='\r'); if(!sp&&!w) n++; w=!sp; } words=new char*[n+1]; len=0; w=false; for(char* p=list;*p;p++){ bool sp=(*p==' '||*p=='\t'||*p=='\n'||*p=='\r'); if(sp) *p=0; else if(!w) words[len++]=p; w=!sp; } words[len]=0; }
+	bool InList(const char *s){ for(int i=0;i<len;i++) if(!strcmp(words[i],s)) return true; return false; }
+	bool InListAbbreviated(const char *s, const char marker);
+};
+inline bool WordList::InListAbbreviated(const char *s, const char){ return InList(s); }
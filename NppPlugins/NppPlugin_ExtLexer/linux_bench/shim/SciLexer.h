@@ -0,0 +1,6 @@
+//  Lexer bench stand-in:  The SCLEX_ values the lib uses from Scintilla's SciLexer.h.
+#pragma once
+#define SCLEX_CONTAINER 0
+#define SCLEX_NULL 1
+#define SCLEX_USER 1000
+#define SCLEX_AUTOMATIC 1000
@@ -0,0 +1,93 @@
+//  Lexer bench stand-in:  The Scintilla messages, constants and notification struct the lib and lexers use.
+#pragma once
+#include "windows.h"
+typedef void* WindowID; typedef intptr_t sptr_t; typedef uintptr_t uptr_t;
+typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam, sptr_t lParam);
+#define SC_FOLDLEVELBASE 0x400
+#define SC_FOLDLEVELWHITEFLAG 0x1000
+#define SC_FOLDLEVELHEADERFLAG 0x2000
+#define SC_FOLDLEVELNUMBERMASK 0x0FFF
+#define SC_CP_UTF8 65001
+#define INDIC_ROUNDBOX 7
+#define INDIC_PLAIN 0
+#define INDIC_CONTAINER 8
+#define INDIC_MAX 31
+#define SCI_BRACEMATCH 2000
+#define SCI_COLOURISE 2001
+#define SCI_DOCLINEFROMVISIBLE 2002
+#define SCI_ENSUREVISIBLEENFORCEPOLICY 2003
+#define SCI_GETCHARACTERPOINTER 2004
+#define SCI_GETCURRENTPOS 2005
+#define SCI_GETDOCPOINTER 2006
+#define SCI_GETENDSTYLED 2007
+#define SCI_GETFIRSTVISIBLELINE 2008
+#define SCI_GETFOLDLEVEL 2009
+#define SCI_GETLENGTH 2010
+#define SCI_GETLEXER 2011
+#define SCI_GETLINECOUNT 2012
+#define SCI_GETLINESTATE 2013
+#define SCI_GETMARGINMASKN 2014
+#define SCI_GETMARGINWIDTHN 2015
+#define SCI_GETSTYLEDTEXT 2016
+#define SCI_GETTEXTRANGE 2017
+#define SCI_GOTOLINE 2018
+#define SCI_INDICATORCLEARRANGE 2019
+#define SCI_INDICATORFILLRANGE 2020
+#define SCI_INDICGETFORE 2021
+#define SCI_INDICGETUNDER 2022
+#define SCI_INDICSETALPHA 2023
+#define SCI_INDICSETFORE 2024
+#define SCI_INDICSETSTYLE 2025
+#define SCI_INDICSETUNDER 2026
+#define SCI_LINEFROMPOSITION 2027
+#define SCI_LINESONSCREEN 2028
+#define SCI_MARKERADD 2029
+#define SCI_MARKERDEFINE 2030
+#define SCI_MARKERDEFINEPIXMAP 2031
+#define SCI_MARKERDELETEALL 2032
+#define SCI_MARKERDELETEHANDLE 2033
+#define SCI_MARKERGET 2034
+#define SCI_MARKERLINEFROMHANDLE 2035
+#define SCI_MARKERSETALPHA 2036
+#define SCI_MARKERSETBACK 2037
+#define SCI_MARKERSETFORE 2038
+#define SCI_POSITIONFROMLINE 2039
+#define SCI_SETFOLDLEVEL 2040
+#define SCI_SETINDICATORCURRENT 2041
+#define SCI_SETINDICATORVALUE 2042
+#define SCI_SETLINESTATE 2043
+#define SCI_SETMARGINMASKN 2044
+#define SCI_SETMARGINTYPEN 2045
+#define SCI_SETMARGINWIDTHN 2046
+#define SCI_SETSTYLINGEX 2047
+#define SCI_STARTSTYLING 2048
+#define SCI_STYLEGETBACK 2049
+#define SCI_STYLEGETBOLD 2050
+#define SCI_STYLEGETITALIC 2051
+#define SCI_STYLEGETUNDERLINE 2052
+#define SCI_SETLEXER 2053
+#define SCI_GETCODEPAGE 2054
+#define SCI_SETSTYLING 2055
+#define SCI_GETSTYLEAT 2056
+#define SCI_GETCHARAT 2057
+#define SCI_SETPROPERTY 2058
+#define SCI_SETKEYWORDS 2059
+#define SCI_GETDIRECTFUNCTION 2060
+#define SCI_GETDIRECTPOINTER 2061
+#define SCI_INDICATORVALUEAT 2062
+#define SCI_INDICATORALLONFOR 2063
+#define SCI_INDICATOREND 2064
+#define SCI_INDICATORSTART 2065
+#define SCI_GETLINEENDPOSITION 2066
+#define SCI_GETSELECTIONSTART 2067
+#define SCI_GETSELECTIONEND 2068
+#define SCI_SETLEXERLANGUAGE 2069
+#define SCI_STYLESETBACK 2070
+#define SCI_STYLESETFORE 2071
+#define SCN_MODIFIED 2008
+#define SCN_UPDATEUI 2007
+#define SCN_STYLENEEDED 2000
+#define SCN_CHARADDED 2001
+struct Sci_CharacterRange { long cpMin; long cpMax; }; struct Sci_TextRange { Sci_CharacterRange chrg; char* lpstrText; };
+typedef Sci_CharacterRange CharacterRange; typedef Sci_TextRange TextRange;
+struct SCNotification { NMHDR nmhdr; int position; int ch; int modifiers; int modificationType; const char* text; int length; int linesAdded; int message; uptr_t wParam; sptr_t lParam; int line; int foldLevelNow; int foldLevelPrev; int margin; int listType; int x; int y; int token; int annotationLinesAdded; int updated; };
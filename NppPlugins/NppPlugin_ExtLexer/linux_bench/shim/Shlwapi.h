@@ -0,0 +1,9 @@
+//  Lexer bench stand-in:  The Shlwapi path functions, working on '/' separated paths.
+#pragma once
+#include "windows.h"
+inline BOOL PathAppend(char* p, const char* m){ size_t l=strlen(p); if(l && p[l-1]!='/') strcat(p,"/"); strcat(p,m); return 1; }
+inline BOOL PathRemoveFileSpec(char* p){ char* s=strrchr(p,'\\'); if(s){*s=0; return 1;} return 0; }
+inline BOOL PathRemoveExtension(char* p){ char* s=strrchr(p,'.'); if(s) *s=0; return 1; }
+inline char* PathFindFileName(char* p){ char* s=strrchr(p,'\\'); return s?s+1:p; }
+inline const char* PathFindExtension(const char* p){ const char* s=strrchr(p,'.'); return s?s:p+strlen(p); }
+inline void PathStripPath(char* p){ char* s=strrchr(p,'\\'); if(!s) s=strrchr(p,'/'); if(s) memmove(p,s+1,strlen(s+1)+1); }
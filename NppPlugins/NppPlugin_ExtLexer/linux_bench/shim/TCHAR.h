@@ -0,0 +1,22 @@
+//  Lexer bench stand-in:  TCHAR as char, the bench builds without UNICODE.
+#pragma once
+#include <cstring>
+#include <cctype>
+typedef char TCHAR;
+#define TEXT(x) x
+#define _T(x) x
+#define _tcslen strlen
+#define _tcscmp strcmp
+#define _tcsicmp strcasecmp
+#define _tcscpy strcpy
+#define _tcsncpy strncpy
+#define _tcschr strchr
+#define _tcsrchr strrchr
+#define _tcsstr strstr
+#define _ttoi atoi
+#define _tcstol strtol
+#define _istspace isspace
+#define _stprintf sprintf
+#define _sntprintf snprintf
+#define _tfopen fopen
+typedef const char* LPCTSTR; typedef char* LPTSTR;
@@ -0,0 +1,2 @@
+//  Lexer bench stand-in:  SciCommon.h includes Scintilla's WindowAccessor.h, the bench uses none of it.
+#pragma once
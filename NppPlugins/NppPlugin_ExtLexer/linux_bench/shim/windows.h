@@ -0,0 +1,124 @@
+//  Lexer bench stand-in:  The Win32 types and calls the lib uses, on top of the C library and pthreads.
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <cstdarg>
+#include <stdint.h>
+#define __declspec(x)
+#define __stdcall
+#define __cdecl
+#define WINAPI
+#define CALLBACK
+#define APIENTRY
+#define __forceinline inline
+typedef int BOOL; typedef unsigned int UINT; typedef unsigned long DWORD; typedef long LONG;
+typedef long long LONGLONG; typedef unsigned long long ULONGLONG; typedef unsigned char BYTE;
+typedef unsigned short WORD; typedef intptr_t LPARAM; typedef uintptr_t WPARAM; typedef intptr_t LRESULT;
+typedef void* HANDLE; typedef void* HWND; typedef void* HINSTANCE; typedef void* HMODULE; typedef void* LPVOID;
+typedef char CHAR; typedef char* LPSTR; typedef const char* LPCSTR; typedef wchar_t WCHAR;
+typedef uintptr_t UINT_PTR; typedef intptr_t INT_PTR; typedef uintptr_t ULONG_PTR; typedef intptr_t LONG_PTR; typedef unsigned long ULONG;
+typedef DWORD COLORREF; typedef void* HMENU; typedef void* HDC; typedef void* HBRUSH; typedef void* HFONT; typedef void* HICON;
+typedef long HRESULT;
+#define TRUE 1
+#define FALSE 0
+#ifndef NULL
+#define NULL 0
+#endif
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFF
+#define WT_EXECUTEDEFAULT 0
+#define MB_OK 0
+#define MB_ICONERROR 0x10
+#define MB_ICONWARNING 0x30
+#define MB_ICONEXCLAMATION 0x30
+#define MB_ICONINFORMATION 0x40
+#define MB_YESNO 4
+#define IDYES 6
+#define DLL_PROCESS_ATTACH 1
+#define DLL_PROCESS_DETACH 0
+#define DLL_THREAD_ATTACH 2
+#define DLL_THREAD_DETACH 3
+#define WM_USER 0x400
+#define WM_NOTIFY 0x4E
+#define WM_COMMAND 0x111
+#define WM_TIMER 0x113
+#define FILE_ATTRIBUTE_DIRECTORY 0x10
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define RGB(r,g,b) ((COLORREF)(((BYTE)(r)|((WORD)((BYTE)(g))<<8))|(((DWORD)(BYTE)(b))<<16)))
+#define GetRValue(c) ((BYTE)(c))
+#define GetGValue(c) ((BYTE)(((WORD)(c)) >> 8))
+#define GetBValue(c) ((BYTE)((c)>>16))
+#define LOWORD(l) ((WORD)((DWORD_PTR)(l) & 0xffff))
+typedef uintptr_t DWORD_PTR;
+#define UNREFERENCED_PARAMETER(p) (void)(p)
+#define _ASSERT(x)
+#define _ASSERTE(x)
+typedef struct _NMHDR { HWND hwndFrom; UINT_PTR idFrom; UINT code; } NMHDR;
+typedef union _LARGE_INTEGER { struct { DWORD LowPart; LONG HighPart; }; LONGLONG QuadPart; } LARGE_INTEGER;
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* f){ f->QuadPart = 1000000000LL; return 1; }
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* c){ timespec t; clock_gettime(CLOCK_MONOTONIC,&t); c->QuadPart = t.tv_sec*1000000000LL + t.tv_nsec; return 1; }
+inline DWORD GetTickCount(){ timespec t; clock_gettime(CLOCK_MONOTONIC,&t); return t.tv_sec*1000 + t.tv_nsec/1000000; }
+inline LRESULT SendMessageA(HWND, UINT, WPARAM, LPARAM){ return 0; }
+#define SendMessage SendMessageA
+inline int MessageBoxA(HWND, const char* t, const char* c, UINT){ fprintf(stderr,"MessageBox[%s]: %s\n",c,t); return 1; }
+#define MessageBox MessageBoxA
+inline DWORD GetModuleFileNameA(HMODULE, char* p, DWORD n){ strncpy(p,"NppExtLexer.dll",n); return strlen(p); }
+#define GetModuleFileName GetModuleFileNameA
+inline char* lstrcpyn(char* d, const char* s, int n){ strncpy(d,s,n); d[n-1]=0; return d; }
+inline int lstrlen(const char* s){ return strlen(s); }
+inline int lstrcmpi(const char* a, const char* b){ return strcasecmp(a,b); }
+inline int lstrcmp(const char* a, const char* b){ return strcmp(a,b); }
+inline BOOL CreateDirectoryA(const char* p, void*){ return mkdir(p,0777)==0; }
+#define CreateDirectory CreateDirectoryA
+inline DWORD GetFileAttributesA(const char* p){ struct stat s; if(stat(p,&s)) return 0xFFFFFFFF; return S_ISDIR(s.st_mode)?FILE_ATTRIBUTE_DIRECTORY:0x80; }
+#define GetFileAttributes GetFileAttributesA
+#define INVALID_FILE_ATTRIBUTES 0xFFFFFFFF
+inline BOOL PathFileExistsA(const char* p){ struct stat s; return stat(p,&s)==0; }
+#define PathFileExists PathFileExistsA
+struct WIN32_FIND_DATAA { DWORD dwFileAttributes; char cFileName[MAX_PATH]; };
+typedef WIN32_FIND_DATAA WIN32_FIND_DATA;
+struct FindH { DIR* d; std::string dir; std::string pat; };
+inline bool fmatch(const std::string& pat, const char* n){ if(pat=="*"||pat=="*.*") return true; if(pat[0]=='*') { std::string suf=pat.substr(1); size_t l=strlen(n); return l>=suf.size() && strcasecmp(n+l-suf.size(),suf.c_str())==0; } return strcasecmp(pat.c_str(),n)==0; }
+inline BOOL FindNextFileA(HANDLE h, WIN32_FIND_DATA* fd){ FindH* f=(FindH*)h; dirent* e; while((e=readdir(f->d))){ if(!fmatch(f->pat,e->d_name)) continue; strncpy(fd->cFileName,e->d_name,MAX_PATH); struct stat s; std::string p=f->dir+"/"+e->d_name; stat(p.c_str(),&s); fd->dwFileAttributes=S_ISDIR(s.st_mode)?FILE_ATTRIBUTE_DIRECTORY:0x80; return 1; } return 0; }
+inline HANDLE FindFirstFileA(const char* spec, WIN32_FIND_DATA* fd){ std::string s(spec); for(size_t i=0;i<s.size();i++) if(s[i]=='\\') s[i]='/'; size_t k=s.rfind('/'); FindH* f=new FindH; f->dir=k==std::string::npos?".":s.substr(0,k); f->pat=s.substr(k+1); f->d=opendir(f->dir.c_str()); if(!f->d){delete f; return INVALID_HANDLE_VALUE;} if(!FindNextFileA(f,fd)){closedir(f->d); delete f; return INVALID_HANDLE_VALUE;} return f; }
+inline BOOL FindClose(HANDLE h){ FindH* f=(FindH*)h; closedir(f->d); delete f; return 1; }
+#define FindFirstFile FindFirstFileA
+#define FindNextFile FindNextFileA
+struct SYSTEM_INFO { DWORD dwNumberOfProcessors; };
+inline void GetSystemInfo(SYSTEM_INFO* i){ i->dwNumberOfProcessors = 4; }
+inline LONG InterlockedIncrement(volatile LONG* p){ return __sync_add_and_fetch(p,1); }
+inline LONG InterlockedDecrement(volatile LONG* p){ return __sync_sub_and_fetch(p,1); }
+inline LONG InterlockedExchange(volatile LONG* p, LONG v){ return __sync_lock_test_and_set(p,v); }
+inline LONG InterlockedCompareExchange(volatile LONG* p, LONG x, LONG c){ return __sync_val_compare_and_swap(p,c,x); }
+struct Ev { pthread_mutex_t m; pthread_cond_t c; bool s; };
+inline HANDLE CreateEvent(void*, int, int, void*){ Ev* e=new Ev; pthread_mutex_init(&e->m,0); pthread_cond_init(&e->c,0); e->s=false; return e; }
+inline void SetEvent(HANDLE h){ Ev* e=(Ev*)h; pthread_mutex_lock(&e->m); e->s=true; pthread_cond_broadcast(&e->c); pthread_mutex_unlock(&e->m); }
+inline void ResetEvent(HANDLE h){ Ev* e=(Ev*)h; pthread_mutex_lock(&e->m); e->s=false; pthread_mutex_unlock(&e->m); }
+inline DWORD WaitForSingleObject(HANDLE h, DWORD){ Ev* e=(Ev*)h; pthread_mutex_lock(&e->m); while(!e->s) pthread_cond_wait(&e->c,&e->m); pthread_mutex_unlock(&e->m); return 0; }
+inline void CloseHandle(HANDLE h){ delete (Ev*)h; }
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(LPVOID);
+struct QItem { LPTHREAD_START_ROUTINE f; LPVOID p; };
+inline void* qthunk(void* a){ QItem* q=(QItem*)a; q->f(q->p); delete q; return 0; }
+inline BOOL QueueUserWorkItem(LPTHREAD_START_ROUTINE f, LPVOID p, ULONG){ pthread_t t; QItem* q=new QItem; q->f=f; q->p=p; pthread_create(&t,0,qthunk,q); pthread_detach(t); return 1; }
+typedef pthread_mutex_t CRITICAL_SECTION;
+inline void InitializeCriticalSection(CRITICAL_SECTION* c){ pthread_mutexattr_t a; pthread_mutexattr_init(&a); pthread_mutexattr_settype(&a,PTHREAD_MUTEX_RECURSIVE); pthread_mutex_init(c,&a); }
+inline void DeleteCriticalSection(CRITICAL_SECTION* c){ pthread_mutex_destroy(c); }
+inline void EnterCriticalSection(CRITICAL_SECTION* c){ pthread_mutex_lock(c); }
+inline void LeaveCriticalSection(CRITICAL_SECTION* c){ pthread_mutex_unlock(c); }
+inline void Sleep(DWORD ms){ usleep(ms*1000); }
+inline DWORD GetCurrentThreadId(){ return (DWORD)(uintptr_t)pthread_self(); }
+inline UINT_PTR SetTimer(HWND, UINT_PTR id, UINT, void*){ return id; }
+inline BOOL KillTimer(HWND, UINT_PTR){ return 1; }
+template <class T> inline T max(T a, T b){ return a < b ? b : a; }
+template <class T> inline T min(T a, T b){ return b < a ? b : a; }
+struct RECT { LONG left, top, right, bottom; };
+inline BOOL InvalidateRect(HWND, const RECT*, BOOL){ return 1; }
+inline BOOL UpdateWindow(HWND){ return 1; }
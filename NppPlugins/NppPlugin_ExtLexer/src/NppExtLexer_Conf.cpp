@@ -41,6 +41,33 @@ namespace lex = NppExtLexer_Conf;				//  This lexer's namespace.
 
 namespace NppExtLexer_Conf {
 
+//  Directives, params, and USERDEF words, in that order of precedence.  Rebuilt by LexOrFold
+//  whenever Notepad++ passes different keyword lists.
+lIface::KeywordClassifier kc_words;
+
+//  The properties and WordLists Notepad++ passes, kept until their text changes.
+lIface::LexerInputs inputs;
+
+//  Character classes, held in one table on top of the base classes.  Unlike isalnum() and
+//  friends these don't change with the locale.
+enum {
+	WORD_CHAR		= lIface::char_class::FIRST_LEXER_FLAG,		//  Alphanumerics and _-$/.*
+	NUMBER_CHAR		= WORD_CHAR << 1							//  Digits and .
+};
+
+#define CONF_CHAR_CLASS( c ) ( NPP_CHARCLASS_BASE( c ) | \
+	( ( ( ( c ) >= '0' && ( c ) <= '9' ) || ( ( c ) >= 'A' && ( c ) <= 'Z' ) || \
+		( ( c ) >= 'a' && ( c ) <= 'z' ) || ( c ) == '_' || ( c ) == '-' || ( c ) == '$' || \
+		( c ) == '/' || ( c ) == '.' || ( c ) == '*' ) ? WORD_CHAR : 0 ) | \
+	( ( ( ( c ) >= '0' && ( c ) <= '9' ) || ( c ) == '.' ) ? NUMBER_CHAR : 0 ) )
+
+const lIface::char_class::Flags confClass[256] = { NPP_CHARCLASS_TABLE( CONF_CHAR_CLASS ) };
+
+inline bool isIn( int ch, lIface::char_class::Flags classes )
+{
+	return ( lIface::char_class::is( confClass, static_cast<unsigned char>( ch ), classes ) );
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 //  Main Lexer Functions
 
@@ -58,30 +85,30 @@ namespace NppExtLexer_Conf {
 // The License.txt file describes the conditions under which this software may be distributed.
 
 
-static void Colourise_Doc(unsigned int startPos, int length, int, WordList *keywordLists[], Accessor &styler)
+//  Identifiers longer than this are kept whole in the document but only their start is kept
+//  here; no keyword is that long, so they're never classified.
+const int TOKEN_BUFFER_SIZE = 128;
+
+static void Colourise_Doc(unsigned int startPos, int length, int, WordList *[], Accessor &styler)
 {
 	int state = sID::DEFAULT;
-	char chNext = styler[startPos];
 	int lengthDoc = startPos + length;
-	// create a buffer large enough to take the largest chunk...
-	char *buffer = new char[length];
+	char buffer[TOKEN_BUFFER_SIZE];
 	int bufferCount = 0;
+	bool tokenOverflow = false;		//  The identifier didn't fit in buffer.
+	bool tokenHasPath = false;		//  The identifier has a '/' or '.', or the number a '.'.
 
-	// this assumes that we have 2 keyword list in conf.properties
-	WordList &directives = *keywordLists[0];
-	WordList &params = *keywordLists[1];
-	WordList &USERDEF = *keywordLists[2];
+	// read the text a block at a time rather than a character at a time through the styler
+	lIface::TextSnapshot text(styler);
 
 	// go through all provided text segment
 	// using the hand-written state machine shown below
 	styler.StartAt(startPos);
 	styler.StartSegment(startPos);
 	for (int i = startPos; i < lengthDoc; i++) {
-		char ch = chNext;
-		chNext = styler.SafeGetCharAt(i + 1);
+		char ch = text.charAt(i, lengthDoc);
 
 		if (styler.IsLeadByte(ch)) {
-			chNext = styler.SafeGetCharAt(i + 2);
 			i++;
 			continue;
 		}
@@ -102,20 +129,21 @@ static void Colourise_Doc(unsigned int startPos, int length, int, WordList *keyw
 				} else if( ch == '"') {
 					state = sID::STRING;
 					styler.ColourTo(i,sID::STRING);
-				} else if( ispunct(ch) ) {
+				} else if( isIn(ch, lIface::char_class::PUNCT) ) {
 					// signals an operator...
 					// no state jump necessary for this
 					// simple case...
 					styler.ColourTo(i,sID::OPERATOR);
-				} else if( isalpha(ch) ) {
+				} else if( isIn(ch, lIface::char_class::ALPHA) ) {
 					// signals the start of an identifier
 					bufferCount = 0;
-					buffer[bufferCount++] = static_cast<char>(tolower(ch));
+					buffer[bufferCount++] = static_cast<char>(lIface::char_class::toLower(ch));
+					tokenOverflow = false;
+					tokenHasPath = false;
 					state = sID::IDENTIFIER;
-				} else if( isdigit(ch) ) {
+				} else if( isIn(ch, lIface::char_class::DIGIT) ) {
 					// signals the start of a number
-					bufferCount = 0;
-					buffer[bufferCount++] = ch;
+					tokenHasPath = false;
 					//styler.ColourTo(i,sID::NUMBER);
 					state = sID::NUMBER;
 				} else {
@@ -139,21 +167,19 @@ static void Colourise_Doc(unsigned int startPos, int length, int, WordList *keyw
 				// if we find a non-alphanumeric char,
 				// we simply go to default state
 				// else we're still dealing with an extension...
-				if( isalnum(ch) || (ch == '_') ||
-					(ch == '-') || (ch == '$') ||
-					(ch == '/') || (ch == '.') || (ch == '*') )
+				if( isIn(ch, WORD_CHAR) )
 				{
 					styler.ColourTo(i,sID::EXTENSION);
 				} else {
 					state = sID::DEFAULT;
-					chNext = styler[i--];
+					i--;
 				}
 				break;
 
 			case sID::STRING:
 				// if we find the end of a string char, we simply go to default state
 				// else we're still dealing with an string...
-				if( (ch == '"' && styler.SafeGetCharAt(i-1)!='\\') || (ch == '\n') || (ch == '\r') ) {
+				if( (ch == '"' && text.charAt(i-1, lengthDoc)!='\\') || (ch == '\n') || (ch == '\r') ) {
 					state = sID::DEFAULT;
 				}
 				styler.ColourTo(i,sID::STRING);
@@ -161,41 +187,46 @@ static void Colourise_Doc(unsigned int startPos, int length, int, WordList *keyw
 
 			case sID::IDENTIFIER:
 				// stay  in CONF_IDENTIFIER state until we find a non-alphanumeric
-				if( isalnum(ch) || (ch == '_') || (ch == '-') || (ch == '/') || (ch == '$') || (ch == '.') || (ch == '*')) {
-					buffer[bufferCount++] = static_cast<char>(tolower(ch));
+				if( isIn(ch, WORD_CHAR) ) {
+					if( bufferCount < TOKEN_BUFFER_SIZE - 1 )
+						buffer[bufferCount++] = static_cast<char>(lIface::char_class::toLower(ch));
+					else
+						tokenOverflow = true;
+					if( ch == '/' || ch == '.' )
+						tokenHasPath = true;
 				} else {
 					state = sID::DEFAULT;
 					buffer[bufferCount] = '\0';
 
 					// check if the buffer contains a keyword, and highlight it if it is a keyword...
-					if(directives.InList(buffer)) {
-						styler.ColourTo(i-1,sID::DIRECTIVE );
-					} else if(params.InList(buffer)) {
-						styler.ColourTo(i-1,sID::PARAMETER );
-					} else if(USERDEF.InList(buffer)) {
-						styler.ColourTo(i-1,sID::USERDEF );
-					} else if(strchr(buffer,'/') || strchr(buffer,'.')) {
+					int wordStyle = lIface::KeywordClassifier::NO_MATCH;
+					if(!tokenOverflow)
+						wordStyle = kc_words.classify(buffer);
+					if(wordStyle != lIface::KeywordClassifier::NO_MATCH) {
+						// DIRECTIVE, PARAMETER, or USERDEF
+						styler.ColourTo(i-1,wordStyle );
+					} else if(tokenHasPath) {
 						styler.ColourTo(i-1,sID::EXTENSION);
 					} else {
 						styler.ColourTo(i-1,sID::DEFAULT);
 					}
 
 					// push back the faulty character
-					chNext = styler[i--];
+					i--;
 
 				}
 				break;
 
 			case sID::NUMBER:
 				// stay  in CONF_NUMBER state until we find a non-numeric
-				if( isdigit(ch) || ch == '.') {
-					buffer[bufferCount++] = ch;
+				if( isIn(ch, NUMBER_CHAR) ) {
+					if( ch == '.' )
+						tokenHasPath = true;
 				} else {
 					state = sID::DEFAULT;
-					buffer[bufferCount] = '\0';
 
 					// Colourize here...
-					if( strchr(buffer,'.') ) {
+					if( tokenHasPath ) {
 						// it is an IP address...
 						styler.ColourTo(i-1,sID::IP);
 					} else {
@@ -204,80 +235,73 @@ static void Colourise_Doc(unsigned int startPos, int length, int, WordList *keyw
 					}
 
 					// push back a character
-					chNext = styler[i--];
+					i--;
 				}
 				break;
 
 		}
 	}
-	delete []buffer;
 }
 
-//  <--- Fold --->
-static bool IsCommentLine(int line, Accessor &styler) {
-	int pos = styler.LineStart(line);
-	int eol_pos = styler.LineStart(line + 1) - 1;
-	for (int i = pos; i < eol_pos; i++) {
-		char ch = styler[i];
-		if (ch == '#')
-			return true;
-		else if (ch != ' ' && ch != '\t')
-			return false;
-	}
-	return false;
+//  Every state ends at a line end, so styling can start over at any line; unless the line end
+//  was taken as the second byte of a DBCS character.
+static bool SafeLineStart(Accessor &styler, const char *text, int lineStart)
+{
+	return (lineStart < 2) || !styler.IsLeadByte(text[lineStart - 2]);
 }
 
-
-void Fold_Doc(unsigned int startPos, int length, int initStyle, WordList *[], Accessor &styler)
+//  <--- Fold --->
+//  What one line does to the fold level; context points at the fold.comment setting.
+static void FoldLine(const lIface::FoldText &text, int line, int lineStart, int lineEnd, void *context,
+                     lIface::LineFold &fold)
 {
-
-	bool foldComment = styler.GetPropertyInt("fold.comment") != 0;
-	bool foldCompact = styler.GetPropertyInt("fold.compact", 1) != 0;
-	unsigned int endPos = startPos + length;
-	int visibleChars = 0;
-	int lineCurrent = styler.GetLine(startPos);
-	int levelPrev = styler.LevelAt(lineCurrent) & SC_FOLDLEVELNUMBERMASK;
-	int levelCurrent = levelPrev;
-	char chNext = styler[startPos];
-	int styleNext = styler.StyleAt(startPos);
-	for (unsigned int i = startPos; i < endPos; i++) {
-		char ch = chNext;
-		chNext = styler.SafeGetCharAt(i + 1);
-		int style = styleNext;
-		styleNext = styler.StyleAt(i + 1);
+	bool foldComment = *static_cast<bool *>(context);
+	for (int i = lineStart; i < lineEnd; i++) {
+		char ch = text.charAt(i);
+		char chNext = text.charAt(i + 1);
 		bool atEOL = (ch == '\r' && chNext != '\n') || (ch == '\n');
         // Comment folding
-		if (foldComment && atEOL && IsCommentLine(lineCurrent, styler))
+		if (foldComment && atEOL && text.isCommentLine(line))
         {
-            if (!IsCommentLine(lineCurrent - 1, styler)
-                && IsCommentLine(lineCurrent + 1, styler))
-                levelCurrent++;
-            else if (IsCommentLine(lineCurrent - 1, styler)
-                     && !IsCommentLine(lineCurrent+1, styler))
-                levelCurrent--;
+            bool commentBefore = text.isCommentLine(line - 1);
+            bool commentAfter = text.isCommentLine(line + 1);
+            if (!commentBefore && commentAfter)
+                fold.delta++;
+            else if (commentBefore && !commentAfter)
+                fold.delta--;
         }
-		if (style == sID::OPERATOR) {
+		if (text.styleAt(i) == sID::OPERATOR) {
 			if ( ch == '<' && chNext != '/' ) {
-				levelCurrent++;
+				fold.delta++;
 			} else if (ch == '<' && chNext == '/') {
-				levelCurrent--;
+				fold.delta--;
 			}
 		}
-		if (atEOL) {
-			int lev = levelPrev;
-			if (visibleChars == 0 && foldCompact)
-				lev |= SC_FOLDLEVELWHITEFLAG;
-			if ((levelCurrent > levelPrev) && (visibleChars > 0))
-				lev |= SC_FOLDLEVELHEADERFLAG;
-			if (lev != styler.LevelAt(lineCurrent)) {
-				styler.SetLevel(lineCurrent, lev);
-			}
-			lineCurrent++;
-			levelPrev = levelCurrent;
-			visibleChars = 0;
+	}
+}
+
+//  The lines' deltas are found on all processors and summed into levels, see foldLevels.
+void Fold_Doc(unsigned int startPos, int length, int initStyle, WordList *[], Accessor &styler)
+{
+
+	bool foldComment = styler.GetPropertyInt("fold.comment") != 0;
+	bool foldCompact = styler.GetPropertyInt("fold.compact", 1) != 0;
+	int lineCurrent = styler.GetLine(startPos);
+	int levelPrev = styler.LevelAt(lineCurrent) & SC_FOLDLEVELNUMBERMASK;
+	std::vector<lIface::LineLevels> levels;
+	lIface::foldLevels(styler, startPos, length, levelPrev, "#", FoldLine, &foldComment, levels);
+	for (size_t n = 0; (n < levels.size()) && levels[n].ended; n++) {
+		const lIface::LineLevels &line = levels[n];
+		int lev = line.start;
+		if (!line.visible && foldCompact)
+			lev |= SC_FOLDLEVELWHITEFLAG;
+		if ((line.end > line.start) && line.visible)
+			lev |= SC_FOLDLEVELHEADERFLAG;
+		if (lev != styler.LevelAt(lineCurrent)) {
+			styler.SetLevel(lineCurrent, lev);
 		}
-		if (!isspacechar(ch))
-			visibleChars++;
+		lineCurrent++;
+		levelPrev = line.end;
 	}
 	// Fill in the real level of the next line, keeping the current flags as they will be filled in later
 	int flagsNext = styler.LevelAt(lineCurrent) & ~SC_FOLDLEVELNUMBERMASK;
@@ -293,28 +317,24 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
                   char *words[], WindowID window, char *props)
 {
 
-	// Create and initialize the WindowAccessor (including contained PropSet)
-	PropSet ps;
-	ps.SetMultiple(props);
-	WindowAccessor wa(window, ps);
-
-	//  Create and initialize WordList(s).
-	//  If you have an extremely large word file, or lots of styling rules you may want to speed
-	//  up processing by storing the wordlists instead of reprocessing them on each call.
-	int nWL = 0;
-	for (; words[nWL]; nWL++) ;	// count # of WordList PTRs needed
-	WordList** wl = new WordList* [nWL + 1];// alloc WordList PTRs
-	int i = 0;
-	for (; i < nWL; i++) {
-		wl[i] = new WordList();	// (works or THROWS bad_alloc EXCEPTION)
-		wl[i]->Set(words[i]);
-	}
-	wl[i] = 0;
-
+	// Create the accessor over the document text, properties only parsed again when they change.
+	lIface::DirectAccessor wa(window, inputs.properties(props), startPos, length);
 
 	// Set the currView handle to update at least once per lexer call.
 	npp_plugin::hCurrViewNeedsUpdate();
 
+	LexOrFold(foldOrLex, startPos, length, initStyle, words, wa);
+}
+
+//  Accessor entry point, used by the Scintilla entry point and by the lexer benchmark.
+void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
+                  char *words[], Accessor &wa)
+{
+
+	//  The WordList(s) are kept between calls and only rebuilt when a list's text changes.
+	WordList** wl = inputs.wordLists(words);
+	int nWL = inputs.wordListCount();
+
 
 	//  Call the internal folding and styling functions.
 	// foldOrLex is false for lex and true for fold
@@ -342,18 +362,29 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
 		//  multiline styles, or just put such logic in the Colour_Doc function itself.  Just
 		//  be sure to do it prior to creating your Style Context.
 
-		Colourise_Doc(startPos, length, initStyle, wl, wa);
+		//  This assumes that we have 3 keyword lists in conf.properties.  The identifier is
+		//  lowered before classifying so the lists are matched case sensitive.
+		std::string source;
+		for (int iList = 0; iList < 3 && iList < nWL; iList++) {
+			source.append(words[iList]);
+			source.push_back('\n');
+		}
+		if (kc_words.needsRebuild(source)) {
+			kc_words.clear(false);
+			if (nWL > 0) kc_words.addWords(words[0], sID::DIRECTIVE);
+			if (nWL > 1) kc_words.addWords(words[1], sID::PARAMETER);
+			if (nWL > 2) kc_words.addWords(words[2], sID::USERDEF);
+		}
+
+		//  Large ranges are split at line starts and styled on all processors.
+		if (!lIface::colouriseInParallel(wa, startPos, length, initStyle, wl, Colourise_Doc, SafeLineStart))
+			Colourise_Doc(startPos, length, initStyle, wl, wa);
 
 	}
 
 	//  The flush function is what actually finalizes settings the styles you just coloured.
 	wa.Flush();
 
-	// Clean up the wordlists before leaving.
-	for (i = nWL - 1; i >= 0; i--)
-		delete wl[i];
-	delete [] wl;
-
 }
 
 
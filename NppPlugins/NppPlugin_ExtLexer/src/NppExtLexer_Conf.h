@@ -103,6 +103,10 @@ const int USERDEF = 10;
 void LexOrFold(bool LexorFold, unsigned int startPos, int length, int initStyle,
                   char *words[], WindowID window, char *props);
 
+//  The same entry point working on any Accessor.
+void LexOrFold(bool LexorFold, unsigned int startPos, int length, int initStyle,
+                  char *words[], Accessor &styler);
+
 //  This is the menu dialog function item that shows up in the Notepad++ 'Plugins' menu under
 //  your lexer's name.
 void menuDlg();
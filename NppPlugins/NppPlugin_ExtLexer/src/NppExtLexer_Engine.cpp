@@ -0,0 +1,826 @@
+// NppExtLexer_Engine.cpp
+
+// This file is part of the Notepad++ External Lexers Plugin.
+// Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+//
+// This program is free software; you can redistribute it and/or modify it under the terms of
+// the GNU General Public License as published by the Free Software Foundation; either version
+// 2 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program;
+// if not, write to the Free Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+//                 Table Driven Lexers Described in the Plugin's XML File
+//                  for use with Notepad++ External Lexers Plugin
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+	/*
+	 *  See NppExtLexer_Engine.h for the description format.
+	 *
+	 *  The lexers are compiled and registered the first time Notepad++ asks for the plugin's
+	 *  lexers, which is after DllMain but before Notepad++ has handed over its handles, so the
+	 *  xml file is looked for in the Config folder next to the plugin rather than asked of
+	 *  Notepad++.  Description errors are kept until NPPN_READY and shown then.
+	 *
+	 */
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+//  Include Directives
+
+#include "NppExtLexer_Engine.h"		//  Provides the lexer specific definitions.
+
+//  <--- STL --->
+#include <algorithm>
+#include <bitset>
+#include <map>
+#include <fstream>
+#include <iterator>
+
+//  <--- Windows --->
+#include "Shlwapi.h"
+#pragma comment( lib, "Shlwapi.lib" )
+
+//  <--- Notepad++ --->
+#define TIXML_USE_STL
+#include "tinyxml.h"
+
+
+namespace NppExtLexer_Engine {
+
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+using npp_plugin::tstring;
+
+const int NB_STYLES = 32;				//  Styles Notepad++ reads per language.
+const int MAX_STATES = 256;				//  Next states are kept in a byte.
+const int TOKEN_BUFFER_SIZE = 128;		//  Longer keyword state runs are never classified.
+
+const char CACHE_MAGIC[4] = { 'N', 'X', 'L', 'E' };
+const int CACHE_VERSION = 1;
+
+//  A keyword list checked when a run of state ends.
+struct KeywordRule {
+	int state;
+	int list;							//  Index into the words Notepad++ passes.
+	int style;
+};
+
+struct CompiledLexer {
+	std::string name;
+	tstring description;
+	bool ignoreCase;
+	int nbStates;
+	std::vector<unsigned char> next;		//  nbStates rows of 256 next states.
+	std::vector<unsigned char> styleOf;		//  Style of each state.
+	std::vector<KeywordRule> keywordRules;	//  In precedence order.
+	std::vector<signed char> foldDelta;		//  NB_STYLES rows of 256 level changes, empty for none.
+
+	//  Not cached; set up by prepare() and built from the keyword lists on use.
+	std::vector<int> classifierOf;			//  Per state, -1 when it has no Keywords.
+	std::vector<lIface::KeywordClassifier> classifiers;
+};
+
+std::vector<CompiledLexer> lexers;
+lIface::LexerInputs inputs[MAX_LEXERS];
+
+
+//---------------------------------------------------------------------------------------------
+//  <--- Description Compiling --->
+
+//  One <Transition>.
+struct Rule {
+	std::bitset<256> chars;
+	int target;
+	bool inclusive;
+};
+
+struct StateDesc {
+	tstring name;
+	int style;
+	int elseState;						//  -1 to stay in the state.
+	std::vector<Rule> rules;
+};
+
+std::string narrow( const TCHAR* text )
+{
+	if ( text == NULL ) return ( std::string() );
+#ifdef UNICODE
+	int len = ::WideCharToMultiByte( CP_ACP, 0, text, -1, NULL, 0, NULL, NULL );
+	if ( len <= 1 ) return ( std::string() );
+	std::string result( len, '\0' );
+	::WideCharToMultiByte( CP_ACP, 0, text, -1, &result[0], len, NULL, NULL );
+	result.resize( len - 1 );
+	return ( result );
+#else
+	return ( std::string( text ) );
+#endif
+}
+
+tstring attribute( const TiXmlElement* element, const TCHAR* name )
+{
+	const TCHAR* value = element->Attribute( name );
+	return ( value ? tstring( value ) : tstring() );
+}
+
+//  Reads the next character of a chars spec, handling the escapes.
+int specChar( const std::string& spec, size_t& i )
+{
+	unsigned char ch = spec[i++];
+	if ( ( ch != '\\' ) || ( i >= spec.length() ) ) return ( ch );
+
+	ch = spec[i++];
+	switch ( ch ) {
+		case 't': return ( '\t' );
+		case 'r': return ( '\r' );
+		case 'n': return ( '\n' );
+		case 's': return ( ' ' );
+		default: return ( ch );
+	}
+}
+
+void addChars( const std::string& spec, std::bitset<256>& chars )
+{
+	size_t i = 0;
+	while ( i < spec.length() ) {
+		int first = specChar( spec, i );
+		int last = first;
+		if ( ( i + 1 < spec.length() ) && ( spec[i] == '-' ) ) {
+			i++;
+			last = specChar( spec, i );
+		}
+		for ( int ch = first; ch <= last; ch++ ) chars.set( ch );
+	}
+}
+
+bool styleAttribute( const TiXmlElement* element, int& style, tstring& error )
+{
+	tstring value = attribute( element, TEXT("style") );
+	style = _ttoi( value.c_str() );
+	if ( value.empty() || ( style < 0 ) || ( style >= NB_STYLES ) ) {
+		error = TEXT("A style from 0 to 31 is needed.");
+		return ( false );
+	}
+	return ( true );
+}
+
+//  Fills in the next states of state s.  Characters without a Transition stay, or take the
+//  row of the else state, which is filled in first.
+class RowBuilder {
+public:
+	RowBuilder( std::vector<StateDesc>& states, CompiledLexer& lexer )
+		:_states(states), _lexer(lexer), _done(states.size(), 0) {}
+
+	bool build( int s, tstring& error );
+	bool finishInclusive( tstring& error );
+
+private:
+	int inclusiveState( int s, int target );
+
+	std::vector<StateDesc>& _states;
+	CompiledLexer& _lexer;
+	std::vector<int> _done;					//  0 not started, 1 being built, 2 done.
+	std::map< std::pair<int, int>, int > _inclusive;
+};
+
+//  The state a character moves to when it stays in s's style but moves on to target.  It is
+//  styled as s and its row is target's.
+int RowBuilder::inclusiveState( int s, int target )
+{
+	std::pair<int, int> key( s, target );
+	std::map< std::pair<int, int>, int >::const_iterator found = _inclusive.find( key );
+	if ( found != _inclusive.end() ) return ( found->second );
+
+	int state = _lexer.nbStates++;
+	_inclusive[key] = state;
+	_lexer.styleOf.push_back( static_cast<unsigned char>( _states[s].style ) );
+	return ( state );
+}
+
+bool RowBuilder::build( int s, tstring& error )
+{
+	if ( _done[s] == 2 ) return ( true );
+	if ( _done[s] == 1 ) {
+		error = TEXT("The else states of '") + _states[s].name + TEXT("' lead back to it.");
+		return ( false );
+	}
+	_done[s] = 1;
+
+	StateDesc& state = _states[s];
+	std::vector<int> row( 256, -1 );
+	for ( size_t r = 0; r < state.rules.size(); r++ ) {
+		const Rule& rule = state.rules[r];
+		for ( int ch = 0; ch < 256; ch++ ) {
+			if ( ( row[ch] >= 0 ) || !rule.chars.test( ch ) ) continue;
+			row[ch] = rule.inclusive ? inclusiveState( s, rule.target ) : rule.target;
+		}
+	}
+
+	if ( state.elseState >= 0 && !build( state.elseState, error ) ) return ( false );
+
+	for ( int ch = 0; ch < 256; ch++ ) {
+		if ( row[ch] < 0 )
+			row[ch] = ( state.elseState < 0 ) ? ( s ) : ( _lexer.next[state.elseState * 256 + ch] );
+		_lexer.next[s * 256 + ch] = static_cast<unsigned char>( row[ch] );
+	}
+
+	_done[s] = 2;
+	return ( true );
+}
+
+//  Inclusive states are added while building, their rows are copied once all real rows are in.
+bool RowBuilder::finishInclusive( tstring& error )
+{
+	if ( _lexer.nbStates > MAX_STATES ) {
+		error = TEXT("There are too many states once inclusive transitions are added.");
+		return ( false );
+	}
+
+	_lexer.next.resize( _lexer.nbStates * 256 );
+	std::map< std::pair<int, int>, int >::const_iterator it = _inclusive.begin();
+	for ( ; it != _inclusive.end(); ++it ) {
+		int target = it->first.second;
+		std::copy( _lexer.next.begin() + target * 256, _lexer.next.begin() + ( target + 1 ) * 256,
+			_lexer.next.begin() + it->second * 256 );
+	}
+	return ( true );
+}
+
+bool compileLexer( const TiXmlElement* pLexer, CompiledLexer& lexer, tstring& error )
+{
+	tstring name = attribute( pLexer, TEXT("name") );
+	if ( name.empty() ) {
+		error = TEXT("A Lexer without a name was skipped.");
+		return ( false );
+	}
+	lexer.name = narrow( name.c_str() );
+	lexer.description = attribute( pLexer, TEXT("desc") );
+	if ( lexer.description.empty() ) lexer.description = name;
+	lexer.ignoreCase = ( attribute( pLexer, TEXT("ignoreCase") ) == TEXT("yes") );
+	error = name + TEXT(": ");
+
+	//  Character classes.
+	std::map< tstring, std::bitset<256> > classes;
+	const TiXmlElement* element = pLexer->FirstChildElement( TEXT("CharClass") );
+	for ( ; element; element = element->NextSiblingElement( TEXT("CharClass") ) )
+		addChars( narrow( element->Attribute( TEXT("chars") ) ), classes[attribute( element, TEXT("name") )] );
+
+	//  State names first so transitions can name states further down.
+	std::vector<StateDesc> states;
+	std::map<tstring, int> stateIDs;
+	element = pLexer->FirstChildElement( TEXT("State") );
+	for ( ; element; element = element->NextSiblingElement( TEXT("State") ) ) {
+		StateDesc state;
+		state.name = attribute( element, TEXT("name") );
+		if ( stateIDs.count( state.name ) ) {
+			error += TEXT("The state '") + state.name + TEXT("' is described twice.");
+			return ( false );
+		}
+		stateIDs[state.name] = states.size();
+		states.push_back( state );
+	}
+	if ( states.empty() || ( states.size() > MAX_STATES ) ) {
+		error += TEXT("From 1 to 256 states are needed.");
+		return ( false );
+	}
+
+	lexer.nbStates = states.size();
+	lexer.next.assign( lexer.nbStates * 256, 0 );
+	lexer.styleOf.clear();
+	lexer.keywordRules.clear();
+
+	element = pLexer->FirstChildElement( TEXT("State") );
+	for ( int s = 0; element; element = element->NextSiblingElement( TEXT("State") ), s++ ) {
+		StateDesc& state = states[s];
+		tstring stateError;
+		if ( !styleAttribute( element, state.style, stateError ) ) {
+			error += state.name + TEXT(": ") + stateError;
+			return ( false );
+		}
+		lexer.styleOf.push_back( static_cast<unsigned char>( state.style ) );
+
+		state.elseState = -1;
+		tstring elseName = attribute( element, TEXT("else") );
+		if ( !elseName.empty() ) {
+			if ( !stateIDs.count( elseName ) ) {
+				error += state.name + TEXT(": There is no else state '") + elseName + TEXT("'.");
+				return ( false );
+			}
+			state.elseState = stateIDs[elseName];
+		}
+
+		const TiXmlElement* pRule = element->FirstChildElement( TEXT("Transition") );
+		for ( ; pRule; pRule = pRule->NextSiblingElement( TEXT("Transition") ) ) {
+			Rule rule;
+			tstring target = attribute( pRule, TEXT("to") );
+			if ( !stateIDs.count( target ) ) {
+				error += state.name + TEXT(": There is no state '") + target + TEXT("' to go to.");
+				return ( false );
+			}
+			rule.target = stateIDs[target];
+			rule.inclusive = ( attribute( pRule, TEXT("inclusive") ) == TEXT("yes") );
+
+			tstring className = attribute( pRule, TEXT("class") );
+			if ( !className.empty() ) {
+				if ( !classes.count( className ) ) {
+					error += state.name + TEXT(": There is no CharClass '") + className + TEXT("'.");
+					return ( false );
+				}
+				rule.chars = classes[className];
+			}
+			addChars( narrow( pRule->Attribute( TEXT("chars") ) ), rule.chars );
+			state.rules.push_back( rule );
+		}
+
+		const TiXmlElement* pKeywords = element->FirstChildElement( TEXT("Keywords") );
+		for ( ; pKeywords; pKeywords = pKeywords->NextSiblingElement( TEXT("Keywords") ) ) {
+			KeywordRule keywordRule;
+			keywordRule.state = s;
+			keywordRule.list = _ttoi( attribute( pKeywords, TEXT("list") ).c_str() );
+			if ( !styleAttribute( pKeywords, keywordRule.style, stateError ) ) {
+				error += state.name + TEXT(" Keywords: ") + stateError;
+				return ( false );
+			}
+			lexer.keywordRules.push_back( keywordRule );
+		}
+	}
+
+	RowBuilder rows( states, lexer );
+	for ( int s = 0; s < int( states.size() ); s++ ) {
+		tstring rowError;
+		if ( !rows.build( s, rowError ) ) {
+			error += rowError;
+			return ( false );
+		}
+	}
+	tstring rowError;
+	if ( !rows.finishInclusive( rowError ) ) {
+		error += rowError;
+		return ( false );
+	}
+
+	//  Folding.
+	lexer.foldDelta.clear();
+	element = pLexer->FirstChildElement( TEXT("Fold") );
+	for ( ; element; element = element->NextSiblingElement( TEXT("Fold") ) ) {
+		int style;
+		tstring foldError;
+		if ( !styleAttribute( element, style, foldError ) ) {
+			error += TEXT("Fold: ") + foldError;
+			return ( false );
+		}
+		if ( lexer.foldDelta.empty() ) lexer.foldDelta.assign( NB_STYLES * 256, 0 );
+
+		std::bitset<256> open, close;
+		addChars( narrow( element->Attribute( TEXT("open") ) ), open );
+		addChars( narrow( element->Attribute( TEXT("close") ) ), close );
+		for ( int ch = 0; ch < 256; ch++ ) {
+			if ( open.test( ch ) ) lexer.foldDelta[style * 256 + ch] = 1;
+			else if ( close.test( ch ) ) lexer.foldDelta[style * 256 + ch] = -1;
+		}
+	}
+
+	error.clear();
+	return ( true );
+}
+
+//  Sets up the keyword classifiers, one for each state having Keywords.
+void prepare( CompiledLexer& lexer )
+{
+	lexer.classifierOf.assign( lexer.nbStates, -1 );
+	lexer.classifiers.clear();
+	for ( size_t r = 0; r < lexer.keywordRules.size(); r++ ) {
+		int& classifier = lexer.classifierOf[lexer.keywordRules[r].state];
+		if ( classifier >= 0 ) continue;
+		classifier = lexer.classifiers.size();
+		lexer.classifiers.push_back( lIface::KeywordClassifier( lexer.ignoreCase ) );
+	}
+}
+
+//  What was wrong with the Lexer descriptions, kept for showErrors; the rest still get
+//  registered.
+std::vector<tstring> errors;
+
+void reportError( const tstring& error )
+{
+	errors.push_back( error );
+}
+
+bool compileAll( const tstring& xmlPath )
+{
+	TiXmlDocument doc( xmlPath.c_str() );
+	if ( !doc.LoadFile() ) return ( false );
+
+	TiXmlNode* root = doc.FirstChild( TEXT("NotepadPlus") );
+	if ( !root ) return ( false );
+	TiXmlElement* engineRoot = root->FirstChildElement( TEXT("EngineLexers") );
+	if ( !engineRoot ) return ( true );
+
+	const TiXmlElement* pLexer = engineRoot->FirstChildElement( TEXT("Lexer") );
+	for ( ; pLexer; pLexer = pLexer->NextSiblingElement( TEXT("Lexer") ) ) {
+		if ( lexers.size() == MAX_LEXERS ) {
+			reportError( TEXT("Only the first eight engine lexers are registered.") );
+			break;
+		}
+		CompiledLexer lexer;
+		tstring error;
+		if ( compileLexer( pLexer, lexer, error ) ) lexers.push_back( lexer );
+		else reportError( error );
+	}
+	return ( true );
+}
+
+
+//---------------------------------------------------------------------------------------------
+//  <--- Disk Cache --->
+
+//  FNV-1a hash of the xml file, the cache is only used for the same bytes.
+ULONGLONG hashBytes( const std::string& bytes )
+{
+	ULONGLONG hash = 14695981039346656037ULL;
+	for ( size_t i = 0; i < bytes.length(); i++ ) {
+		hash ^= static_cast<unsigned char>( bytes[i] );
+		hash *= 1099511628211ULL;
+	}
+	return ( hash );
+}
+
+//  <module dir>\Config\<module base name><extension>
+tstring configPath( const TCHAR* extension )
+{
+	TCHAR path[MAX_PATH];
+	::GetModuleFileName( static_cast<HMODULE>( npp_plugin::hModule() ), path, MAX_PATH );
+	PathRemoveFileSpec( path );
+	PathAppend( path, TEXT("Config") );
+	PathAppend( path, npp_plugin::getModuleBaseName()->c_str() );
+	PathAddExtension( path, extension );
+	return ( tstring( path ) );
+}
+
+bool readFile( const tstring& path, std::string& bytes )
+{
+	std::ifstream in( path.c_str(), std::ios::in | std::ios::binary );
+	if ( !in ) return ( false );
+	bytes.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+	return ( true );
+}
+
+template <typename T>
+void writeValue( std::ostream& out, const T& value )
+{
+	out.write( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+}
+
+template <typename T>
+bool readValue( std::istream& in, T& value )
+{
+	in.read( reinterpret_cast<char*>( &value ), sizeof( T ) );
+	return ( in.good() );
+}
+
+//  Strings and vectors are written as a count followed by their elements.
+template <typename T>
+void writeVector( std::ostream& out, const T& items )
+{
+	writeValue( out, int( items.size() ) );
+	if ( !items.empty() ) out.write( reinterpret_cast<const char*>( &items[0] ), items.size() * sizeof( items[0] ) );
+}
+
+template <typename T>
+bool readVector( std::istream& in, T& items, int maxCount )
+{
+	int count;
+	if ( !readValue( in, count ) || ( count < 0 ) || ( count > maxCount ) ) return ( false );
+	items.resize( count );
+	if ( count > 0 ) in.read( reinterpret_cast<char*>( &items[0] ), count * sizeof( items[0] ) );
+	return ( in.good() );
+}
+
+void saveCache( const tstring& path, ULONGLONG sourceHash )
+{
+	std::ofstream out( path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if ( !out ) return;
+
+	out.write( CACHE_MAGIC, sizeof( CACHE_MAGIC ) );
+	writeValue( out, CACHE_VERSION );
+	writeValue( out, int( sizeof( TCHAR ) ) );
+	writeValue( out, sourceHash );
+	writeValue( out, int( lexers.size() ) );
+
+	for ( size_t i = 0; i < lexers.size(); i++ ) {
+		const CompiledLexer& lexer = lexers[i];
+		writeVector( out, lexer.name );
+		writeVector( out, lexer.description );
+		writeValue( out, lexer.ignoreCase );
+		writeValue( out, lexer.nbStates );
+		writeVector( out, lexer.next );
+		writeVector( out, lexer.styleOf );
+		writeVector( out, lexer.keywordRules );
+		writeVector( out, lexer.foldDelta );
+	}
+}
+
+//  Returns false, leaving no lexers, unless the whole cache was written for sourceHash.
+bool loadCache( const tstring& path, ULONGLONG sourceHash )
+{
+	std::ifstream in( path.c_str(), std::ios::in | std::ios::binary );
+	if ( !in ) return ( false );
+
+	char magic[sizeof( CACHE_MAGIC )];
+	int version, charSize, nbLexers;
+	ULONGLONG hash;
+	in.read( magic, sizeof( magic ) );
+	if ( !in.good() || ( ::memcmp( magic, CACHE_MAGIC, sizeof( magic ) ) != 0 ) ) return ( false );
+	if ( !readValue( in, version ) || ( version != CACHE_VERSION ) ) return ( false );
+	if ( !readValue( in, charSize ) || ( charSize != sizeof( TCHAR ) ) ) return ( false );
+	if ( !readValue( in, hash ) || ( hash != sourceHash ) ) return ( false );
+	if ( !readValue( in, nbLexers ) || ( nbLexers < 0 ) || ( nbLexers > MAX_LEXERS ) ) return ( false );
+
+	std::vector<CompiledLexer> loaded( nbLexers );
+	for ( int i = 0; i < nbLexers; i++ ) {
+		CompiledLexer& lexer = loaded[i];
+		if ( !readVector( in, lexer.name, MAX_PATH ) ||
+				!readVector( in, lexer.description, MAX_PATH ) ||
+				!readValue( in, lexer.ignoreCase ) ||
+				!readValue( in, lexer.nbStates ) ||
+				( lexer.nbStates < 1 ) || ( lexer.nbStates > MAX_STATES ) ||
+				!readVector( in, lexer.next, MAX_STATES * 256 ) ||
+				!readVector( in, lexer.styleOf, MAX_STATES ) ||
+				!readVector( in, lexer.keywordRules, MAX_STATES * 256 ) ||
+				!readVector( in, lexer.foldDelta, NB_STYLES * 256 ) )
+			return ( false );
+
+		//  Anything that would index outside the tables means the file isn't ours.
+		if ( ( int( lexer.next.size() ) != lexer.nbStates * 256 ) ||
+				( int( lexer.styleOf.size() ) != lexer.nbStates ) ||
+				( !lexer.foldDelta.empty() && ( lexer.foldDelta.size() != NB_STYLES * 256 ) ) )
+			return ( false );
+		for ( size_t n = 0; n < lexer.next.size(); n++ )
+			if ( lexer.next[n] >= lexer.nbStates ) return ( false );
+		for ( size_t r = 0; r < lexer.keywordRules.size(); r++ )
+			if ( ( lexer.keywordRules[r].state < 0 ) || ( lexer.keywordRules[r].state >= lexer.nbStates ) )
+				return ( false );
+	}
+
+	lexers.swap( loaded );
+	return ( true );
+}
+
+
+//---------------------------------------------------------------------------------------------
+//  <--- Lexing --->
+
+//  Styles [runStart, end) as state, or as the keyword list holding the run.
+inline void colourRun( CompiledLexer& lexer, Accessor& styler, lIface::TextSnapshot& text,
+		int runStart, int end, int state )
+{
+	if ( end <= runStart ) return;
+
+	int style = lexer.styleOf[state];
+	int classifier = lexer.classifierOf[state];
+	if ( ( classifier >= 0 ) && ( end - runStart < TOKEN_BUFFER_SIZE ) ) {
+		char token[TOKEN_BUFFER_SIZE];
+		int length = end - runStart;
+		for ( int i = 0; i < length; i++ ) token[i] = text.charAt( runStart + i, end );
+		token[length] = '\0';
+
+		int wordStyle = lexer.classifiers[classifier].classify( token );
+		if ( wordStyle != lIface::KeywordClassifier::NO_MATCH ) style = wordStyle;
+	}
+	styler.ColourTo( end - 1, style );
+}
+
+void Colourise_Doc( CompiledLexer& lexer, unsigned int startPos, int length, Accessor& styler )
+{
+	int endPos = startPos + length;
+
+	//  Start from the beginning of the line, in the state the line before ended in.
+	int line = styler.GetLine( startPos );
+	int pos = styler.LineStart( line );
+	int state = ( line > 0 ) ? ( styler.GetLineState( line - 1 ) ) : ( 0 );
+	if ( ( state < 0 ) || ( state >= lexer.nbStates ) ) state = 0;
+
+	lIface::TextSnapshot text( styler );
+	const unsigned char* next = &lexer.next[0];
+
+	styler.StartAt( pos );
+	styler.StartSegment( pos );
+	int runStart = pos;
+	for ( ; pos < endPos; pos++ ) {
+		unsigned char ch = text.charAt( pos, endPos );
+		int nextState = next[state * 256 + ch];
+		if ( nextState != state ) {
+			colourRun( lexer, styler, text, runStart, pos, state );
+			runStart = pos;
+			state = nextState;
+		}
+		if ( ( ch == '\n' ) || ( ( ch == '\r' ) && ( text.charAt( pos + 1, endPos ) != '\n' ) ) )
+			styler.SetLineState( line++, state );
+	}
+	colourRun( lexer, styler, text, runStart, endPos, state );
+}
+
+void Fold_Doc( const CompiledLexer& lexer, unsigned int startPos, int length, Accessor& styler )
+{
+	bool foldCompact = styler.GetPropertyInt( "fold.compact", 1 ) != 0;
+	unsigned int endPos = startPos + length;
+	int visibleChars = 0;
+	int lineCurrent = styler.GetLine( startPos );
+	int levelPrev = styler.LevelAt( lineCurrent ) & SC_FOLDLEVELNUMBERMASK;
+	int levelCurrent = levelPrev;
+	const signed char* foldDelta = lexer.foldDelta.empty() ? NULL : &lexer.foldDelta[0];
+	lIface::TextSnapshot text( styler );
+	char chNext = text.charAt( startPos, endPos );
+
+	for ( unsigned int i = startPos; i < endPos; i++ ) {
+		char ch = chNext;
+		chNext = text.charAt( i + 1, endPos );
+		bool atEOL = ( ch == '\r' && chNext != '\n' ) || ( ch == '\n' );
+
+		if ( foldDelta ) {
+			int style = styler.StyleAt( i ) & ( NB_STYLES - 1 );
+			levelCurrent += foldDelta[style * 256 + static_cast<unsigned char>( ch )];
+		}
+		if ( atEOL ) {
+			int lev = levelPrev;
+			if ( visibleChars == 0 && foldCompact )
+				lev |= SC_FOLDLEVELWHITEFLAG;
+			if ( ( levelCurrent > levelPrev ) && ( visibleChars > 0 ) )
+				lev |= SC_FOLDLEVELHEADERFLAG;
+			if ( lev != styler.LevelAt( lineCurrent ) )
+				styler.SetLevel( lineCurrent, lev );
+			lineCurrent++;
+			levelPrev = levelCurrent;
+			visibleChars = 0;
+		}
+		if ( !isspacechar( ch ) )
+			visibleChars++;
+	}
+	// Fill in the real level of the next line, keeping the current flags as they will be filled in later
+	int flagsNext = styler.LevelAt( lineCurrent ) & ~SC_FOLDLEVELNUMBERMASK;
+	styler.SetLevel( lineCurrent, levelPrev | flagsNext );
+}
+
+//  Rebuilds a classifier only when the lists it is made from change.
+void updateClassifiers( CompiledLexer& lexer, char* words[] )
+{
+	int nbLists = 0;
+	while ( words[nbLists] ) nbLists++;
+
+	for ( int s = 0; s < lexer.nbStates; s++ ) {
+		int classifier = lexer.classifierOf[s];
+		if ( classifier < 0 ) continue;
+
+		std::string source;
+		for ( size_t r = 0; r < lexer.keywordRules.size(); r++ ) {
+			const KeywordRule& rule = lexer.keywordRules[r];
+			if ( ( rule.state != s ) || ( rule.list < 0 ) || ( rule.list >= nbLists ) ) continue;
+			source.append( words[rule.list] );
+			source.push_back( '\n' );
+		}
+
+		lIface::KeywordClassifier& kc = lexer.classifiers[classifier];
+		if ( !kc.needsRebuild( source ) ) continue;
+
+		kc.clear( lexer.ignoreCase );
+		for ( size_t r = 0; r < lexer.keywordRules.size(); r++ ) {
+			const KeywordRule& rule = lexer.keywordRules[r];
+			if ( ( rule.state != s ) || ( rule.list < 0 ) || ( rule.list >= nbLists ) ) continue;
+			kc.addWords( words[rule.list], rule.style );
+		}
+	}
+}
+
+void lexOrFold( int slot, bool foldOrLex, unsigned int startPos, int length, int initStyle,
+		char* words[], Accessor& wa )
+{
+	CompiledLexer& lexer = lexers[slot];
+
+	// foldOrLex is false for lex and true for fold
+	if ( foldOrLex ) {
+
+		// This is a nice helpful routine to back up a line to fix broken folds.
+		int lineCurrent = wa.GetLine( startPos );
+		if ( lineCurrent > 0 ) {
+			lineCurrent--;
+			int newStartPos = wa.LineStart( lineCurrent );
+			length += startPos - newStartPos;
+			startPos = newStartPos;
+		}
+
+		Fold_Doc( lexer, startPos, length, wa );
+
+	}
+	else {
+		updateClassifiers( lexer, words );
+		Colourise_Doc( lexer, startPos, length, wa );
+	}
+
+	//  The flush function is what actually finalizes settings the styles you just coloured.
+	wa.Flush();
+}
+
+void menuDlg( int slot )
+{
+	tstring text = lexers[slot].description;
+	text.append( TEXT("\r\n\r\nThis lexer is described in the plugin's xml file and run by the lexer engine.") );
+	::MessageBox( npp_plugin::hNpp(), text.c_str(), TEXT("N++ External Engine Lexer"), MB_OK );
+}
+
+
+//---------------------------------------------------------------------------------------------
+//  <--- Entry Points --->
+
+//  Notepad++ tells the entry points apart only by their address, so each slot gets its own.
+template <int SLOT>
+void slotLexOrFold( bool foldOrLex, unsigned int startPos, int length, int initStyle,
+		char* words[], WindowID window, char* props )
+{
+	// Create the accessor over the document text, properties only parsed again when they change.
+	lIface::DirectAccessor wa( window, inputs[SLOT].properties( props ), startPos, length );
+
+	// Set the currView handle to update at least once per lexer call.
+	npp_plugin::hCurrViewNeedsUpdate();
+
+	lexOrFold( SLOT, foldOrLex, startPos, length, initStyle, words, wa );
+}
+
+template <int SLOT>
+void slotLexOrFoldAccessor( bool foldOrLex, unsigned int startPos, int length, int initStyle,
+		char* words[], Accessor& wa )
+{
+	lexOrFold( SLOT, foldOrLex, startPos, length, initStyle, words, wa );
+}
+
+template <int SLOT>
+void slotMenuDlg() { menuDlg( SLOT ); }
+
+const NppExtLexerFunction slotLexOrFolds[MAX_LEXERS] = {
+	slotLexOrFold<0>, slotLexOrFold<1>, slotLexOrFold<2>, slotLexOrFold<3>,
+	slotLexOrFold<4>, slotLexOrFold<5>, slotLexOrFold<6>, slotLexOrFold<7>
+};
+
+const NppExtLexerAccessorFunction slotLexOrFoldAccessors[MAX_LEXERS] = {
+	slotLexOrFoldAccessor<0>, slotLexOrFoldAccessor<1>, slotLexOrFoldAccessor<2>, slotLexOrFoldAccessor<3>,
+	slotLexOrFoldAccessor<4>, slotLexOrFoldAccessor<5>, slotLexOrFoldAccessor<6>, slotLexOrFoldAccessor<7>
+};
+
+const PFUNCPLUGINCMD slotMenuDlgs[MAX_LEXERS] = {
+	slotMenuDlg<0>, slotMenuDlg<1>, slotMenuDlg<2>, slotMenuDlg<3>,
+	slotMenuDlg<4>, slotMenuDlg<5>, slotMenuDlg<6>, slotMenuDlg<7>
+};
+
+}  // End: Un-named namespace
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+//  Entry Point Functions.
+
+void initLexers()
+{
+	tstring xmlPath = configPath( TEXT(".xml") );
+	tstring cachePath = configPath( TEXT(".engine.cache") );
+
+	std::string xmlBytes;
+	if ( !readFile( xmlPath, xmlBytes ) ) return;
+	ULONGLONG sourceHash = hashBytes( xmlBytes );
+
+	if ( !loadCache( cachePath, sourceHash ) ) {
+		lexers.clear();
+		if ( !compileAll( xmlPath ) ) return;
+
+		//  A cache holds only the lexers that compiled, so with any description in error the
+		//  next start compiles again and reports it again.
+		if ( errors.empty() ) saveCache( cachePath, sourceHash );
+	}
+
+	for ( size_t i = 0; i < lexers.size(); i++ ) {
+		prepare( lexers[i] );
+		lIface::initLexer( lexers[i].name, lexers[i].description,
+			slotLexOrFolds[i], slotMenuDlgs[i], slotLexOrFoldAccessors[i] );
+	}
+}
+
+void showErrors()
+{
+	if ( errors.empty() ) return;
+
+	tstring text;
+	for ( size_t i = 0; i < errors.size(); i++ ) {
+		if ( i > 0 ) text.append( TEXT("\n\n") );
+		text.append( errors[i] );
+	}
+	errors.clear();
+
+	::MessageBox( npp_plugin::hNpp(), text.c_str(), TEXT("Engine Lexer Description Error"),
+		MB_ICONERROR );
+}
+
+}  //  End:  namespace NppExtLexer_Engine.
@@ -0,0 +1,110 @@
+#ifndef NPPEXTLEXER_ENGINE_H
+#define NPPEXTLEXER_ENGINE_H
+
+// NppExtLexer_Engine.h
+
+// This file is part of the Notepad++ External Lexers Plugin.
+// Copyright 2008 - 2009 Thell Fowler (thell@almostautomated.com)
+//
+// This program is free software; you can redistribute it and/or modify it under the terms of
+// the GNU General Public License as published by the Free Software Foundation; either version
+// 2 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with this program;
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+//                 Table Driven Lexers Described in the Plugin's XML File
+//                  for use with Notepad++ External Lexers Plugin
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+	/***
+	 *
+	 *  Instead of a hand written state machine, a language can be described in the plugin's
+	 *  xml file under <NotepadPlus><EngineLexers>.  Each <Lexer> is compiled into a table with
+	 *  one row of 256 next states per state, and Colourise_Doc is a single loop looking up the
+	 *  next state of every character.
+	 *
+	 *    <Lexer name="Ini*" desc="Ini File. *Ext" ignoreCase="yes">
+	 *        <CharClass name="word" chars="a-zA-Z0-9_." />
+	 *        <State name="default" style="0">
+	 *            <Transition chars=";#" to="comment" />
+	 *            <Transition class="word" to="key" />
+	 *        </State>
+	 *        <State name="comment" style="1">
+	 *            <Transition chars="\r\n" to="default" />
+	 *        </State>
+	 *        <State name="key" style="2" else="default">
+	 *            <Keywords list="0" style="3" />
+	 *        </State>
+	 *        <Fold style="4" open="[" close="]" />
+	 *    </Lexer>
+	 *
+	 *    > The first state is the one a document starts in.  A character takes the style of
+	 *      the state it leads to, so the '#' above is a comment.
+	 *
+	 *    > chars takes ranges ( a-z ) and the escapes \t \r \n \s ( space ) \- and \\.  The
+	 *      first Transition that has a character wins.
+	 *
+	 *    > inclusive="yes" keeps the character in the current state's style and only moves
+	 *      on after it, for things like a closing quote.
+	 *
+	 *    > A character without a Transition stays in the state, or with else="name" does
+	 *      whatever that state does with it.  So the key above ends at the first non word
+	 *      character, which is then handled as in default.
+	 *
+	 *    > Each run of a state with Keywords is looked up in the Notepad++ keyword lists given,
+	 *      in order, and takes the style of the first list holding it.  The lists follow the
+	 *      WordList rules, a word starting with '^' matches the beginning of runs.
+	 *
+	 *    > Fold raises the fold level at each open and lowers it at each close character
+	 *      having the given style.
+	 *
+	 *  The state at the end of every line is kept as the line state, so lexing can start at
+	 *  any line.  The compiled tables are cached next to the xml file and only compiled again
+	 *  when the xml file changes.
+	 *
+	 *  Each lexer also needs its <Language> and <LexerType> entries like any other.
+	 *
+	 ***/
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+//  Include Directives
+
+#include "NppPlugin.h"				//  Provides all of the interface, messaging definitions,
+									//  and namespace aliases.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+// Language Specific definitions
+
+namespace NppExtLexer_Engine {
+
+//*********************************************************************************************
+//  Global ( within the namespace ) constants.
+
+//  Each lexer needs an entry point of its own, these are how many there are.
+const int MAX_LEXERS = 8;
+
+
+//*********************************************************************************************
+//  Lexer Function Delarations.
+
+//---------------------------------------------------------------------------------------------
+//  Generic Externally called functions.
+
+//  Compiles ( or loads from the cache ) the xml file's engine lexers and registers each with
+//  lIface::initLexer.  Handed to lIface::initLexersLater by the ExtLexer_Plugin's DLLMAIN
+//  routine, since reading and compiling the xml file isn't safe under the loader lock.
+void initLexers();
+
+//  Shows the description errors initLexers ran into.  Called on NPPN_READY.
+void showErrors();
+
+
+}  //  End:  namespace NppExtLexer_Engine.
+
+#endif  //  End: Include guard.
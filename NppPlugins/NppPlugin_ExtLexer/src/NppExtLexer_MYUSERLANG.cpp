@@ -84,166 +84,112 @@ const char EOString = '\0';
 const char EOLine = '\n';
 const char EOWord = ' ';
 */
-static bool isInOpList(WordList & opList, char op)
-{
-	for (int i = 0 ; i < opList.len ; i++)
-		if (op == *(opList.words[i]))
-			return true;
-	return false;
-}
-
-static int cmpString(const void *a1, const void *a2) {
-	// Can't work out the correct incantation to use modern casts here
-	return strcmp(*(char**)(a1), *(char**)(a2));
-}
-
 static int cmpStringNoCase(const void *a1, const void *a2) {
 	// Can't work out the correct incantation to use modern casts here
 	return CompareCaseInsensitive(*(char**)(a1), *(char**)(a2));
 }
 
 
-static bool isInList(WordList & list, const char *s, bool specialMode, bool ignoreCase) 
+/*
+static void getRange(unsigned int start, unsigned int end, Accessor &styler, char *s, unsigned int len) 
 {
-	if (!list.words)
-		return false;
+	unsigned int i = 0;
+	while ((i < end - start + 1) && (i < len-1)) 
+	{
+		s[i] = static_cast<char>(styler[start + i]);
+		i++;
+	}
+	s[i] = '\0';
+}
+*/
+//  The keyword groups, block words, and comment symbols in the order Colourise_Doc tries
+//  them.  Rebuilt whenever the lists or the case and prefix settings change.
+static lIface::KeywordClassifier kc_words;
+static unsigned int kc_listsVersion = 0;		//  inputs.listsVersion() kc_words was built from.
+static int kc_settings = -1;					//  Settings bits kc_words was built with.
+
+//  The properties and WordLists Notepad++ passes, kept until their text changes.
+static lIface::LexerInputs inputs;
+
+//  Per character lookups compiled from the delimiter, symbol, and comment lists alongside
+//  kc_words, so Colourise_Doc never walks a list while stepping through the document.
+struct LanguageProfile {
+	bool isOperator[256];				//  First character of a symbols word.
+	int delimOpenStyle[256];			//  DELIMITER1 - DELIMITER3, or DEFAULT for none.
+	int delimClose[3];					//  Closing character per delimiter, -1 for none.
+	std::string commentClose;			//  The '2' prefixed comment word, without the prefix.
+};
+
+static LanguageProfile langProfile;
+
+static void compileProfile(WordList &keywords, WordList &symbols, WordList &comments)
+{
+	memset(langProfile.isOperator, 0, sizeof(langProfile.isOperator));
+	for (int i = 0 ; i < 256 ; i++)
+		langProfile.delimOpenStyle[i] = sID::DEFAULT;
+	for (int i = 0 ; i < 3 ; i++)
+		langProfile.delimClose[i] = -1;
+	langProfile.commentClose.clear();
+
+	for (int i = 0 ; i < symbols.len ; i++)
+		langProfile.isOperator[static_cast<unsigned char>(symbols.words[i][0])] = true;
 
-	if (!list.sorted) 
+	//  The first keyword holds the three opening then the three closing delimiters, '0'
+	//  marking an unused one.  No delimiter opens unless the first opener is set, none closes
+	//  unless the first closer is set, and the lower numbered delimiter wins a shared opener.
+	const char *delims = keywords.words[0];
+	if (delims[0] != '0')
 	{
-		list.sorted = true;
-		qsort(reinterpret_cast<void*>(list.words), list.len, sizeof(*list.words), cmpString);
-
-		for (unsigned int k = 0; k < (sizeof(list.starts) / sizeof(list.starts[0])); k++)
-			list.starts[k] = -1;
-		for (int l = list.len - 1; l >= 0; l--) {
-			unsigned char indexChar = list.words[l][0];
-			list.starts[indexChar] = l;
+		for (int i = 2 ; i >= 0 ; i--)
+		{
+			if (delims[i] != '0' && delims[i] != '\0')
+				langProfile.delimOpenStyle[static_cast<unsigned char>(delims[i])] = sID::DELIMITER1 + i;
 		}
 	}
-	unsigned char firstChar = s[0];
-	int j = list.starts[firstChar];
-
-	if (j >= 0)
+	if (delims[3] != '0')
 	{
-		while ((ignoreCase?toupper(list.words[j][0]):list.words[j][0]) == (ignoreCase?toupper(s[0]):s[0]))
+		for (int i = 0 ; i < 3 ; i++)
 		{
-			if (!list.words[j][1])
-			{
-				if (specialMode)
-				{
-					return true;
-				}
-				else
-				{
-					if (!s[1])
-						return true;
-				}
-			}
-			int a1 = ignoreCase?toupper(list.words[j][1]):list.words[j][1];
-			int b1 = ignoreCase?toupper(s[1]):s[1];
-			if (a1 == b1) 
-			{
-				
-				const char *a = list.words[j] + 1;
-				int An = ignoreCase?toupper((int)*a):(int)*a;
-				
-				const char *b = s + 1;
-				int Bn = ignoreCase?toupper((int)*b):(int)*b;
-
-				
-				while (An && (An == Bn))
-				{
-					a++;
-					An = ignoreCase?toupper((int)*a):(int)*a;
-					b++;
-					Bn = ignoreCase?toupper((int)*b):(int)*b;
-				}
-				if (specialMode)
-				{
-					if (!An)
-						return true;
-				}
-				else
-				{
-					if (!An && !Bn)
-						return true;
-				}
-			}
-			j++;
+			if (delims[i+3] != '0' && delims[i+3] != '\0')
+				langProfile.delimClose[i] = static_cast<unsigned char>(delims[i+3]);
 		}
 	}
 
-	if (ignoreCase)
+	for (int i = 0 ; i < comments.len ; i++)
 	{
-		// if the 1st char is not a letter, no need to test one more time
-		if (!isalpha(s[0]))
-			return false;
-
-		firstChar = isupper(s[0])?tolower(s[0]):toupper(s[0]);
-		j = list.starts[firstChar];
-		if (j >= 0) 
+		if (comments.words[i][0] == '2')
 		{
-			while (toupper(list.words[j][0]) == toupper(s[0])) 
-			{
-				if (!list.words[j][1])
-				{
-					if (specialMode)
-					{
-						return true;
-					}
-					else
-					{
-						if (!s[1])
-							return true;
-					}
-				}
-				int a1 = toupper(list.words[j][1]);
-				int b1 = toupper(s[1]);
-				if (a1 == b1) 
-				{
-					const char *a = list.words[j] + 1;
-					int An = toupper((int)*a);
-
-					const char *b = s + 1;
-					int Bn = toupper((int)*b);
-
-					while (An && (An == Bn))
-					{
-						a++;
-						An = toupper((int)*a);
-						b++;
-						Bn = toupper((int)*b);
-					}
-					if (specialMode)
-					{
-						if (!*a)
-							return true;
-					}
-					else
-					{
-						if (!*a && !*b)
-							return true;
-					}
-				}
-				j++;
-			}
+			langProfile.commentClose = comments.words[i] + 1;
+			break;
 		}
 	}
+}
 
-	return false;
+static void addWordList(WordList &list, int style, bool prefixMode)
+{
+	for (int i = 0 ; i < list.len ; i++)
+		kc_words.addWord(list.words[i], style,
+			prefixMode ? lIface::KeywordClassifier::MATCH_PREFIX : lIface::KeywordClassifier::MATCH_WORD);
 }
-/*
-static void getRange(unsigned int start, unsigned int end, Accessor &styler, char *s, unsigned int len) 
+
+//  Comment words carry a leading '0' for line comments, '1' for comment open and '2' for
+//  comment close; only the first two start a comment from an identifier.
+static void addCommentWords(WordList &comments, bool isCommentLineSymbol, bool isCommentSymbol)
 {
-	unsigned int i = 0;
-	while ((i < end - start + 1) && (i < len-1)) 
+	for (int i = 0 ; i < comments.len ; i++)
 	{
-		s[i] = static_cast<char>(styler[start + i]);
-		i++;
+		if (comments.words[i][0] == '0')
+			kc_words.addWord(comments.words[i] + 1, sID::COMMENTLINE,
+				isCommentLineSymbol ? lIface::KeywordClassifier::MATCH_PREFIX : lIface::KeywordClassifier::MATCH_WORD);
+	}
+	for (int i = 0 ; i < comments.len ; i++)
+	{
+		if (comments.words[i][0] == '1')
+			kc_words.addWord(comments.words[i] + 1, sID::COMMENT,
+				isCommentSymbol ? lIface::KeywordClassifier::MATCH_PREFIX : lIface::KeywordClassifier::MATCH_WORD);
 	}
-	s[i] = '\0';
 }
-*/
+
 static inline bool isAWordChar(const int ch) {
 	//return (ch < 0x80) && (isalnum(ch) || ch == '.' || ch == '_');
 	return ((ch > 0x20) && (ch <= 0xFF) && (ch != ' ') && (ch != '\n'));
@@ -280,16 +226,35 @@ static void Colourise_Doc(unsigned int startPos, int length, int initStyle, Word
 	bool doPrefix4G2 = styler.GetPropertyInt("userDefine.g2Prefix", 0) != 0;
 	bool doPrefix4G3 = styler.GetPropertyInt("userDefine.g3Prefix", 0) != 0;
 	bool doPrefix4G4 = styler.GetPropertyInt("userDefine.g4Prefix", 0) != 0;
-	
-	char delimOpen[3];
-	char delimClose[3];
 
-	for (int i = 0 ; i < 3 ; i++)
+	//  The lists are only compared through the version LexerInputs keeps, so an unchanged
+	//  call costs the seven settings instead of a walk over every word.
+	int settings = (isCaseIgnored ? 1 : 0) | (isCommentLineSymbol ? 2 : 0) | (isCommentSymbol ? 4 : 0) |
+		(doPrefix4G1 ? 8 : 0) | (doPrefix4G2 ? 16 : 0) | (doPrefix4G3 ? 32 : 0) | (doPrefix4G4 ? 64 : 0);
+
+	if (settings != kc_settings || inputs.listsVersion() != kc_listsVersion)
 	{
-		delimOpen[i] = keywords.words[0][i] == '0'?'\0':keywords.words[0][i];
-		delimClose[i] = keywords.words[0][i+3] == '0'?'\0':keywords.words[0][i+3];
+		kc_settings = settings;
+		kc_listsVersion = inputs.listsVersion();
+
+		compileProfile(keywords, symbols, comments);
+
+		kc_words.clear(isCaseIgnored);
+		addWordList(keywords5, sID::WORD1, doPrefix4G1);
+		addWordList(keywords6, sID::WORD2, doPrefix4G2);
+		addWordList(keywords7, sID::WORD3, doPrefix4G3);
+		addWordList(keywords8, sID::WORD4, doPrefix4G4);
+		addWordList(blockOpenWords, sID::BLOCK_OPERATOR_OPEN, false);
+		addWordList(blockCloseWords, sID::BLOCK_OPERATOR_CLOSE, false);
+		addCommentWords(comments, isCommentLineSymbol, isCommentSymbol);
 	}
 
+	const bool *isOperator = langProfile.isOperator;
+	const int *delimOpenStyle = langProfile.delimOpenStyle;
+	const int *delimClose = langProfile.delimClose;
+	const char *pCommentClose = langProfile.commentClose.c_str();
+	const int commentCloseLen = static_cast<int>(langProfile.commentClose.length());
+
 	StyleContext sc(startPos, length, initStyle, styler);
 
 	for (; sc.More(); sc.Forward()) 
@@ -307,28 +272,28 @@ static void Colourise_Doc(unsigned int startPos, int length, int initStyle, Word
 
 			case sID::DELIMITER1 :
 			{
-				if (delimClose[0] && (sc.ch == delimClose[0]))
+				if (sc.ch == delimClose[0])
 					sc.ForwardSetState(sID::DEFAULT);
 				break;
 			}
 
 			case sID::DELIMITER2 :
 			{
-				if (delimClose[0] && (sc.ch == delimClose[1]))
+				if (sc.ch == delimClose[1])
 					sc.ForwardSetState(sID::DEFAULT);
 				break;
 			}
 
 			case sID::DELIMITER3 :
 			{
-				if (delimClose[0] && (sc.ch == delimClose[2]))
+				if (sc.ch == delimClose[2])
 					sc.ForwardSetState(sID::DEFAULT);
 				break;
 			}
 			
 			case sID::IDENTIFIER : 
 			{
-				bool isSymbol = isInOpList(symbols, sc.ch);
+				bool isSymbol = isOperator[sc.ch & 0xFF];
 
 				if (!isAWordChar(sc.ch)  || isSymbol)
 				{
@@ -336,37 +301,14 @@ static void Colourise_Doc(unsigned int startPos, int length, int initStyle, Word
 					const int tokenLen = 100;
 					char s[tokenLen];
 					sc.GetCurrent(s, sizeof(s));
-					char commentLineStr[tokenLen+10] = "0";
-					char *p = commentLineStr+1;
-					strcpy(p, s);
-					char commentOpen[tokenLen+10] = "1";
-					p = commentOpen+1;
-					strcpy(p, s);
-					
-					if (isInList(keywords5, s, doPrefix4G1, isCaseIgnored))
-						sc.ChangeState(sID::WORD1);
-					else if (isInList(keywords6, s, doPrefix4G2, isCaseIgnored))
-						sc.ChangeState(sID::WORD2);
-					else if (isInList(keywords7, s, doPrefix4G3, isCaseIgnored))
-						sc.ChangeState(sID::WORD3);
-					else if (isInList(keywords8, s, doPrefix4G4, isCaseIgnored)) 
-						sc.ChangeState(sID::WORD4);
-
-					//else if (blockOpenWords.InList(s)) 
-					else if (isInList(blockOpenWords, s, false, isCaseIgnored)) 
-						sc.ChangeState(sID::BLOCK_OPERATOR_OPEN);
-					//else if (blockCloseWords.InList(s)) 
-					else if (isInList(blockCloseWords, s, false, isCaseIgnored))
-						sc.ChangeState(sID::BLOCK_OPERATOR_CLOSE);
-					else if (isInList(comments,commentLineStr, isCommentLineSymbol, isCaseIgnored))
-					{
-						sc.ChangeState(sID::COMMENTLINE);
-						doDefault = false;
-					}
-					else if (isInList(comments, commentOpen, isCommentSymbol, isCaseIgnored)) 
+
+					// WORD1 - WORD4, BLOCK_OPERATOR_OPEN/CLOSE, COMMENTLINE, or COMMENT
+					int wordStyle = kc_words.classify(s);
+					if (wordStyle != lIface::KeywordClassifier::NO_MATCH)
 					{
-					      sc.ChangeState(sID::COMMENT);
-					      doDefault = false;
+						sc.ChangeState(wordStyle);
+						if (wordStyle == sID::COMMENTLINE || wordStyle == sID::COMMENT)
+							doDefault = false;
 					}
 					if (doDefault)
 						sc.SetState(sID::DEFAULT);
@@ -376,18 +318,9 @@ static void Colourise_Doc(unsigned int startPos, int length, int initStyle, Word
 			
 			case sID::COMMENT :
 			{
-				char *pCommentClose = NULL;
-				for (int i = 0 ; i < comments.len ; i++)
-				{
-					if (comments.words[i][0] == '2')
-					{
-						pCommentClose = comments.words[i] + 1;
-						break;
-					}
-				}
-				if (pCommentClose)
+				if (commentCloseLen > 0)
 				{
-					int len = strlen(pCommentClose);
+					int len = commentCloseLen;
 					if (len == 1)
 					{
 						if (sc.Match(pCommentClose[0])) 
@@ -437,13 +370,9 @@ static void Colourise_Doc(unsigned int startPos, int length, int initStyle, Word
 			if (IsADigit(sc.ch))
 				sc.SetState(sID::NUMBER);
 			//else if (symbols.InList(aSymbol))
-			else if (delimOpen[0] && (sc.ch == delimOpen[0]))
-				sc.SetState(sID::DELIMITER1);
-			else if (delimOpen[0] && (sc.ch == delimOpen[1]))
-				sc.SetState(sID::DELIMITER2);
-			else if (delimOpen[0] && (sc.ch == delimOpen[2]))
-				sc.SetState(sID::DELIMITER3);
-			else if (isInOpList(symbols, sc.ch))
+			else if (delimOpenStyle[sc.ch & 0xFF] != sID::DEFAULT)
+				sc.SetState(delimOpenStyle[sc.ch & 0xFF]);
+			else if (isOperator[sc.ch & 0xFF])
 				sc.SetState(sID::OPERATOR);
 			else if (isAWordStart(sc.ch)) 
 				sc.SetState(sID::IDENTIFIER);
@@ -544,28 +473,23 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
                   char *words[], WindowID window, char *props)
 {
 
-	// Create and initialize the WindowAccessor (including contained PropSet)
-	PropSet ps;
-	ps.SetMultiple(props);
-	WindowAccessor wa(window, ps);
-
-	//  Create and initialize WordList(s).
-	//  If you have an extremely large word file, or lots of styling rules you may want to speed
-	//  up processing by storing the wordlists instead of reprocessing them on each call.
-	int nWL = 0;
-	for (; words[nWL]; nWL++) ;	// count # of WordList PTRs needed
-	WordList** wl = new WordList* [nWL + 1];// alloc WordList PTRs
-	int i = 0;
-	for (; i < nWL; i++) {
-		wl[i] = new WordList();	// (works or THROWS bad_alloc EXCEPTION)
-		wl[i]->Set(words[i]);
-	}
-	wl[i] = 0;
-
+	// Create the accessor over the document text, properties only parsed again when they change.
+	lIface::DirectAccessor wa(window, inputs.properties(props), startPos, length);
 
 	// Set the currView handle to update at least once per lexer call.
 	npp_plugin::hCurrViewNeedsUpdate();
 
+	LexOrFold(foldOrLex, startPos, length, initStyle, words, wa);
+}
+
+//  Accessor entry point, used by the Scintilla entry point and by the lexer benchmark.
+void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
+                  char *words[], Accessor &wa)
+{
+
+	//  The WordList(s) are kept between calls and only rebuilt when a list's text changes.
+	WordList** wl = inputs.wordLists(words);
+
 
 	//  Call the internal folding and styling functions.
 	// foldOrLex is false for lex and true for fold
@@ -600,11 +524,6 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
 	//  The flush function is what actually finalizes settings the styles you just coloured.
 	wa.Flush();
 
-	// Clean up the wordlists before leaving.
-	for (i = nWL - 1; i >= 0; i--)
-		delete wl[i];
-	delete [] wl;
-
 }
 
 
@@ -45,6 +45,9 @@ namespace NppExtLexer_PowerShell {
 //  <--- Namespace Global Pointers --->
 PowerShell_Lexer lexer;
 
+//  The properties Notepad++ passes, kept until their text changes.
+lIface::LexerInputs inputs;
+
 //  <--- Base wordlist and character set classes --->
  /*
   *  I've place these in the global (to this namespace) location because the trade-off between
@@ -52,26 +55,99 @@ PowerShell_Lexer lexer;
   *  keeping them around seems to be in favor of using of speed.
   */
 
+//  The six keyword lists, merged into one classifier per Colourise_Doc switch case.
+//
 //								keywordClass/[array]	Style					Colourise_Doc Switch Case
-WordList wl_keywords;			// instre1/[0]			KEYWORD(15)				IDENTIFIER
-WordList wl_cmdlets;			// instre2/[1]			CMDLET(16)				IDENTIFIER
-WordList wl_aliases;			// type 1/[2]			ALIAS(17)				IDENTIFIER
-WordList wl_operators;			// type 2/[3]			OPERATOR(1)				PARAMETER
-WordList wl_cmdletParam;		// type 3/[4]			CMLDPARAMATTRIB(20)		TYPE
-WordList wl_parameterValues;	// type 4/[5]			CMDLETPARAMPARAM(19)	IDENTIFIER
-
-CharacterSet setWordStart(CharacterSet::setAlphaNum, "_", 0x80, true);
-CharacterSet setVarName(CharacterSet::setAlphaNum,":_", 0x80, true);
-CharacterSet setCmdlet(CharacterSet::setAlphaNum, "-_", 0x80, true);
-CharacterSet setTypes(CharacterSet::setAlphaNum, "._':", 0x80, true);
-CharacterSet setOperator(CharacterSet::setNone,"%^&*-+=|:;<>,/?!.~@$[]{}()",0x80, true);
-CharacterSet setGroupStart(CharacterSet::setNone, "{([", 0x80, true);
-CharacterSet setGroupEnd(CharacterSet::setNone, "])}", 0x80, true);
+//	keywords					instre1/[0]				KEYWORD(15)				IDENTIFIER
+//	cmdlets						instre2/[1]				CMDLET(16)				IDENTIFIER
+//	aliases						type 1/[2]				ALIAS(17)				IDENTIFIER
+//	operators					type 2/[3]				OPERATOR(1)				PARAMETER
+//	cmdletParam					type 3/[4]				CMLDPARAMATTRIB(20)		TYPE
+//	parameterValues				type 4/[5]				CMDLETPARAMPARAM(19)	IDENTIFIER
+lIface::KeywordClassifier kc_identifiers;
+lIface::KeywordClassifier kc_parameters;
+lIface::KeywordClassifier kc_types;
+
+//  Character classes, held in one table on top of the base classes so a character is tested
+//  against several of them with one lookup.  Every byte from 0x80 up is in all of them.
+enum {
+	WORD_START		= lIface::char_class::FIRST_LEXER_FLAG,		//  Alphanumerics and _
+	VAR_NAME		= WORD_START << 1,							//  Alphanumerics and :_
+	CMDLET			= WORD_START << 2,							//  Alphanumerics and -_
+	TYPES			= WORD_START << 3,							//  Alphanumerics and ._':
+	OPERATOR		= WORD_START << 4,							//  %^&*-+=|:;<>,/?!.~@$[]{}()
+	GROUP_START		= WORD_START << 5,							//  {([
+	GROUP_END		= WORD_START << 6,							//  ])}
+	ALL_CLASSES		= WORD_START | VAR_NAME | CMDLET | TYPES | OPERATOR | GROUP_START | GROUP_END
+};
+
+#define PS_IS_ALNUM( c ) ( ( ( c ) >= '0' && ( c ) <= '9' ) || ( ( c ) >= 'A' && ( c ) <= 'Z' ) || \
+	( ( c ) >= 'a' && ( c ) <= 'z' ) )
+#define PS_IS_GROUP_START( c ) ( ( c ) == '{' || ( c ) == '(' || ( c ) == '[' )
+#define PS_IS_GROUP_END( c ) ( ( c ) == ']' || ( c ) == ')' || ( c ) == '}' )
+#define PS_IS_OPERATOR( c ) ( PS_IS_GROUP_START( c ) || PS_IS_GROUP_END( c ) || \
+	( c ) == '%' || ( c ) == '^' || ( c ) == '&' || ( c ) == '*' || ( c ) == '-' || ( c ) == '+' || \
+	( c ) == '=' || ( c ) == '|' || ( c ) == ':' || ( c ) == ';' || ( c ) == '<' || ( c ) == '>' || \
+	( c ) == ',' || ( c ) == '/' || ( c ) == '?' || ( c ) == '!' || ( c ) == '.' || ( c ) == '~' || \
+	( c ) == '@' || ( c ) == '$' )
+#define PS_CHAR_CLASS( c ) ( NPP_CHARCLASS_BASE( c ) | ( ( ( c ) >= 0x80 ) ? ALL_CLASSES : ( \
+	( ( PS_IS_ALNUM( c ) || ( c ) == '_' ) ? WORD_START : 0 ) | \
+	( ( PS_IS_ALNUM( c ) || ( c ) == ':' || ( c ) == '_' ) ? VAR_NAME : 0 ) | \
+	( ( PS_IS_ALNUM( c ) || ( c ) == '-' || ( c ) == '_' ) ? CMDLET : 0 ) | \
+	( ( PS_IS_ALNUM( c ) || ( c ) == '.' || ( c ) == '_' || ( c ) == '\'' || ( c ) == ':' ) ? TYPES : 0 ) | \
+	( PS_IS_OPERATOR( c ) ? OPERATOR : 0 ) | \
+	( PS_IS_GROUP_START( c ) ? GROUP_START : 0 ) | \
+	( PS_IS_GROUP_END( c ) ? GROUP_END : 0 ) ) ) )
+
+const lIface::char_class::Flags psClass[256] = { NPP_CHARCLASS_TABLE( PS_CHAR_CLASS ) };
+
+inline bool isIn( int ch, lIface::char_class::Flags classes )
+{
+	return ( lIface::char_class::is( psClass, ch, classes ) );
+}
+
+//  The bytes Colourise_Doc acts on inside string and comment bodies; everything else is skipped.
+lIface::ByteScanner scanString("\"$`(){}[]\r\n");
+lIface::ByteScanner scanStringLiteral("'(){}[]\r\n");
+lIface::ByteScanner scanComment("(){}[]\r\n");
+lIface::ByteScanner scanMultilineComment("#(){}[]\r\n");
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 //  Main Lexer Functions
 
+//  Keeps the group level used for nest tracking and records bracket pairs for highlighting.
+inline void trackGroup(StyleContext &sc, unsigned int &iGroupLevel)
+{
+	lIface::char_class::Flags chClass = lIface::char_class::of(psClass, sc.ch);
+	if (chClass & GROUP_START) {
+		iGroupLevel++;
+		if (lexer.IsBraceState(sc.state)) lexer.pDocState->braces.open(sc.ch, sc.currentPos);
+	}
+	if (chClass & GROUP_END) {
+		iGroupLevel--;
+		if (lexer.IsBraceState(sc.state)) lexer.pDocState->braces.close(sc.ch, sc.currentPos);
+	}
+}
+
+//  Returns the scanner for the plain text of a string or comment body, NULL for other states.
+inline const lIface::ByteScanner* bodyScanner(int state)
+{
+	switch (state) {
+		case sID::STRING:
+		case sID::HERESTRING:
+			return (&scanString);
+		case sID::STRINGLITERAL:
+		case sID::HERESTRINGLITERAL:
+			return (&scanStringLiteral);
+		case sID::COMMENT:
+			return (&scanComment);
+		case sID::MULTILINECOMMENT:
+			return (&scanMultilineComment);
+	}
+	return (NULL);
+}
+
 //  <---  Colourise --->
 void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &styler)
 //void Colourise_Doc(unsigned int startPos, int length, int initStyle, WordList *keywordlists[], Accessor &styler)
@@ -84,23 +160,52 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 	int prevWordState = initStyle;	// Tracks states for previous non-operator and non-whitespace
 	bool bVarNameExt = false;		// flag for extended variable names
 
-	// Initialize state nesting
-	sn[iNL].preNestState = initStyle;
-	sn[iNL].prevWordState = initStyle;
-	sn[iNL].GroupLevel = 0;
+	// Checkpoints past the start line are stale from here on.
+	int startLine = styler.GetLine(startPos);
+	lexer.pDocState->checkpoints.truncate(startLine);
+
+	const PowerShell_Lexer::StateCheckpoints::Checkpoint* cp = NULL;
+	if (styler.LineStart(startLine) == int(startPos)) cp = lexer.pDocState->checkpoints.find(startLine);
+
+	// Bracket pairs from here on get found again.
+	std::vector<int> openBraces[NB_BRACE_KINDS];
+	if (cp) lexer.pDocState->checkpoints.restoreBraces(*cp, openBraces);
+	lexer.pDocState->braces.startAt(startPos, cp ? openBraces : NULL);
+
+	if (cp) {
+		// Resume with the exact state the line was entered with last time.
+		initStyle = cp->state;
+		prevWordState = cp->prevWordState;
+		iGroupLevel = cp->GroupLevel;
+		bVarNameExt = cp->VarNameExt;
+		iNL = lexer.pDocState->checkpoints.restoreNest(*cp, sn);
+	}
+	else {
+		// Initialize state nesting
+		sn[iNL].preNestState = initStyle;
+		sn[iNL].prevWordState = initStyle;
+		sn[iNL].GroupLevel = 0;
+	}
 
 	// Should be ready to process now; setup the class parms
 	StyleContext sc(startPos, length, initStyle, styler);
+	lIface::TextSnapshot snapshot(styler);
+	const int endPos = startPos + length;
+	const bool doubleByte = styler.IsLeadByte('\x81');	// 0x81 leads in every double-byte code page.
 
 	// Main lexing loop
 	for (; sc.More(); sc.Forward()) {
 
+		if (sc.atLineStart) {
+			lexer.pDocState->checkpoints.store(styler.GetLine(sc.currentPos), sc.state, prevWordState,
+				iGroupLevel, bVarNameExt, sn, iNL, lexer.pDocState->braces.getOpenBraces());
+		}
+
 		if (sc.ch == '`') lexer.CaptureEscapeChars(sc);
 
 		// Keep track of grouping levels for nest tracking
 		// Beware of forwarding onto or over group indicators (see STRING cases for example)
-		if (setGroupStart.Contains(sc.ch)) iGroupLevel++;
-		if (setGroupEnd.Contains(sc.ch)) iGroupLevel--;
+		trackGroup(sc, iGroupLevel);
 
 		// Process current style state
 		switch(sc.state) {
@@ -110,8 +215,7 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 					sc.ForwardSetState(sID::DEFAULT);
 					if (sc.chPrev == '\"') {
 						// Double quotes can cause missed characters, when it is a Group open or close it messes up the counts
-						if (setGroupStart.Contains(sc.ch)) iGroupLevel++;
-						if (setGroupEnd.Contains(sc.ch)) iGroupLevel--;
+						trackGroup(sc, iGroupLevel);
 					}
 				}
 				// Highlight nested variables and evaluations in double quoted strings
@@ -157,8 +261,7 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 					sc.ForwardSetState(sID::DEFAULT);
 					if (sc.chPrev == '\'') {
 						// Double quotes can cause missed characters, when it is a Group open or close it messes up the counts
-						if (setGroupStart.Contains(sc.ch)) iGroupLevel++;
-						if (setGroupEnd.Contains(sc.ch)) iGroupLevel--;
+						trackGroup(sc, iGroupLevel);
 					}
 				}
 				break;
@@ -190,7 +293,7 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 						bVarNameExt = false;
 					}
 				}
-				else if(!setVarName.Contains(sc.ch) || sc.Match(':', ':')) {
+				else if(!isIn(sc.ch, VAR_NAME) || sc.Match(':', ':')) {
 					sc.SetState(sID::DEFAULT);
 				}
 				break;
@@ -200,12 +303,12 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 				} 
 				break;
 			case sID::PARAMETER:
-				if (!setWordStart.Contains(sc.ch)) {
+				if (!isIn(sc.ch, WORD_START)) {
 					char s[100];
 					sc.GetCurrentLowered(s, sizeof(s));
 
 					// Since named operators also start with a '-' check for matches here
-					if (wl_operators.InList(s)) {
+					if (kc_parameters.classify(s) == sID::OPERATOR) {
 						sc.ChangeState(sID::OPERATOR);
 					}
 					sc.SetState(sID::DEFAULT);
@@ -213,30 +316,26 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 				break;
 			case sID::TYPE:
 				// Initialized with '['
-				if (!setTypes.Contains(sc.ch)) {
+				if (!isIn(sc.ch, TYPES)) {
 					char s[1000];
 					sc.GetCurrentLowered(s, sizeof(s));
 
 					// Check for specified parm type
-					if(wl_cmdletParam.InList(s)) {
+					if(kc_types.classify(s) == sID::CMDLETPARAMATTRIB) {
 						sc.ChangeState(sID::CMDLETPARAMATTRIB);
 					}
 					sc.SetState(sID::DEFAULT);
 				}
 				break;
 			case sID::IDENTIFIER:
-				if (!setCmdlet.Contains(sc.ch)) {
+				if (!isIn(sc.ch, CMDLET)) {
 					char s[100];
 					sc.GetCurrentLowered(s, sizeof(s));
 
-					if (wl_keywords.InList(s)) {
-						sc.ChangeState(sID::KEYWORD);
-					} else if (wl_cmdlets.InList(s)) {
-						sc.ChangeState(sID::CMDLET);
-					} else if (wl_aliases.InList(s)) {
-						sc.ChangeState(sID::ALIAS);
-					} else if (wl_parameterValues.InList(s)) {
-						sc.ChangeState(sID::CMDLETPARAMPARAM);  //what is a param param?
+					int wordStyle = kc_identifiers.classify(s);
+					if (wordStyle != lIface::KeywordClassifier::NO_MATCH) {
+						// KEYWORD, CMDLET, ALIAS, or CMDLETPARAMPARAM ( what is a param param? )
+						sc.ChangeState(wordStyle);
 					} else {
 						// Naked strings should be treated as arguments?
 						prevWordState = sID::DEFAULT;
@@ -246,7 +345,7 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 				}
 				break;
 			case sID::MEMBER:
-				if (sc.atLineEnd || !setVarName.Contains(sc.ch)) {
+				if (sc.atLineEnd || !isIn(sc.ch, VAR_NAME)) {
 					if (sc.ch == '(') {
 						sc.ChangeState(sID::METHOD);
 					} else {
@@ -287,12 +386,12 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 				sc.SetState(sID::HERESTRINGLITERAL);
 			}
 			// Numerics
-			else if (IsADigit(sc.ch) && !isalpha(sc.chPrev)) {
+			else if (IsADigit(sc.ch) && !isIn(sc.chPrev, lIface::char_class::ALPHA)) {
 				sc.SetState(sID::NUMBER);
 			}
 			// Parameters
-			else if (sc.chPrev == '-' && !(IsADigit(sc.ch) || IsASpaceOrTab(sc.ch)) && 
-				(!setOperator.Contains(sc.ch) || sc.chNext == '$')) {
+			else if (sc.chPrev == '-' && !isIn(sc.ch, lIface::char_class::DIGIT | lIface::char_class::BLANK) &&
+				(!isIn(sc.ch, OPERATOR) || sc.chNext == '$')) {
 					sc.SetState(sID::PARAMETER);
 			}
 			// Variables
@@ -300,26 +399,26 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 				sc.SetState(sID::VARIABLE);
 			}
 			// Types
-			else if((sc.chPrev == '[' && setWordStart.Contains(sc.ch)) &&
+			else if((sc.chPrev == '[' && isIn(sc.ch, WORD_START)) &&
 				!(IsADigit(sc.ch) || (sc.ch == '-' && IsADigit(sc.chNext)))){
 					sc.SetState(sID::TYPE);
 			}
 			// STATIC MEMBERs:	start with letters and follow '::'
-			else if (styler.Match(sc.currentPos - 2, "::") && isalpha(sc.ch)) {
+			else if (styler.Match(sc.currentPos - 2, "::") && isIn(sc.ch, lIface::char_class::ALPHA)) {
 				sc.SetState(sID::MEMBER);	
 			}
 			// MEMBERs:	Start with letters, follow '.' and don't come after "default" stuff
 			else if (prevWordState != sID::DEFAULT && sc.chPrev != '*' &&
-				sc.ch == '.' && isalpha(sc.chNext)) {
+				sc.ch == '.' && isIn(sc.chNext, lIface::char_class::ALPHA)) {
 					sc.SetState(sID::OPERATOR);
 					sc.ForwardSetState(sID::MEMBER);
 			}
 			// Operators
-			else if (setOperator.Contains(sc.ch)) {
+			else if (isIn(sc.ch, OPERATOR)) {
 				sc.SetState(sID::OPERATOR);
 			}
 			// Keyword Identifiers
-			else if (setCmdlet.Contains(sc.ch)) {
+			else if (isIn(sc.ch, CMDLET)) {
 				sc.SetState(sID::IDENTIFIER);
 			}
 		}
@@ -331,12 +430,12 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 		if ( sc.atLineEnd ) {
 
 			if ( iNL >> 0 ) {
-				lexer.lineState.flagMultilineStyle( styler.GetLine( sc.currentPos ) );
+				lexer.pDocState->lineState.flagMultilineStyle( styler.GetLine( sc.currentPos ) );
 			}
 
 			if ( iNL == 0 && (! lexer.fullDocProcessing ) &&
-					( lexer.lineState.IsMultilineStyle( styler.GetLine( sc.currentPos ) ) ) ) {
-				lexer.lineState.clearMultilineStyle( sc.currentPos );
+					( lexer.pDocState->lineState.IsMultilineStyle( styler.GetLine( sc.currentPos ) ) ) ) {
+				lexer.pDocState->lineState.clearMultilineStyle( sc.currentPos );
 			}
 
 		}
@@ -362,9 +461,8 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 							// Fix for cases when using the previous ForwardSetState bypasses
 							// GroupTerminators directly after the '\"'
 							while(sc.ch == sn[iNL].GroupTerminator ||
-								(iNL == 0 && setOperator.Contains(sc.ch))) {
-									if (setGroupStart.Contains(sc.ch)) iGroupLevel++;
-									if (setGroupEnd.Contains(sc.ch)) iGroupLevel--;
+								(iNL == 0 && isIn(sc.ch, OPERATOR))) {
+									trackGroup(sc, iGroupLevel);
 									sc.SetState(sID::OPERATOR);
 									sc.ForwardSetState(sn[iNL].preNestState);
 							}
@@ -375,21 +473,71 @@ void Colourise_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 		}
 
 
-		if(!setOperator.Contains(sc.ch) && !IsASpaceOrTab(sc.ch)) {
+		if(!isIn(sc.ch, OPERATOR | lIface::char_class::BLANK)) {
 			prevWordState = sc.state;
 		}
+
+		// Plain text in a string or comment body changes nothing but prevWordState, so step
+		// straight over it to the next byte the cases above act on.  Line ends are left to the
+		// loop so line starts still get their checkpoints.
+		const lIface::ByteScanner* scanner = bodyScanner(sc.state);
+		if (scanner && iNL == 0 && !sc.atLineEnd && sc.ch != '\r') {
+			int lastPos = sc.currentPos;	// Start and value of the last plain character.
+			int lastCh = sc.ch;
+			int pos = lastPos + ((lastCh >= 0x100) ? 2 : 1);
+			int plainEnd = pos + snapshot.span(*scanner, pos, endPos);
+
+			if (!doubleByte) {
+				if (pos < plainEnd) {
+					lastPos = plainEnd - 1;
+					lastCh = static_cast<unsigned char>(snapshot.charAt(lastPos, endPos));
+				}
+				for (; pos < plainEnd && prevWordState != sc.state; pos++) {
+					int ch = static_cast<unsigned char>(snapshot.charAt(pos, endPos));
+					if (!isIn(ch, OPERATOR | lIface::char_class::BLANK)) prevWordState = sc.state;
+				}
+			}
+			else {
+				// A trail byte can look like a stop byte, so the scan carries on past one.
+				while (pos < plainEnd) {
+					lastPos = pos;
+					lastCh = static_cast<unsigned char>(snapshot.charAt(pos, endPos));
+					if (styler.IsLeadByte(static_cast<char>(lastCh))) {
+						lastCh = (lastCh << 8) | static_cast<unsigned char>(snapshot.charAt(pos + 1, endPos));
+						prevWordState = sc.state;
+						pos += 2;
+						if (pos > plainEnd) plainEnd = pos + snapshot.span(*scanner, pos, endPos);
+					}
+					else {
+						if (!isIn(lastCh, OPERATOR | lIface::char_class::BLANK)) prevWordState = sc.state;
+						pos++;
+					}
+				}
+			}
+
+			// Style the run in one go and pick the StyleContext up again on its last character,
+			// the loop's Forward() moves onto the stop byte.
+			if (lastPos != static_cast<int>(sc.currentPos)) {
+				styler.ColourTo(plainEnd - 1, sc.state);
+				sc.currentPos = lastPos;
+				sc.ch = lastCh;
+				sc.chNext = static_cast<unsigned char>(snapshot.charAt(plainEnd, endPos));
+			}
+		}
 	}
 
 	// All done
 	sc.Complete();
+	lexer.pDocState->braces.endAt(startPos + length);
 	// TODO if (bFirstPass) styler.Flush();
 }
 
 
 //  <--- Highlight --->
-void Highlight_Doc(unsigned int startPos, int length, int initStyle, Accessor &styler)
+//  Clears any existing highlights within range and the multiline state of its lines.
+//  Returns whether any highlights need drawing.
+bool Clear_Hlites(unsigned int startPos, int length, Accessor &styler)
 {
-	//  Clear any existing highlights within range & check if we need to draw any highlights.
 	bool drawHlites = false;
 
 	for ( int i = 0; i < INDICMAX; i++ ) {
@@ -397,251 +545,270 @@ void Highlight_Doc(unsigned int startPos, int length, int initStyle, Accessor &s
 			drawHlites = true;
 		}
 		//  Using a zero value param through the accessor will clear an indicator
-		styler.IndicatorFill( startPos, length -1 , i, NULL );
+		styler.IndicatorFill( startPos, startPos + length, i, NULL );
 	}
 
-	lexer.lineState.ClearMultilineState(styler.GetLine(startPos), styler.GetLine(startPos + length));
+	if ( lexer.fullDocProcessing ) {
+		lexer.pDocState->lineState.resetMultilineState();
+	}
+	else {
+		lexer.pDocState->lineState.ClearMultilineState(styler.GetLine(startPos), styler.GetLine(startPos + length));
+	}
 
+	return ( drawHlites );
+}
 
-	if ( drawHlites ) {
-		int currPos;
-		int currStyle;
-		int currHlite;
-		int braceMatchPos;				//  Used for multiline highlight control.
-		int thisLineDiff;		//  Used for multiline highlight control.
+//  Highlights from pos through the bracket matching the one at matchFrom, or just pos when
+//  there isn't one.
+void Hlite_ToBrace(int pos, int matchFrom, int indicator, Accessor &styler)
+{
+	int currHlite = indicator - INDICBASE;
+	int currPos;
 
-		//  Draw indicators in range.  When modifying pay attention to the placement of
-		//  'pos=currPos' to save processing time; don't do this when highlights can overlap!
-		for (unsigned int pos = startPos; pos < (startPos + length); pos++) {
+	// Make sure we at least have a matching brace to highlight to.
+	int braceMatchPos = lexer.braceMatch( matchFrom );
+	if ( braceMatchPos == -1 ) {
+		braceMatchPos = pos;
+	}
+	braceMatchPos++;	//  Brace match position is always -1 from our target.
 
-			currStyle = styler.StyleAt(pos);
+	styler.IndicatorFill(pos, braceMatchPos, currHlite, indicator);
 
-			switch (currStyle)
-			{
-				case sID::OPERATOR:			// Capture expressions and apply highlight
-					currHlite = sID::INDICEXPR - INDICBASE;
-					if ( ( lexer.Hlite[currHlite].Active ) &&
-							styler.Match( pos, "$(" ) ) {
+	//  Handle multiline instances of this highlighter.
+	int thisLineDiff = ( styler.GetLine(braceMatchPos) - styler.GetLine(pos) );
 
-						// Make sure we at least have a matching brace to highlight to.
-						braceMatchPos = messageProc( SCI_BRACEMATCH, pos + 1, 0 );
-						if ( braceMatchPos == -1 ) {
-							braceMatchPos = pos;
-						}
-						braceMatchPos++;	//  Brace match position is always -1 from our target.
-
-						styler.IndicatorFill(pos, braceMatchPos, currHlite,	sID::INDICEXPR);
-
-						//  Handle multiline instances of this highlighter.
-						thisLineDiff = ( styler.GetLine(braceMatchPos) - styler.GetLine(pos) );
-						
-						if (! thisLineDiff == 0 ) {
-							lexer.lineState.setMultlineState( styler.GetLine(pos), styler.GetLine(braceMatchPos) );
-
-							if ( lexer.Hlite[currHlite].clearWhiteSpace ) {
-								currPos = styler.LineStart( styler.GetLine(pos) + 1 );
-								do {
-
-									int j = currPos;
-									while ( IsASpaceOrTab( styler.SafeGetCharAt(j) ) ) j++;
-									if ( j > currPos ) {
-										styler.IndicatorFill( currPos, j, currHlite, NULL );
-										currPos = styler.LineStart( styler.GetLine(currPos) + 1 );
-									}
-									else {
-										currPos = styler.LineStart(styler.GetLine(currPos) + 1);
-									}
-
-								} while (currPos < braceMatchPos);
-							}
-						}
-					}
-					break;
-				case sID::PARAMETER:
-					currHlite = sID::INDICPARM - INDICBASE;
-					if ( lexer.Hlite[currHlite].Active ) {
-						// Find the end of the current style and highlight to it
-						for (currPos = pos + 1; styler.StyleAt(currPos) == currStyle; currPos++);
-						styler.IndicatorFill(pos, currPos, currHlite, sID::INDICPARM);
-						pos = currPos;
-					}
-					break;
-				case sID::PROPERTY:
-					currHlite = sID::INDICPROP - INDICBASE;
-					if ( lexer.Hlite[currHlite].Active ) {
-						// Find the end of the current style and highlight to it
-						for (currPos = pos + 1; styler.StyleAt(currPos) == currStyle; currPos++);
-						styler.IndicatorFill(pos, currPos, currHlite, sID::INDICPROP);
-						pos = currPos;
-					}
-					break;
-				case sID::METHOD:
-					currHlite = sID::INDICMETH - INDICBASE;
-					if ( lexer.Hlite[currHlite].Active ) {
-						for (currPos = pos + 1; styler.StyleAt(currPos) == currStyle; currPos++);
-						// Make sure we at least have a matching brace to highlight to
-						braceMatchPos = messageProc(SCI_BRACEMATCH, currPos, 0);
-						if (braceMatchPos == -1 ) {
-							braceMatchPos = pos;
-						}
-						braceMatchPos++;
-
-						styler.IndicatorFill(pos, braceMatchPos, currHlite,	sID::INDICMETH);
-
-						//  Handle multiline instances of this highlighter.
-						thisLineDiff = (styler.GetLine(braceMatchPos) - styler.GetLine(pos));
-						
-						if (! thisLineDiff == 0) {
-							lexer.lineState.setMultlineState( styler.GetLine(pos), styler.GetLine(braceMatchPos) );
-
-							if ( lexer.Hlite[currHlite].clearWhiteSpace ) {
-								currPos = styler.LineStart( styler.GetLine(pos) + 1 );
-								do {
-
-									int j = currPos;
-									while (IsASpaceOrTab(styler.SafeGetCharAt(j) ) ) j++;
-									if (j > currPos) {
-										styler.IndicatorFill( currPos, j, currHlite, NULL );
-										currPos = styler.LineStart(styler.GetLine(currPos) + 1);
-									}
-									else {
-										currPos = styler.LineStart(styler.GetLine(currPos) + 1);
-									}
-
-								} while (currPos < braceMatchPos);
-							}
-						}
-					}
-					break;
-			}	// End:  switch(currStyle)
-		}	// End: main pos loop
-	}  // End:  drawHlites
+	if (! thisLineDiff == 0 ) {
+		lexer.pDocState->lineState.setMultlineState( styler.GetLine(pos), styler.GetLine(braceMatchPos) );
+
+		if ( lexer.Hlite[currHlite].clearWhiteSpace ) {
+			currPos = styler.LineStart( styler.GetLine(pos) + 1 );
+			do {
+
+				int j = currPos;
+				while ( IsASpaceOrTab( styler.SafeGetCharAt(j) ) ) j++;
+				if ( j > currPos ) {
+					styler.IndicatorFill( currPos, j, currHlite, NULL );
+					currPos = styler.LineStart( styler.GetLine(currPos) + 1 );
+				}
+				else {
+					currPos = styler.LineStart(styler.GetLine(currPos) + 1);
+				}
+
+			} while (currPos < braceMatchPos);
+		}
+	}
 }
 
-//  <--- Fold --->
-void Fold_Doc(unsigned int startPos, int length, int initStyle, Accessor &styler)
+//  Draws the highlights starting in [startPos, endPos) from the styles styler holds.
+void Draw_Hlites(unsigned int startPos, unsigned int endPos, Accessor &styler)
 {
-	// Store both the current line's fold level and the next lines in the
-	// level store to make it easy to pick up with each increment
-	// and to make it possible to fiddle the current level for "} else {".
+	int currPos;
+	int currStyle;
+	int currHlite;
 
-	/*
-	Couldn't find any documentation about Notepad++ and .properties, but to be used with editors that
-	make use of properties files GetPropertyInt is used, but for Notepad++ provide a default value.
-	*/
+	//  Draw indicators in range.  When modifying pay attention to the placement of
+	//  'pos=currPos' to save processing time; don't do this when highlights can overlap!
+	for (unsigned int pos = startPos; pos < endPos; pos++) {
 
-	// We might not even want folding...
-	if (styler.GetPropertyInt("fold") == 0)	return;
+		currStyle = styler.StyleAt(pos);
 
-	// Initialize fold settings
-	bool foldComment = styler.GetPropertyInt("fold.comment", 1) != 0;
-	bool foldSuccessiveHashComment = styler.GetPropertyInt("fold.successivehashcomment", 1) != 0;
-	bool foldMultilineComment = styler.GetPropertyInt("fold.multilinecomment", 1) != 0;
+		switch (currStyle)
+		{
+			case sID::OPERATOR:			// Capture expressions and apply highlight
+				currHlite = sID::INDICEXPR - INDICBASE;
+				if ( ( lexer.Hlite[currHlite].Active ) &&
+						styler.Match( pos, "$(" ) ) {
+					Hlite_ToBrace( pos, pos + 1, sID::INDICEXPR, styler );
+				}
+				break;
+			case sID::PARAMETER:
+				currHlite = sID::INDICPARM - INDICBASE;
+				if ( lexer.Hlite[currHlite].Active ) {
+					// Find the end of the current style and highlight to it
+					for (currPos = pos + 1; styler.StyleAt(currPos) == currStyle; currPos++);
+					styler.IndicatorFill(pos, currPos, currHlite, sID::INDICPARM);
+					pos = currPos;
+				}
+				break;
+			case sID::PROPERTY:
+				currHlite = sID::INDICPROP - INDICBASE;
+				if ( lexer.Hlite[currHlite].Active ) {
+					// Find the end of the current style and highlight to it
+					for (currPos = pos + 1; styler.StyleAt(currPos) == currStyle; currPos++);
+					styler.IndicatorFill(pos, currPos, currHlite, sID::INDICPROP);
+					pos = currPos;
+				}
+				break;
+			case sID::METHOD:
+				currHlite = sID::INDICMETH - INDICBASE;
+				if ( lexer.Hlite[currHlite].Active ) {
+					for (currPos = pos + 1; styler.StyleAt(currPos) == currStyle; currPos++);
+					Hlite_ToBrace( pos, currPos, sID::INDICMETH, styler );
+				}
+				break;
+		}	// End:  switch(currStyle)
+	}	// End: main pos loop
+}
+
+void Highlight_Doc(unsigned int startPos, int length, int initStyle, Accessor &styler)
+{
+	//  Clear any existing highlights within range & check if we need to draw any highlights.
+	if ( Clear_Hlites( startPos, length, styler ) ) {
+		Draw_Hlites( startPos, startPos + length, styler );
+	}
+}
+
+//  <--- Fold --->
+//  The fold settings, and where the fold starts for the style before it.
+struct FoldOptions {
+	bool foldComment;
+	bool foldSuccessiveHashComment;
+	bool foldMultilineComment;
+	bool foldWithinMultilineComment;
+	bool foldAtElse;
+	bool foldCompact;
+	int startPos;
+	int initStyle;
+};
+
+void Fold_Options(Accessor &styler, FoldOptions &options)
+{
+	options.foldComment = styler.GetPropertyInt("fold.comment", 1) != 0;
+	options.foldSuccessiveHashComment = styler.GetPropertyInt("fold.successivehashcomment", 1) != 0;
+	options.foldMultilineComment = styler.GetPropertyInt("fold.multilinecomment", 1) != 0;
 	// foldWithinMultilineComment allows for brace folding within <* *> markers
-	bool foldWithinMultilineComment = styler.GetPropertyInt("fold.withinmultilinecomment", 1) != 0;
-	bool foldAtElse = styler.GetPropertyInt("fold.at.else", 1) != 0;
-	bool foldCompact = styler.GetPropertyInt("fold.compact", 1) != 0;
+	options.foldWithinMultilineComment = styler.GetPropertyInt("fold.withinmultilinecomment", 1) != 0;
+	options.foldAtElse = styler.GetPropertyInt("fold.at.else", 1) != 0;
+	options.foldCompact = styler.GetPropertyInt("fold.compact", 1) != 0;
+}
 
-	// Initialize values
-	// Store both the current line's fold level and the next lines in the
-	// level store to make it easy to pick up with each increment
-	// and to make it possible to fiddle the current level for "} else {".
-	unsigned int endPos = startPos + length;
-	int visibleChars = 0;
-	int lineCurrent = styler.GetLine(startPos);
-	int levelCurrent = SC_FOLDLEVELBASE;
-	if (lineCurrent > 0)
-		levelCurrent = styler.LevelAt(lineCurrent-1) >> 16;
-	int levelMinCurrent = levelCurrent;
-	int levelNext = levelCurrent;
-	int styleNext = styler.StyleAt(startPos);
-	int style = initStyle;
-	char chNext = styler[startPos];
-
-	// Line Processing
-	for (unsigned int i = startPos; i < endPos; i++) {
-		char ch = chNext;
-		chNext = styler.SafeGetCharAt(i + 1);
+//  Sets the levels of the lines from lineCurrent on, flag and level controls included.
+void Fold_SetLevels(Accessor &styler, int lineCurrent, const std::vector<lIface::LineLevels> &levels,
+                    const FoldOptions &options)
+{
+	for (size_t n = 0; n < levels.size(); n++) {
+		const lIface::LineLevels &line = levels[n];
+		int levelUse = line.start;
+		if (options.foldAtElse) {
+			levelUse = line.min;
+		}
+		int lev = levelUse | line.end << 16;
+		if (!line.visible && options.foldCompact)
+			lev |= SC_FOLDLEVELWHITEFLAG;
+		if (levelUse < line.end)
+			lev |= SC_FOLDLEVELHEADERFLAG;
+		if (lev != styler.LevelAt(lineCurrent)) {
+			styler.SetLevel(lineCurrent, lev);
+		}
+		lineCurrent++;
+	}
+}
+
+//  What one line does to the fold level; context points at the FoldOptions.
+void Fold_Line(const lIface::FoldText &text, int line, int lineStart, int lineEnd, void *context,
+               lIface::LineFold &fold)
+{
+	const FoldOptions &options = *static_cast<const FoldOptions *>(context);
+	int style = (lineStart == options.startPos) ? options.initStyle : text.styleAt(lineStart - 1);
+
+	for (int i = lineStart; i < lineEnd; i++) {
+		char ch = text.charAt(i);
+		char chNext = text.charAt(i + 1);
 		int stylePrev = style;
-		style = styleNext;
-		styleNext = styler.StyleAt(i + 1);
+		style = text.styleAt(i);
+		int styleNext = text.styleAt(i + 1);
 		bool atEOL = lexer.IsEOL(ch, chNext);
 
 		// Comment Folding
-		if ( foldComment && lexer.IsCommentStyle(style) ) {
+		if ( options.foldComment && lexer.IsCommentStyle(style) ) {
 			// Successive single line comment folding
 			if (atEOL) {
-				if (foldSuccessiveHashComment && (style == sID::COMMENT)) {
-					if (! lexer.IsHashCommentLine(lineCurrent - 1) &&
-							lexer.IsHashCommentLine(lineCurrent + 1)) {
-						levelNext++;
+				if (options.foldSuccessiveHashComment && (style == sID::COMMENT)) {
+					bool commentBefore = text.isCommentLine(line - 1);
+					bool commentAfter = text.isCommentLine(line + 1);
+					if (! commentBefore && commentAfter) {
+						fold.delta++;
 					}
-					else if (lexer.IsHashCommentLine(lineCurrent - 1) &&
-							!lexer.IsHashCommentLine(lineCurrent + 1)) {
-						levelNext--;
+					else if (commentBefore && !commentAfter) {
+						fold.delta--;
 					}
 				}
 			}
 			// Multiline comment folding
-			if (foldMultilineComment && (style == sID::MULTILINECOMMENT)) {
+			if (options.foldMultilineComment && (style == sID::MULTILINECOMMENT)) {
 				if (stylePrev != sID::MULTILINECOMMENT) {
-					levelNext++;
+					fold.delta++;
 				}
 				else if ((styleNext != sID::MULTILINECOMMENT) && !atEOL) {
 					// Comments don't end at end of line and the next character may be unstyled.
-					levelNext--;
+					fold.delta--;
 				}
 			}
 
 			// Manual fold point marker
 			if ((ch == '#') && (chNext == '#')) {
-				char chNext2 = styler.SafeGetCharAt(i + 2);
+				char chNext2 = text.charAt(i + 2);
 				if (chNext2 == '{') {
-					levelNext++;
+					fold.delta++;
 				} else if (chNext2 == '}') {
-					levelNext--;
+					fold.delta--;
 				}
 			}
 		}
 
 		// Operator Folding
 		if (style == sID::OPERATOR ||
-			(foldWithinMultilineComment && (style == sID::MULTILINECOMMENT))) {
+			(options.foldWithinMultilineComment && (style == sID::MULTILINECOMMENT))) {
 				if (ch == '{' || ch == '(') {
 					// Measure the minimum before a '{' to allow
 					// folding on "} else {"
-					if (levelMinCurrent > levelNext) {
-						levelMinCurrent = levelNext;
+					if (fold.minDelta > fold.delta) {
+						fold.minDelta = fold.delta;
 					}
-					levelNext++;
+					fold.delta++;
 				} else if (ch == '}' || ch == ')') {
-					levelNext--;
+					fold.delta--;
 				}
 		}
+	}
+}
 
-		// Flag and level controls
-		if (!IsASpace(ch))
-			visibleChars++;
+void Fold_Doc(unsigned int startPos, int length, int initStyle, Accessor &styler)
+{
+	// Store both the current line's fold level and the next lines in the
+	// level store to make it easy to pick up with each increment
+	// and to make it possible to fiddle the current level for "} else {".
 
-		if (atEOL || (i == endPos-1)) {
-			int levelUse = levelCurrent;
-			if (foldAtElse) {
-				levelUse = levelMinCurrent;
-			}
-			int lev = levelUse | levelNext << 16;
-			if (visibleChars == 0 && foldCompact)
-				lev |= SC_FOLDLEVELWHITEFLAG;
-			if (levelUse < levelNext)
-				lev |= SC_FOLDLEVELHEADERFLAG;
-			if (lev != styler.LevelAt(lineCurrent)) {
-				styler.SetLevel(lineCurrent, lev);
-			}
-			lineCurrent++;
-			levelCurrent = levelNext;
-			levelMinCurrent = levelCurrent;
-			visibleChars = 0;
-		}
-	}
+	/*
+	Couldn't find any documentation about Notepad++ and .properties, but to be used with editors that
+	make use of properties files GetPropertyInt is used, but for Notepad++ provide a default value.
+	*/
+
+	// We might not even want folding...
+	if (styler.GetPropertyInt("fold") == 0)	return;
+
+	// Initialize fold settings
+	FoldOptions options;
+	Fold_Options(styler, options);
+	options.startPos = startPos;
+	options.initStyle = initStyle;
+
+	// Initialize values
+	// Store both the current line's fold level and the next lines in the
+	// level store to make it easy to pick up with each increment
+	// and to make it possible to fiddle the current level for "} else {".
+	int lineCurrent = styler.GetLine(startPos);
+	int levelCurrent = SC_FOLDLEVELBASE;
+	if (lineCurrent > 0)
+		levelCurrent = styler.LevelAt(lineCurrent-1) >> 16;
+
+	// Each line's change in level is found on its own, on all processors for a large range,
+	// and then summed from levelCurrent.
+	std::vector<lIface::LineLevels> levels;
+	lIface::foldLevels(styler, startPos, length, levelCurrent, "#", Fold_Line, &options, levels);
+
+	// Flag and level controls
+	Fold_SetLevels(styler, lineCurrent, levels, options);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -650,12 +817,19 @@ void Fold_Doc(unsigned int startPos, int length, int initStyle, Accessor &styler
 //  Updates wordlists.
 void PowerShell_Lexer::updateWordlists(char* words[])
 {
-	wl_keywords.Set(words[0]);
-	wl_cmdlets.Set(words[1]);
-	wl_aliases.Set(words[2]);
-	wl_operators.Set(words[3]);
-	wl_cmdletParam.Set(words[4]);
-	wl_parameterValues.Set(words[5]);
+	//  Identifiers are lowered before classifying, so the lists are matched case sensitive
+	//  just as WordList::InList() did.
+	kc_identifiers.clear(false);
+	kc_identifiers.addWords(words[0], sID::KEYWORD);
+	kc_identifiers.addWords(words[1], sID::CMDLET);
+	kc_identifiers.addWords(words[2], sID::ALIAS);
+	kc_identifiers.addWords(words[5], sID::CMDLETPARAMPARAM);
+
+	kc_parameters.clear(false);
+	kc_parameters.addWords(words[3], sID::OPERATOR);
+
+	kc_types.clear(false);
+	kc_types.addWords(words[4], sID::CMDLETPARAMATTRIB);
 }
 
 
@@ -693,6 +867,26 @@ void PowerShell_Lexer::updateHighlighterStyles()
 	}
 }
 
+//  Switches highlighter i on when bit i of activeBits is set, for running without a style
+//  configuration to read them from.
+void PowerShell_Lexer::activateHighlighters(int activeBits)
+{
+	for ( size_t i = 0; i < Hlite.size(); i++ ) {
+		Hlite[i].Active = ( ( activeBits & ( 1 << i ) ) != 0 );
+	}
+}
+
+//  Whether a lex starting at startPos is going to process the full document, without
+//  clearing any of the flags that say so.
+bool PowerShell_Lexer::needsFullDoc( int startPos ) const
+{
+	const DocumentState& doc = *pDocState;
+
+	return ( ( !npp_plugin::isNppReady() ) || ( doc.languageChanged ) ||
+			( doc.docModified && ( startPos == 0 ) ) || ( HliteStyleChanged ) ||
+			( StylesUpdatedCall ) || ( doc.stylesGeneration != stylesGeneration ) );
+}
+
 //  Determine if the full document should be processed.
 bool PowerShell_Lexer::doFullDoc( int startPos )
 {
@@ -700,54 +894,28 @@ bool PowerShell_Lexer::doFullDoc( int startPos )
 	//  highlighters are applied correctly and to avoid future calls to apply highlighters
 	//  when they aren't needed.
 
-	bool retVal = false;
-
-	retVal = !npp_plugin::isNppReady();
-
-	if ( lexer.languageChanged ) {
-		lexer.languageChanged = false;
-		retVal = true;
-	}
+	bool retVal = needsFullDoc( startPos );
 
-	if ( lexer.docModified ) {
-		lexer.docModified = false;
-			if ( startPos == 0 ) retVal = true;
-	}
+	DocumentState& doc = *lexer.pDocState;
+	doc.languageChanged = false;
+	doc.docModified = false;
 
-	if ( lexer.HliteStyleChanged ) {
+	//  Style changes leave every document behind, not just the one being lexed.
+	if ( lexer.HliteStyleChanged || lexer.StylesUpdatedCall ) {
 		lexer.HliteStyleChanged = false;
-		retVal = true;
-	}
-
-	if ( lexer.StylesUpdatedCall ) {
 		lexer.StylesUpdatedCall = false;
-		retVal = true;
+		lexer.stylesGeneration++;
 	}
 
-	if ( retVal ) lexer.fullDocProcessing = true;
+	if ( retVal ) {
+		lexer.fullDocProcessing = true;
+		doc.stylesGeneration = lexer.stylesGeneration;
+	}
 
 	return ( retVal );
 
 }
 
-//  Re-Activates the Notepad++ view that was active prior to processing WORDSTYLESUPDATED when
-//  a second view needed updating as well.
-void PowerShell_Lexer::activateAltView()
-{
-	lexer.StylesUpdatedCall = true;
-	lexer.processAltView = false;
-	int targetView = ( npp_plugin::intCurrView() == 0 ) ? ( 1 ) : ( 0 );
-	int targetIndex = messageProc( NPPM_GETCURRENTDOCINDEX, 0, targetView );
-
-	messageProc( NPPM_ACTIVATEDOC, targetView, targetIndex );
-
-	//  This routine would typically be called only when the Style Configurator is active, so
-	//  focus needs to get back to it.
-	//HWND dlgTarget = ::FindWindowW( NULL, TEXT("Style Configurator") );
-	if (lexer.prevHwndFocused) ::SetFocus( lexer.prevHwndFocused );
-	lexer.prevHwndFocused = NULL;
-}
-
 
 //  Returns a start position that shouldn't break multiline embedded styles.
 int PowerShell_Lexer::getSafe_Style_StartPos( int currPos )
@@ -758,11 +926,15 @@ int PowerShell_Lexer::getSafe_Style_StartPos( int currPos )
 	
 	while ( ( currLine > 0 ) && !bSafePos ) {
 		
-		if (! lexer.IsSafe_Style_currPos(  _pAccessor->StyleAt( _pAccessor->LineStart( currLine ) ) ) ||
-			( lexer.lineState.IsMultilineStyle( currLine ) ) ||
+		if ( lexer.pDocState->checkpoints.find( currLine ) ) {
+			//  Colourise_Doc can pick up from here with the full nesting state.
+			bSafePos = true;
+		}
+		else if (! lexer.IsSafe_Style_currPos(  _pAccessor->StyleAt( _pAccessor->LineStart( currLine ) ) ) ||
+			( lexer.pDocState->lineState.IsMultilineStyle( currLine ) ) ||
 			( ( currLine > 1 ) &&
 			(! lexer.IsSafe_Style_prevEOL( _pAccessor->StyleAt( _pAccessor->LineStart( currLine - 1 ) ) ) ) ||
-			( lexer.lineState.IsMultilineStyle( currLine - 1 ) ) ) ) {
+			( lexer.pDocState->lineState.IsMultilineStyle( currLine - 1 ) ) ) ) {
 			currLine--;
 		}
 		else bSafePos = true;
@@ -843,39 +1015,50 @@ bool PowerShell_Lexer::IsCommentStyle(int style)
 			style == sID::MULTILINECOMMENT;
 }
 
-// This routine is used in identifying successive HashComment lines
-bool PowerShell_Lexer::IsHashCommentLine(int line)
+// Brackets in these states are ones SCI_BRACEMATCH would pair up (they end up as OPERATOR)
+bool PowerShell_Lexer::IsBraceState(int state)
 {
-	int pos = _pAccessor->LineStart(line);
-	int eol_pos = _pAccessor->LineStart(line + 1) - 1;
-
-	for (int i = pos; i < eol_pos; i++) {
-		char ch = _pAccessor->SafeGetCharAt( i );
-		if (ch == '#')
-			return true;
-		else if (ch != ' ' && ch != '\t')
-			return false;
+	return	state != sID::COMMENT &&
+			state != sID::MULTILINECOMMENT &&
+			state != sID::STRING &&
+			state != sID::STRINGLITERAL &&
+			state != sID::HERESTRING &&
+			state != sID::HERESTRINGLITERAL &&
+			state != sID::VARIABLE;
+}
+
+//  Returns the position of the bracket matching the one at pos, or -1.
+//  Only falls back on SCI_BRACEMATCH, sent to the window being lexed, when the bracket pairs
+//  don't cover pos yet.
+int PowerShell_Lexer::braceMatch(int pos)
+{
+	int matchPos = pDocState->braces.find( pos, _pAccessor->Length() );
+
+	if ( matchPos == BracePairs::UNKNOWN ) {
+		if ( hLexWindow ) {
+			//  SCI_BRACEMATCH goes by the styles in the window, so send any still held first.
+			_pAccessor->Flush();
+			matchPos = ::SendMessage( hLexWindow, SCI_BRACEMATCH, pos, 0 );
+		}
+		else matchPos = -1;
 	}
 
-	return false;
+	return ( matchPos );
 }
 
 int PowerShell_Lexer::getSafe_Hlite_Pos(int currPos, int length, bool direction)
 {
-	//	This function checks for a line that does not have a linestate value indicating a
-	//  multiline indicator and returns the lines start or end position depending on direction.
-	int lineChange;
+	//	This function finds the nearest line above or below that isn't part of a multiline
+	//  highlight and returns its start position, or -1 when already at the top or bottom.
 	int extremeLine;
 	int currLine;
 
 	// Search parameters
 	if ( direction ) {			// DIR_UP
-		lineChange = -1;
 		extremeLine = 1;
 		currLine = _pAccessor->GetLine(currPos);
 	}
 	else {						// DIR_DOWN
-		lineChange = 1;
 		extremeLine = _pAccessor->GetLine( _pAccessor->Length() );
 		currLine = _pAccessor->GetLine( currPos + length );
 	}
@@ -883,34 +1066,438 @@ int PowerShell_Lexer::getSafe_Hlite_Pos(int currPos, int length, bool direction)
 	// If we are already at the top or bottom of the buffer just return
 	if (currLine == extremeLine) return -1;
 
-	int tmpLine = currLine;
-	do {
-
-		/*
-		 *  This works by checking the current line for a multiline state, if one is found
-		 *  the current line changes to that value.  If one is found, but the value is the same
-		 *  ( or higher - which shouldn't happen ) the current line value changes by one and 
-		 *  the check is done again until successfully finding a blank line or the extreme
-		 *  top or bottom of the doc is hit.
-		 *  
-		 */
-
-		if ( direction ) {
-			tmpLine = lexer.lineState.getMultilineStart( currLine );
-			if (! tmpLine ) break;			//  A blank line.  Forcefully escape the do loop.
-			
-			currLine = ( tmpLine < currLine ) ? ( tmpLine ) : ( currLine + lineChange );
+	//  Runs of highlighted lines are merged, so one lookup finds the edge.
+	if ( direction ) {
+		int runStart = lexer.pDocState->lineState.getMultilineStart( currLine );
+		if ( runStart != -1 ) currLine = ( runStart > 0 ) ? ( runStart - 1 ) : ( 0 );
+	}
+	else {
+		int runEnd = lexer.pDocState->lineState.getMultilineEnd( currLine );
+		if ( runEnd != -1 ) currLine = ( runEnd < extremeLine ) ? ( runEnd + 1 ) : ( extremeLine );
+	}
+
+	return ( _pAccessor->LineStart( currLine ) );
+}
+
+
+//  Backs a fold range up a line to fix broken states/folds.
+void backUpFoldStart(Accessor &styler, unsigned int &startPos, int &length, int &initStyle)
+{
+	int lineCurrent = styler.GetLine(startPos);
+	if (lineCurrent > 0) {
+		lineCurrent--;
+		int newStartPos = styler.LineStart(lineCurrent);
+		length += startPos - newStartPos;
+		startPos = newStartPos;
+		initStyle = 0;
+		if (startPos > 0) {
+			initStyle = styler.StyleAt(startPos - 1);
 		}
-		else {
-			tmpLine = lexer.lineState.getMultilineEnd( currLine );
-			if (! tmpLine ) break;			//  A blank line.  Forcefully escape the do loop.
-			
-			currLine = tmpLine > currLine ? tmpLine : currLine + lineChange;
+	}
+}
+
+
+//  <--- Fused Scan --->
+//  The bytes a fused scan's folding stops at in a run: line ends, and brackets and fold markers
+//  where they count.
+lIface::ByteScanner scanFoldLines("\r\n");
+lIface::ByteScanner scanFoldBrackets("(){}\r\n");
+lIface::ByteScanner scanFoldMarkers("#\r\n");
+lIface::ByteScanner scanFoldAll("#(){}\r\n");
+
+//  Highlights and folds a range from the style runs Colourise_Doc writes through a RunAccessor,
+//  as it writes them, so the range is only scanned the once.  A run is taken when the next one
+//  starts and its style is settled.  Highlighting goes by where a style starts and ends, and
+//  folding only stops at the bytes of a run it acts on.  Highlights reaching to a bracket are
+//  held until Colourise_Doc is done and the bracket pairs are complete.
+class FusedScan : public lIface::RunAccessor::RunListener
+{
+public:
+	FusedScan(lIface::RunAccessor &styler, int colourStart, int colourEnd, int initStyle,
+	          int hliteStart, int hliteEnd);
+
+	virtual void styled(int start, int end, int style);
+
+	//  Draws the held highlights and sets the fold levels.
+	void finish();
+
+	bool folding() const { return (_fold); }
+	int foldStart() const { return (_foldStart); }
+
+private:
+	struct Run {
+		int start;
+		int end;
+		int style;
+	};
+
+	struct BraceHlite {
+		int pos;
+		int matchFrom;
+		int indicator;
+	};
+
+	void takeRun(int styleAfter);
+	void hliteRun(const Run &run);
+	void foldRun(const Run &run, int styleBefore, int styleAfter);
+	void startLine(int lineStart);
+	void endLine(int nextLineStart);
+	unsigned char classifyLine(int lineStart);
+
+	lIface::RunAccessor &_styler;
+	lIface::TextSnapshot _text;
+	int _lenDoc;
+	int _colourStart;
+	int _colourEnd;
+	Run _run;					//  The run being written.
+	int _styleBefore;			//  The style before _run.
+
+	bool _drawHlites;
+	int _hliteStart;
+	int _hliteEnd;
+	int _hlitedTo;				//  Past the last run highlighted, where its style carries on past the range.
+	std::vector<BraceHlite> _braceHlites;
+
+	bool _fold;
+	FoldOptions _options;
+	int _foldStart;
+	int _foldLine;				//  Document line of _lines[0].
+	int _lineStart;				//  The line being folded.
+	lIface::LineFold _lineFold;
+	unsigned char _prevClass;	//  FoldText::LineClass of the line before it.
+	unsigned char _lineClass;
+	bool _commentEnd;			//  The line ended in a single line comment.
+	std::vector<lIface::LineFold> _lines;
+};
+
+FusedScan::FusedScan(lIface::RunAccessor &styler, int colourStart, int colourEnd, int initStyle,
+                     int hliteStart, int hliteEnd)
+	:_styler(styler), _text(styler), _colourStart(colourStart), _colourEnd(colourEnd),
+	_styleBefore(initStyle), _hliteStart(hliteStart), _hliteEnd(hliteEnd), _hlitedTo(colourEnd),
+	_foldStart(colourStart), _foldLine(0), _lineStart(colourStart), _prevClass(0), _lineClass(0),
+	_commentEnd(false)
+{
+	_lenDoc = styler.Length();
+	_run.start = colourStart;
+	_run.end = colourStart;
+	_run.style = initStyle;
+
+	_drawHlites = Clear_Hlites(hliteStart, hliteEnd - hliteStart, styler);
+
+	_fold = (styler.GetPropertyInt("fold") != 0);
+	if (! _fold) return;
+
+	Fold_Options(styler, _options);
+
+	// Folding starts a line early to fix broken folds, that line going by the styles it has.
+	unsigned int foldStart = colourStart;
+	int foldLength = colourEnd - colourStart;
+	backUpFoldStart(styler, foldStart, foldLength, _styleBefore);
+	_foldStart = foldStart;
+	_run.start = _foldStart;
+	_run.end = _foldStart;
+
+	_foldLine = styler.GetLine(_foldStart);
+	if (_foldLine > 0) _lineClass = classifyLine(styler.LineStart(_foldLine - 1));
+	startLine(_foldStart);
+
+	for (int pos = _foldStart; pos < colourStart; pos++) styled(pos, pos + 1, styler.StyleAt(pos));
+}
+
+void FusedScan::styled(int start, int end, int style)
+{
+	if ((_run.end > _run.start) && (start == _run.end) && (style == _run.style)) {
+		_run.end = end;
+		return;
+	}
+
+	takeRun(style);
+	_run.start = start;
+	_run.end = end;
+	_run.style = style;
+}
+
+void FusedScan::takeRun(int styleAfter)
+{
+	if (_run.end <= _run.start) return;
+
+	if (_drawHlites) hliteRun(_run);
+	if (_fold) foldRun(_run, _styleBefore, styleAfter);
+	_styleBefore = _run.style;
+}
+
+//  Highlights what of the run starts in both the highlight range and the colouring range;
+//  Draw_Hlites takes the rest of the highlight range in finish().
+void FusedScan::hliteRun(const Run &run)
+{
+	int start = (std::max)((std::max)(run.start, _hliteStart), _colourStart);
+	int stop = (std::min)(run.end, _hliteEnd);
+	if (start >= stop) return;
+
+	int end = run.end;
+	int currHlite;
+
+	switch (run.style)
+	{
+		case sID::OPERATOR:			// Capture expressions and apply highlight
+			currHlite = sID::INDICEXPR - INDICBASE;
+			if ( lexer.Hlite[currHlite].Active ) {
+				for (int pos = start; pos < stop; pos++) {
+					if ((_text.charAt(pos, _lenDoc) == '$') && (_text.charAt(pos + 1, _lenDoc) == '(')) {
+						BraceHlite hlite = { pos, pos + 1, sID::INDICEXPR };
+						_braceHlites.push_back(hlite);
+					}
+				}
+			}
+			break;
+		case sID::PARAMETER:
+		case sID::PROPERTY:
+		case sID::METHOD:
+			currHlite = ( (run.style == sID::PARAMETER) ? (sID::INDICPARM) :
+				( (run.style == sID::PROPERTY) ? (sID::INDICPROP) : (sID::INDICMETH) ) ) - INDICBASE;
+			if (! lexer.Hlite[currHlite].Active ) break;
+
+			// The last run's style may carry on past the range.
+			if (end >= _colourEnd) {
+				while ((end < _lenDoc) && (_styler.StyleAt(end) == run.style)) end++;
+				if (end > _hlitedTo) _hlitedTo = end;
+			}
+
+			if (run.style == sID::METHOD) {
+				BraceHlite hlite = { start, end, sID::INDICMETH };
+				_braceHlites.push_back(hlite);
+			}
+			else _styler.IndicatorFill(start, end, currHlite, currHlite + INDICBASE);
+			break;
+	}
+}
+
+//  The fold changes Fold_Line finds in the run's characters, going by their bytes of interest.
+void FusedScan::foldRun(const Run &run, int styleBefore, int styleAfter)
+{
+	bool comment = _options.foldComment && lexer.IsCommentStyle(run.style);
+	bool multiline = comment && _options.foldMultilineComment && (run.style == sID::MULTILINECOMMENT);
+	bool successive = comment && _options.foldSuccessiveHashComment && (run.style == sID::COMMENT);
+	bool brackets = (run.style == sID::OPERATOR) ||
+		(_options.foldWithinMultilineComment && (run.style == sID::MULTILINECOMMENT));
+	const lIface::ByteScanner &scanner = comment ? (brackets ? scanFoldAll : scanFoldMarkers) :
+		(brackets ? scanFoldBrackets : scanFoldLines);
+
+	// Multiline comment folding
+	if (multiline && (styleBefore != sID::MULTILINECOMMENT)) {
+		_lineFold.delta++;
+	}
+
+	for (int pos = run.start; pos < run.end; pos++) {
+		pos += _text.span(scanner, pos, run.end);
+		if (pos >= run.end) break;
+
+		char ch = _text.charAt(pos, _lenDoc);
+		char chNext = _text.charAt(pos + 1, _lenDoc);
+
+		if (lexer.IsEOL(ch, chNext)) {
+			// Successive single line comment folding, once the next line is known.
+			if (successive) _commentEnd = true;
+			endLine(pos + 1);
 		}
+		else if (ch == '#') {
+			// Manual fold point marker
+			if (chNext == '#') {
+				char chNext2 = _text.charAt(pos + 2, _lenDoc);
+				if (chNext2 == '{') {
+					_lineFold.delta++;
+				} else if (chNext2 == '}') {
+					_lineFold.delta--;
+				}
+			}
+		}
+		else if (ch == '{' || ch == '(') {
+			// Measure the minimum before a '{' to allow
+			// folding on "} else {"
+			if (_lineFold.minDelta > _lineFold.delta) {
+				_lineFold.minDelta = _lineFold.delta;
+			}
+			_lineFold.delta++;
+		} else if (ch == '}' || ch == ')') {
+			_lineFold.delta--;
+		}
+	}
 
-	} while ( ( direction ) ? ( currLine > extremeLine ) : ( currLine < extremeLine ) );
+	// Comments don't end at end of line and the next character may be unstyled.
+	if (multiline && ((run.end - run.start > 1) || (styleBefore == sID::MULTILINECOMMENT)) &&
+			(styleAfter != sID::MULTILINECOMMENT) &&
+			!lexer.IsEOL(_text.charAt(run.end - 1, _lenDoc), _text.charAt(run.end, _lenDoc))) {
+		_lineFold.delta--;
+	}
+}
 
-	return ( _pAccessor->LineStart( currLine ) );
+void FusedScan::startLine(int lineStart)
+{
+	_lineStart = lineStart;
+	_prevClass = _lineClass;
+	_lineClass = classifyLine(lineStart);
+
+	lIface::LineFold fold = { 0, 0, (_lineClass & lIface::FoldText::LINE_VISIBLE) != 0 };
+	_lineFold = fold;
+}
+
+void FusedScan::endLine(int nextLineStart)
+{
+	unsigned char classBefore = _prevClass;
+	_lines.push_back(_lineFold);
+	startLine(nextLineStart);
+
+	if (_commentEnd) {
+		bool commentBefore = (classBefore & lIface::FoldText::LINE_COMMENT) != 0;
+		bool commentAfter = (_lineClass & lIface::FoldText::LINE_COMMENT) != 0;
+		if (! commentBefore && commentAfter) {
+			_lines.back().delta++;
+		}
+		else if (commentBefore && !commentAfter) {
+			_lines.back().delta--;
+		}
+		_commentEnd = false;
+	}
+}
+
+//  Classifies the line as FoldText does, with "#" for the comment leader.
+unsigned char FusedScan::classifyLine(int lineStart)
+{
+	unsigned char lineClass = 0;
+	int pos = lineStart;
+
+	while ((pos < _lenDoc) && ((_text.charAt(pos, _lenDoc) == ' ') || (_text.charAt(pos, _lenDoc) == '\t'))) pos++;
+	if ((pos < _lenDoc) && (_text.charAt(pos, _lenDoc) == '#')) lineClass |= lIface::FoldText::LINE_COMMENT;
+
+	for (; pos < _lenDoc; pos++) {
+		char ch = _text.charAt(pos, _lenDoc);
+		if ((ch == '\r') || (ch == '\n')) break;
+		if ((ch != ' ') && ((ch < 0x09) || (ch > 0x0D))) {
+			lineClass |= lIface::FoldText::LINE_VISIBLE;
+			break;
+		}
+	}
+
+	return (lineClass);
+}
+
+void FusedScan::finish()
+{
+	takeRun((_run.end < _lenDoc) ? (_styler.StyleAt(_run.end)) : (0));
+	_run.start = _run.end;
+
+	if (_drawHlites) {
+		if (_hliteStart < _colourStart) Draw_Hlites(_hliteStart, (std::min)(_colourStart, _hliteEnd), _styler);
+		for (size_t i = 0; i < _braceHlites.size(); i++) {
+			Hlite_ToBrace(_braceHlites[i].pos, _braceHlites[i].matchFrom, _braceHlites[i].indicator, _styler);
+		}
+		if (_hlitedTo < _hliteEnd) Draw_Hlites(_hlitedTo, _hliteEnd, _styler);
+	}
+
+	if (_fold) {
+		// The last line, when the range cuts it short.
+		bool lastEnded = (_lineStart >= _colourEnd);
+		if (! lastEnded) _lines.push_back(_lineFold);
+
+		int levelCurrent = SC_FOLDLEVELBASE;
+		if (_foldLine > 0)
+			levelCurrent = _styler.LevelAt(_foldLine - 1) >> 16;
+
+		std::vector<lIface::LineLevels> levels(_lines.size());
+		for (size_t n = 0; n < _lines.size(); n++) {
+			levels[n].start = levelCurrent;
+			levels[n].min = levelCurrent + _lines[n].minDelta;
+			levelCurrent += _lines[n].delta;
+			levels[n].end = levelCurrent;
+			levels[n].visible = _lines[n].visible;
+			levels[n].ended = true;
+		}
+		if (! levels.empty()) levels.back().ended = lastEnded;
+
+		// Flag and level controls
+		Fold_SetLevels(_styler, _foldLine, levels, _options);
+	}
+}
+
+
+//  <--- Chunked Lexing --->
+const int CHUNK_LINES = 500;		//  Lines per SCI_COLOURISE while catching up.
+const UINT CHUNK_INTERVAL = 10;		//  Milliseconds; timer messages only arrive when Notepad++ is idle.
+
+//  Returns the position just past the lines hView shows, plus margin lines.
+int visibleEndPos( HWND hView, int margin )
+{
+	int firstVisible = ::SendMessage( hView, SCI_GETFIRSTVISIBLELINE, 0, 0 );
+	int linesOnScreen = ::SendMessage( hView, SCI_LINESONSCREEN, 0, 0 );
+	int lastLine = ::SendMessage( hView, SCI_DOCLINEFROMVISIBLE, firstVisible + linesOnScreen, 0 ) + margin;
+
+	int endPos = ::SendMessage( hView, SCI_POSITIONFROMLINE, lastLine + 1, 0 );
+	return ( ( endPos < 0 ) ? ( ::SendMessage( hView, SCI_GETLENGTH, 0, 0 ) ) : ( endPos ) );
+}
+
+//  Returns true while less than ticks have passed since started.
+bool withinBudget( const LARGE_INTEGER& started, LONGLONG ticks )
+{
+	LARGE_INTEGER now;
+	::QueryPerformanceCounter( &now );
+	return ( now.QuadPart - started.QuadPart < ticks );
+}
+
+//  Timer callback lexing what is left of each pending view from where its styling ends, until
+//  the view is done or its budget for this call is spent.  Scintilla's own lexer calls do the
+//  work, so edits and scrolling in the meantime are simply picked up from SCI_GETENDSTYLED.
+void CALLBACK lexPendingChunks( HWND, UINT, UINT_PTR, DWORD )
+{
+	int psLexerID = lIface::getSCILexerIDByName("PowerShell*");
+
+	std::map<HWND, PowerShell_Lexer::ChunkPending>::iterator pending = lexer.chunkPending.begin();
+	while ( pending != lexer.chunkPending.end() ) {
+		HWND hView = pending->first;
+		LARGE_INTEGER started;
+		::QueryPerformanceCounter( &started );
+
+		//  Stop on a view that moved on to another document or language.
+		bool done = ( reinterpret_cast<void*>( ::SendMessage( hView, SCI_GETDOCPOINTER, 0, 0 ) ) != pending->second.pDoc ) ||
+				( ::SendMessage( hView, SCI_GETLEXER, 0, 0 ) != psLexerID );
+
+		while ( ( !done ) && withinBudget( started, pending->second.budgetTicks ) ) {
+			int lengthDoc = ::SendMessage( hView, SCI_GETLENGTH, 0, 0 );
+			int endStyled = ::SendMessage( hView, SCI_GETENDSTYLED, 0, 0 );
+			if ( endStyled >= lengthDoc ) {
+				done = true;
+				break;
+			}
+
+			int chunkLine = ::SendMessage( hView, SCI_LINEFROMPOSITION, endStyled, 0 ) + CHUNK_LINES;
+			int chunkEnd = ::SendMessage( hView, SCI_POSITIONFROMLINE, chunkLine, 0 );
+			if ( ( chunkEnd < 0 ) || ( chunkEnd > lengthDoc ) ) chunkEnd = lengthDoc;
+
+			::SendMessage( hView, SCI_COLOURISE, endStyled, chunkEnd );
+
+			//  Don't spin on a range that won't style.
+			if ( ::SendMessage( hView, SCI_GETENDSTYLED, 0, 0 ) <= endStyled ) done = true;
+		}
+
+		if ( done ) lexer.chunkPending.erase( pending++ );
+		else ++pending;
+	}
+
+	if ( lexer.chunkPending.empty() ) {
+		::KillTimer( NULL, lexer.chunkTimer );
+		lexer.chunkTimer = 0;
+	}
+}
+
+//  Leaves the rest of hView's document to lexPendingChunks(), budget milliseconds per call.
+void queueLexChunks( HWND hView, int budget )
+{
+	LARGE_INTEGER perfFreq;
+	::QueryPerformanceFrequency( &perfFreq );
+
+	PowerShell_Lexer::ChunkPending& pending = lexer.chunkPending[hView];
+	pending.pDoc = reinterpret_cast<void*>( ::SendMessage( hView, SCI_GETDOCPOINTER, 0, 0 ) );
+	pending.budgetTicks = perfFreq.QuadPart * ( ( budget > 0 ) ? ( budget ) : ( 1 ) ) / 1000;
+	if ( lexer.chunkTimer == 0 ) lexer.chunkTimer = ::SetTimer( NULL, 0, CHUNK_INTERVAL, lexPendingChunks );
 }
 
 
@@ -921,14 +1508,44 @@ int PowerShell_Lexer::getSafe_Hlite_Pos(int currPos, int length, bool direction)
 void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
                   char *words[], WindowID window, char *props)
 {
-	// Create and initialize the WindowAccessor (including contained PropSet)
-	PropSet ps;
-	ps.SetMultiple(props);
-	WindowAccessor wa(window, ps);
-
 	// Set the currView handle to at update at least once per lexer call.
 	npp_plugin::hCurrViewNeedsUpdate();
 
+	// Everything the lexer keeps between calls belongs to the document being lexed.
+	void* pDoc = reinterpret_cast<void*>(
+		::SendMessage( static_cast<HWND>( window ), SCI_GETDOCPOINTER, 0, 0 ) );
+
+	lexer.hLexWindow = static_cast<HWND>( window );
+	lexer.pDocState = &lexer.documents[pDoc];
+
+	// A document first seen here is tied to its file, so closing the file drops its state.
+	if ( ( lexer.pDocState->bufferID == NULL ) && ( lexer.hLexWindow == npp_plugin::hCurrView() ) )
+		lexer.pDocState->bufferID = reinterpret_cast<void*>( messageProc( NPPM_GETCURRENTBUFFERID, 0, 0 ) );
+
+	// A lex that is going to take in the whole document tells the accessor so up front.
+	unsigned int textStart = startPos;
+	int textLength = length;
+	if ( ( !foldOrLex ) && lexer.needsFullDoc( startPos ) ) {
+		textStart = 0;
+		textLength = ::SendMessage( lexer.hLexWindow, SCI_GETLENGTH, 0, 0 );
+	}
+
+	// Create the accessor over the document text, properties only parsed again when they change.
+	lIface::DirectAccessor wa(window, inputs.properties(props), textStart, textLength);
+
+	LexOrFold(foldOrLex, startPos, length, initStyle, words, wa);
+	lexer.hLexWindow = NULL;
+	lexer.pDocState = NULL;
+}
+
+//  Accessor entry point, used by the Scintilla entry point and by the lexer benchmark.
+void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
+                  char *words[], Accessor &wa)
+{
+	// Without a window ( the benchmark ) the state is kept as if for a document of its own.
+	bool ownDocState = ( lexer.pDocState == NULL );
+	if ( ownDocState ) lexer.pDocState = &lexer.documents[NULL];
+
 	// Initialize the lexer.  Ater the first run this just updates the Accessor.
 	lexer.initLexer(words, wa);
 
@@ -939,22 +1556,19 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
 
 	// foldOrLex is false for lex and true for fold
 	if (foldOrLex) {
-		// Back up a line to fix broken states/folds
-		int lineCurrent = wa.GetLine(startPos);
-		if (lineCurrent > 0) {
-			lineCurrent--;
-			int newStartPos = wa.LineStart(lineCurrent);
-			length += startPos - newStartPos;
-			startPos = newStartPos;
-			initStyle = 0;
-			if (startPos > 0) {
-				initStyle = wa.StyleAt(startPos - 1);
-			}
-		}
-		Fold_Doc(startPos, length, initStyle, wa);
+		backUpFoldStart(wa, startPos, length, initStyle);
+
+		// Skip ranges the lex call just before this already folded.
+		bool alreadyFolded = lexer.foldedByLex && ( int(startPos) >= lexer.foldedStart ) &&
+				( int(startPos) + length <= lexer.foldedEnd );
+		lexer.foldedByLex = false;
+
+		if (! alreadyFolded) Fold_Doc(startPos, length, initStyle, wa);
 
 	}
 	else {
+		lexer.foldedByLex = false;
+
 		// Styling entry point.	
 		int colourStartPos = startPos;
 		int colourLength = length;
@@ -969,6 +1583,20 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
 			colourLength = wa.Length();
 			hliteStartPos = 0;
 			hliteLength = wa.Length();
+
+			//  With a view to go by, only the lines it shows are lexed now and the rest of the
+			//  document is left for the timer, so large files don't hold up the UI.
+			if ( lexer.hLexWindow && ( wa.GetPropertyInt( "lexer.powershell.chunked", 1 ) != 0 ) ) {
+				int chunkEnd = visibleEndPos( lexer.hLexWindow,
+						wa.GetPropertyInt( "lexer.powershell.chunk.margin", 100 ) );
+				if ( chunkEnd < int( startPos ) + length ) chunkEnd = startPos + length;
+
+				if ( chunkEnd < colourLength ) {
+					colourLength = chunkEnd;
+					hliteLength = chunkEnd;
+					queueLexChunks( lexer.hLexWindow, wa.GetPropertyInt( "lexer.powershell.chunk.budget", 20 ) );
+				}
+			}
 		}
 		else {
 			// Find a safe entry point to ensure styles and highlighters aren't broken.
@@ -979,6 +1607,7 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
 
 				//  Find the highlighting startPos and endPos.
 				hliteStartPos = lexer.getSafe_Hlite_Pos( startPos, length, DIR_UP );
+				if ( hliteStartPos == -1 ) hliteStartPos = 0;
 				int hliteEndPos = lexer.getSafe_Hlite_Pos( startPos, length, DIR_DOWN );
 				int tmphliteLength = ( hliteEndPos == -1 ) ? ( length ) : ( hliteEndPos - hliteStartPos );
 				int currLineLength = sizeof( wa.GetLine( hliteStartPos ) );
@@ -988,21 +1617,62 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
 
 		// Do the main coloring routine
 		colourInitStyle = wa.StyleAt( colourStartPos - 1 );
-		Colourise_Doc( colourStartPos, colourLength, colourInitStyle, wa );
 
-		wa.Flush();
+		if ( wa.GetPropertyInt( "lexer.powershell.fused", 1 ) != 0 ) {
+			//  Colourise, highlight, and fold in this one call and one scan of the range: the
+			//  FusedScan highlights and folds from each style run as Colourise_Doc writes it, and
+			//  the styles, indicators and fold levels are all sent when the RunAccessor is flushed.
+			lIface::RunAccessor ra( wa );
+			if ( lexer.hLexWindow ) ra.setIndicatorShadow( &lexer.pDocState->indicators );
+
+			FusedScan scan( ra, colourStartPos, colourStartPos + colourLength, colourInitStyle,
+					hliteStartPos, hliteStartPos + hliteLength );
+			ra.setRunListener( &scan );
+			Colourise_Doc( colourStartPos, colourLength, colourInitStyle, ra );
+			ra.setRunListener( NULL );
+			scan.finish();
+
+			if ( scan.folding() ) {
+				lexer.foldedByLex = true;
+				lexer.foldedStart = scan.foldStart();
+				lexer.foldedEnd = colourStartPos + colourLength;
+			}
+
+			ra.Flush();
+		}
+		else {
+			Colourise_Doc( colourStartPos, colourLength, colourInitStyle, wa );
+
+			wa.Flush();
+
+			hliteInitStyle = wa.StyleAt( hliteStartPos - 1 );
+			Highlight_Doc( hliteStartPos, hliteLength, hliteInitStyle, wa );
 
-		hliteInitStyle = wa.StyleAt( hliteStartPos - 1 );
-		Highlight_Doc( hliteStartPos, hliteLength, hliteInitStyle, wa );
+			//  Indicators went straight to the document, so its shadow no longer knows them.
+			lexer.pDocState->indicators.clear();
+		}
 
 		lexer.fullDocProcessing = false;	//  Make sure this is turned off!
 	}
 
 	// clean up before leaving
 	wa.Flush();
-	if ( lexer.processAltView ) lexer.activateAltView();
+	if ( ownDocState ) lexer.pDocState = NULL;
 }
 
+#ifdef NPP_PLUGININTERFACE_LEXERBENCH
+//  The benchmark has no style configuration to read the highlighters from, so once the lexer
+//  is initialized they are switched on from the corpus properties instead.
+void benchSetup(char *words[], Accessor &props)
+{
+	lexer.pDocState = &lexer.documents[NULL];
+	lexer.initLexer(words, props);
+	lexer.pDocState = NULL;
+
+	lexer.activateHighlighters( props.GetPropertyInt( "lexer.powershell.highlighters", 0 ) );
+}
+#endif
+
 //  Notepad++ dialog entry point.
 void menuDlg()
 {
@@ -1027,35 +1697,79 @@ PowerShell_Lexer* getLexerObj() { return ( &lexer); }
 //*********************************************************************************************
 //  Notification Handlers.
 
-//  This notification handler updates the keyword lists and highlighters and forces a new lexing.
+//  This notification handler updates the keyword lists and highlighters and forces a new lexing
+//  of the PowerShell documents shown in either view, straight through each view's window so
+//  neither view changes documents or focus.  The first lexing after this bumps the styles
+//  generation, so documents not on view get their full lexing when they are activated.
 void WORDSTYLESUPDATEDproc()
 {
 	lexer.StylesUpdatedCall = true;
 	lexer.updateHighlighterStyles();
 
-	//  If another view open with a PowerShell document we need to update it as well.
-	int targetView = ( npp_plugin::intCurrView() == MAIN_VIEW ) ? ( SUB_VIEW ) : ( MAIN_VIEW );
-	int targetIndex = messageProc( NPPM_GETCURRENTDOCINDEX, 0, targetView );
+	int psLexerID = lIface::getSCILexerIDByName("PowerShell*");
+	int views[] = { MAIN_VIEW, SUB_VIEW };
 
-	HWND hTargetView = ( targetView == MAIN_VIEW ) ? ( npp_plugin::hMainView() ) : ( npp_plugin::hSecondView() );
-	int targetSCILEXERID = ::SendMessage( hTargetView, SCI_GETLEXER, 0, 0 );
+	for ( int i = 0; i < 2; i++ ) {
+		//  A view without an open document has nothing to restyle.
+		if ( messageProc( NPPM_GETCURRENTDOCINDEX, 0, views[i] ) < 0 ) continue;
 
-	lexer.prevHwndFocused = ::GetFocus();
-	
-	if ( ( targetIndex >= 0 ) &&  ( targetSCILEXERID == lIface::getSCILexerIDByName("PowerShell*") ) ) {
-		//  The doc in the alternate view is open and needs updating.
-		lexer.processAltView = true;
-		messageProc( NPPM_ACTIVATEDOC, targetView, targetIndex );
+		HWND hView = ( views[i] == MAIN_VIEW ) ? ( npp_plugin::hMainView() ) : ( npp_plugin::hSecondView() );
+		if ( ::SendMessage( hView, SCI_GETLEXER, 0, 0 ) != psLexerID ) continue;
+
+		//  Restart styling and repaint; the paint has Scintilla lex what the view shows.
+		::SendMessage( hView, SCI_STARTSTYLING, -1, 0 );
+		::InvalidateRect( hView, NULL, FALSE );
 	}
-	else {
-		//  Restart styling for this view only.
+}
+
+//  This notification handler flags pDoc as modified and keeps its indicator shadow and
+//  multiline highlight runs lined up with the text inserted or deleted.
+void MODIFIEDproc( void* pDoc, int position, int length, bool inserted, int line, int linesAdded )
+{
+	std::map<void*, PowerShell_Lexer::DocumentState>::iterator doc = lexer.documents.find( pDoc );
+	if ( doc == lexer.documents.end() ) return;		//  Not lexed yet, so there's nothing to keep up.
+
+	doc->second.docModified = true;
+
+	if ( inserted ) doc->second.indicators.insertText( position, length );
+	else doc->second.indicators.deleteText( position, length );
+
+	if ( linesAdded != 0 ) doc->second.lineState.shiftMultilineState( line, linesAdded );
+}
+
+//  This notification handler only restyles a document being switched to when it hasn't been
+//  lexed yet or the styles changed since it was.
+void BUFFERACTIVATEDproc( void* bufferID, void* pDoc )
+{
+	PowerShell_Lexer::DocumentState& doc = lexer.documents[pDoc];
+	doc.bufferID = bufferID;
+
+	if ( doc.stylesGeneration != lexer.stylesGeneration ) {
+		doc.languageChanged = true;  // This flags for a full doc lexing.
 		messageProc(SCI_STARTSTYLING, -1, 0);
 	}
 }
 
-void setDocModified( bool modified ) { lexer.docModified = modified; };
+//  This notification handler flags a full lexing for a document switched to PowerShell.
+void LANGCHANGEDproc( void* bufferID, void* pDoc )
+{
+	PowerShell_Lexer::DocumentState& doc = lexer.documents[pDoc];
+	doc.bufferID = bufferID;
+	doc.languageChanged = true;
+}
 
-void setLanguageChanged( bool changed) { lexer.languageChanged = changed; };
+//  This notification handler drops the state of a document whose file is closing, before
+//  Scintilla can hand its document pointer to another file.  State that was never tied to a
+//  file may belong to the closing one, so it goes too and is rebuilt on the next lex.
+void FILEBEFORECLOSEproc( void* bufferID )
+{
+	std::map<void*, PowerShell_Lexer::DocumentState>::iterator doc = lexer.documents.begin();
+	while ( doc != lexer.documents.end() ) {
+		if ( ( doc->second.bufferID == bufferID ) || ( doc->second.bufferID == NULL ) )
+			lexer.documents.erase( doc++ );
+		else ++doc;
+	}
+}
 
 }	// End: namespace NppExtLexer_PowerShell
 
@@ -27,6 +27,9 @@
 #include "NppPlugin.h"				//  Provides all of the interface, messaging definitions,
 									//  and namespace aliases.
 
+#include <algorithm>				//  std::min and std::max.
+#include <map>						//  Per document state and highlight runs.
+
 
 namespace NppExtLexer_PowerShell {
 
@@ -100,15 +103,13 @@ struct StateNest
 	char GroupTerminator;
 };
 
+const int NB_BRACE_KINDS = 3;			// ( ), [ ], and { }
+
 
 class PowerShell_Lexer
 {
 public:
 	bool StylesUpdatedCall;		//  Flags the next lex call to only do Updating of Wordlists.
-	bool processAltView;		//  True if two views are open for this lang and WORDSTYLESCHANGED notification arrives.
-	HWND prevHwndFocused;
-	bool languageChanged;		//  Flag to ensure a full doc lexing when switching from a different language.
-	bool docModified;			//  Flag to help determine if lexing actually needs to be redone.
 	bool HliteStyleChanged;		//  Flag to cause all highlights to be removed from the doc and re-drawn. 
 	bool fullDocProcessing;		//  Flag to indicate that safe-entry routines shouldn't be called.
 
@@ -200,6 +201,8 @@ public:
 		friend class PowerShell_Lexer;
 
 	public:
+		LineState():_accessor(NULL){};
+
 		bool IsMultilineStyle ( int line )
 		{
 			_lineState.SCI_LineState = _accessor->GetLineState( line );
@@ -224,71 +227,90 @@ public:
 
 		};
 
-		bool IsMultiline( int line )
-		{
-
-			if (! ( line == _prevHliteLineChecked ) ) {
-				_lineState.SCI_LineState = _accessor->GetLineState( line );
-				setLineChecked( line );
-			}
-			
-			return ( _lineState.bits.multilineHlite );
+		/*
+		 *  Multiline highlights are tracked outside of Scintilla's line states as runs of
+		 *  highlighted lines, so there is no limit on line numbers and a run can be found
+		 *  without walking the lines.  Runs that touch or overlap are merged, which gives the
+		 *  same lines the old per-line flags did.  shiftMultilineState() keeps the runs in step
+		 *  with lines being added and removed.
+		 *
+		 */
 
-		};
+		bool IsMultiline( int line ) { return ( findRun( line ) != _hliteRuns.end() ); };
 
+		//  Returns the first line of the highlighted run holding line, or -1.
 		int getMultilineStart( int line )
 		{
-
-			if (! ( line == _prevHliteLineChecked ) ) {
-				_lineState.SCI_LineState = _accessor->GetLineState( line );
-				setLineChecked( line );
-			}
-
-			return ( _lineState.bits.startLine );
-
+			LineRuns::iterator run = findRun( line );
+			return ( ( run == _hliteRuns.end() ) ? ( -1 ) : ( run->first ) );
 		};
 
+		//  Returns the last line of the highlighted run holding line, or -1.
 		int getMultilineEnd( int line )
 		{
-
-			if (! ( line == _prevHliteLineChecked ) ) {
-				_lineState.SCI_LineState = _accessor->GetLineState( line );
-				setLineChecked(line);
-			}
-
-			return ( _lineState.bits.endLine );
-
+			LineRuns::iterator run = findRun( line );
+			return ( ( run == _hliteRuns.end() ) ? ( -1 ) : ( run->second ) );
 		};
 
 		void setMultlineState(int startLine, int endLine)
 		{
-
-			for (int currLine = startLine; currLine <= endLine; currLine++) {
-
-				_lineState.SCI_LineState = _accessor->GetLineState( currLine );
-				_lineState.bits.multilineHlite = true;
-				_lineState.bits.startLine = startLine;
-				_lineState.bits.endLine = endLine;
-				_accessor->SetLineState( currLine, _lineState.SCI_LineState );
-
+			//  Merge any runs that overlap or touch the new one.
+			LineRuns::iterator next = _hliteRuns.upper_bound( endLine + 1 );
+			while ( next != _hliteRuns.begin() ) {
+				LineRuns::iterator prev = next;
+				--prev;
+				if ( prev->second < startLine - 1 ) break;
+
+				if ( prev->first < startLine ) startLine = prev->first;
+				if ( prev->second > endLine ) endLine = prev->second;
+				_hliteRuns.erase( prev );
 			}
 
+			_hliteRuns[startLine] = endLine;
 		};
 
-		//  Clears the line state data from an Accessor.
+		//  Removes the lines from startLine to endLine from the highlighted runs.
 		void ClearMultilineState(int startLine, int endLine)
 		{
+			for (;;) {
+				LineRuns::iterator run = _hliteRuns.upper_bound( endLine );
+				if ( run == _hliteRuns.begin() ) break;
+				--run;
+				if ( run->second < startLine ) break;
+
+				int first = run->first;
+				int last = run->second;
+				_hliteRuns.erase( run );
+				if ( last > endLine ) _hliteRuns[endLine + 1] = last;
+				if ( first < startLine ) _hliteRuns[first] = startLine - 1;
+			}
+		};
 
-			for (int currLine = startLine; currLine <= endLine; currLine++) {
-
-				_lineState.SCI_LineState = _accessor->GetLineState( currLine );
-				_lineState.bits.multilineHlite = false;
-				_lineState.bits.startLine = 0;
-				_lineState.bits.endLine = 0;
-				_accessor->SetLineState( currLine, _lineState.SCI_LineState );
+		void resetMultilineState() { _hliteRuns.clear(); };
 
+		//  Moves the runs below line when linesAdded lines were inserted ( or removed when
+		//  negative ) by an edit starting on line.
+		void shiftMultilineState( int line, int linesAdded )
+		{
+			if ( linesAdded == 0 ) return;
+
+			//  Pull out every run that reaches past line.
+			std::vector< std::pair<int, int> > moved;
+			LineRuns::iterator run = _hliteRuns.upper_bound( line );
+			if ( ( run != _hliteRuns.begin() ) ) {
+				LineRuns::iterator prev = run;
+				--prev;
+				if ( prev->second > line ) run = prev;
+			}
+			moved.assign( run, _hliteRuns.end() );
+			_hliteRuns.erase( run, _hliteRuns.end() );
+
+			//  Lines removed by a delete collapse onto line.
+			for ( size_t i = 0; i < moved.size(); i++ ) {
+				int first = shiftLine( moved[i].first, line, linesAdded );
+				int last = shiftLine( moved[i].second, line, linesAdded );
+				setMultlineState( first, last );
 			}
-
 		};
 
 		//  Sets the accessor pointer
@@ -301,8 +323,9 @@ public:
 		typedef union
 		{
 			/*
-			 *  This union is used to store beginning and ending information for highlighters
-			 *  that span multiple lines.  Normally a call to Scintilla asking for the start 
+			 *  This union is used to store per line flags in Scintilla's line state.  The
+			 *  beginning and ending information for highlighters that span multiple lines is
+			 *  kept in _hliteRuns instead.  Normally a call to Scintilla asking for the start
 			 *  and end positions would work just fine.  This lexer can't use that due to
 			 *  removing the indicator from leading white space on multiline highlights.
 			 *
@@ -312,10 +335,7 @@ public:
 			{	
 				// 32 bit field for filling in styler linestate value
 				unsigned multilineStyle :1;		// Flags multiline style states that can embed other styles.
-				unsigned multilineHlite	:1;		// Flag for a highlight on the current line that spans multiple lines.
-				unsigned unused			:6;
-				unsigned startLine		:12;	// values up to 4095
-				unsigned endLine		:12;	// values up to 4095
+				unsigned unused			:31;
 
 			} bits;
 
@@ -324,22 +344,282 @@ public:
 		} LineStateStruct;
 		Accessor* _accessor;
 
-		void setLineChecked(int line) {
-			_prevHliteLineChecked = line;
+		LineStateStruct _lineState;
+
+		typedef std::map<int, int> LineRuns;		//  First line -> last line of a highlighted run.
+		LineRuns _hliteRuns;
+
+		//  Returns the run holding line, or _hliteRuns.end().
+		LineRuns::iterator findRun( int line )
+		{
+			LineRuns::iterator run = _hliteRuns.upper_bound( line );
+			if ( run == _hliteRuns.begin() ) return ( _hliteRuns.end() );
+			--run;
+			return ( ( run->second >= line ) ? ( run ) : ( _hliteRuns.end() ) );
 		};
 
-		LineStateStruct _lineState;
-		int _prevHliteLineChecked;
+		static int shiftLine( int currLine, int editLine, int linesAdded )
+		{
+			if ( currLine <= editLine ) return ( currLine );
+			if ( currLine + linesAdded < editLine ) return ( editLine );
+			return ( currLine + linesAdded );
+		};
 
 
 	}; // End: Class LineState
 
 	friend class LineState;
-	PowerShell_Lexer::LineState lineState;
+
+	class StateCheckpoints
+	{
+		/*
+		 *  Colourise_Doc's complete state at the start of each line it lexed, so a later call
+		 *  can resume at the line Scintilla asks for instead of backing up to a line that has
+		 *  a safe style.  Scintilla always starts a lex call at or before the first edit made
+		 *  since the last one, so the checkpoints up to the start line of a call are still good
+		 *  and the rest are dropped.
+		 *
+		 *  The checkpoints are kept in flat arrays: a fixed size entry per line, and the
+		 *  StateNest stacks and open bracket positions of all of the lines back to back in line
+		 *  order.  A line's checkpoint only appends to them, so storing one allocates nothing
+		 *  once the arrays have grown.
+		 *
+		 */
+
+	public:
+		struct Checkpoint
+		{
+			bool valid;
+			int state;
+			int prevWordState;
+			unsigned int GroupLevel;
+			bool VarNameExt;
+			unsigned int nestStart;			// Index of sn[0] in _nests.
+			unsigned int nbNest;			// iNL + 1
+			unsigned int braceStart;		// Index of the first open bracket in _braces.
+			unsigned int nbBraces[NB_BRACE_KINDS];
+		};
+
+		void clear()
+		{
+			_lines.clear();
+			_nests.clear();
+			_braces.clear();
+		};
+
+		//  Drops the checkpoints after line.
+		void truncate( int line )
+		{
+			if ( line + 1 < int( _lines.size() ) ) _lines.resize( ( line < 0 ) ? ( 0 ) : ( line + 1 ) );
+
+			//  The nests and brackets of the dropped lines were the last ones in the arrays.
+			int last = int( _lines.size() ) - 1;
+			while ( ( last >= 0 ) && !_lines[last].valid ) last--;
+			if ( last < 0 ) {
+				_nests.clear();
+				_braces.clear();
+			}
+			else {
+				_nests.resize( _lines[last].nestStart + _lines[last].nbNest );
+				_braces.resize( bracesEnd( _lines[last] ) );
+			}
+		};
+
+		//  Returns NULL when there is no checkpoint for line.
+		const Checkpoint* find( int line ) const
+		{
+			if ( ( line < 0 ) || ( line >= int( _lines.size() ) ) ) return ( NULL );
+			return ( _lines[line].valid ? ( &_lines[line] ) : ( NULL ) );
+		};
+
+		//  Copies the nesting saved with cp to sn and returns its iNL.
+		unsigned int restoreNest( const Checkpoint& cp, StateNest sn[] ) const
+		{
+			std::vector<StateNest>::const_iterator first = _nests.begin() + cp.nestStart;
+			std::copy( first, first + cp.nbNest, sn );
+			return ( cp.nbNest - 1 );
+		};
+
+		//  Copies the open brackets saved with cp to openBraces.
+		void restoreBraces( const Checkpoint& cp, std::vector<int> openBraces[] ) const
+		{
+			std::vector<int>::const_iterator first = _braces.begin() + cp.braceStart;
+			for ( int kind = 0; kind < NB_BRACE_KINDS; kind++ ) {
+				openBraces[kind].assign( first, first + cp.nbBraces[kind] );
+				first += cp.nbBraces[kind];
+			}
+		};
+
+		void store( int line, int state, int prevWordState, unsigned int GroupLevel, bool VarNameExt,
+				const StateNest sn[], unsigned int iNL, const std::vector<int> openBraces[] )
+		{
+			//  Lines from this one on are being lexed again.
+			truncate( line - 1 );
+
+			if ( line >= int( _lines.size() ) ) {
+				Checkpoint empty;
+				empty.valid = false;
+				_lines.resize( line + 1, empty );
+			}
+
+			Checkpoint& cp = _lines[line];
+			cp.valid = true;
+			cp.state = state;
+			cp.prevWordState = prevWordState;
+			cp.GroupLevel = GroupLevel;
+			cp.VarNameExt = VarNameExt;
+			cp.nestStart = _nests.size();
+			cp.nbNest = iNL + 1;
+			_nests.insert( _nests.end(), sn, sn + iNL + 1 );
+			cp.braceStart = _braces.size();
+			for ( int kind = 0; kind < NB_BRACE_KINDS; kind++ ) {
+				cp.nbBraces[kind] = openBraces[kind].size();
+				_braces.insert( _braces.end(), openBraces[kind].begin(), openBraces[kind].end() );
+			}
+		};
+
+	private:
+		std::vector<Checkpoint> _lines;
+		std::vector<StateNest> _nests;		// Every line's sn[0] to sn[iNL], in line order.
+		std::vector<int> _braces;			// Every line's open brackets by kind, in line order.
+
+		static unsigned int bracesEnd( const Checkpoint& cp )
+		{
+			unsigned int end = cp.braceStart;
+			for ( int kind = 0; kind < NB_BRACE_KINDS; kind++ ) end += cp.nbBraces[kind];
+			return ( end );
+		};
+
+	}; // End: Class StateCheckpoints
+
+	class BracePairs
+	{
+		/*
+		 *  Bracket pairs found by Colourise_Doc's group tracking, so the highlighters don't
+		 *  have to ask Scintilla to rescan the document with SCI_BRACEMATCH for every one.
+		 *  Like SCI_BRACEMATCH each kind of bracket is paired on its own.  The pairs are good
+		 *  for the same reason the checkpoints are, and they are only trusted once the document
+		 *  has been lexed from the top.
+		 *
+		 */
+
+	public:
+		enum { UNKNOWN = -2 };
+
+		BracePairs():_complete(false), _endLexed(0){};
+
+		//  Drops the pairs with either end at or after pos and restores the brackets still open
+		//  at pos ( from a checkpoint; NULL when they aren't known ).
+		void startAt( int pos, const std::vector<int> openBraces[] )
+		{
+			std::map<int, int>::iterator pair = _pairs.lower_bound( pos );
+			for ( ; pair != _pairs.end(); ++pair ) {
+				if ( pair->second < pos ) _pairs.erase( pair->second );
+			}
+			_pairs.erase( _pairs.lower_bound( pos ), _pairs.end() );
+
+			for ( int kind = 0; kind < NB_BRACE_KINDS; kind++ ) {
+				if ( ( pos > 0 ) && openBraces ) _open[kind] = openBraces[kind];
+				else _open[kind].clear();
+			}
+
+			if ( pos == 0 ) _complete = true;
+			else if (! openBraces ) {
+				_pairs.clear();
+				_complete = false;
+			}
+
+			_endLexed = pos;
+		};
+
+		void open( int ch, int pos ) { _open[kind( ch )].push_back( pos ); };
+
+		void close( int ch, int pos )
+		{
+			std::vector<int>& opened = _open[kind( ch )];
+			if ( opened.empty() ) return;
+
+			_pairs[opened.back()] = pos;
+			_pairs[pos] = opened.back();
+			opened.pop_back();
+		};
+
+		void endAt( int pos ) { _endLexed = pos; };
+
+		const std::vector<int>* getOpenBraces() const { return ( _open ); };
+
+		//  Returns the matching bracket position, -1 for none, or UNKNOWN.
+		int find( int pos, int lengthDoc ) const
+		{
+			if (! _complete ) return ( UNKNOWN );
+
+			std::map<int, int>::const_iterator pair = _pairs.find( pos );
+			if ( pair != _pairs.end() ) return ( pair->second );
+
+			return ( ( _endLexed >= lengthDoc ) ? ( -1 ) : ( UNKNOWN ) );
+		};
+
+	private:
+		static int kind( int ch ) { return ( ( ch == '(' || ch == ')' ) ? ( 0 ) : ( ( ch == '[' || ch == ']' ) ? ( 1 ) : ( 2 ) ) ); };
+
+		std::map<int, int> _pairs;				//  Both ends of each pair point at each other.
+		std::vector<int> _open[NB_BRACE_KINDS];
+		bool _complete;
+		int _endLexed;
+
+	}; // End: Class BracePairs
+
+	class DocumentState
+	{
+		/*
+		 *  Everything the lexer keeps about one Scintilla document, so lexing or switching to
+		 *  one document doesn't make another's state look stale.  Documents are keyed by their
+		 *  Scintilla document pointer, which is the same in both views.  An entry is made the
+		 *  first time a document is activated or lexed and dropped when its file closes.
+		 *
+		 */
+
+	public:
+		void* bufferID;				//  Notepad++ buffer, to find the entry when the file closes.
+		bool languageChanged;		//  Flag to ensure a full doc lexing when switching from a different language.
+		bool docModified;			//  Flag to help determine if lexing actually needs to be redone.
+		unsigned int stylesGeneration;	//  PowerShell_Lexer::stylesGeneration of the last full lexing.
+
+		PowerShell_Lexer::LineState lineState;
+		PowerShell_Lexer::StateCheckpoints checkpoints;
+		PowerShell_Lexer::BracePairs braces;
+		lIface::IndicatorShadow indicators;		//  What the highlighters look like.
+
+		DocumentState()
+			:bufferID(NULL), languageChanged(false), docModified(false), stylesGeneration(0){};
+
+	}; // End: Class DocumentState
+
+	std::map<void*, DocumentState> documents;
+	DocumentState* pDocState;	//  The document of the lexer call being processed.
+	unsigned int stylesGeneration;	//  Bumped by style changes; documents behind it need a full lexing.
+	HWND hLexWindow;			//  The window of the Scintilla lexer call being processed.
+
+	//  Range the last lex call folded itself, so the fold call Scintilla makes right after it
+	//  can be skipped.
+	bool foldedByLex;
+	int foldedStart;
+	int foldedEnd;
+
+	//  A view whose full document lex stopped after the visible lines.
+	struct ChunkPending {
+		void* pDoc;					//  The document the view was showing.
+		LONGLONG budgetTicks;		//  Performance counter ticks of lexing per timer callback.
+	};
+
+	//  A timer lexes the rest of these views a few chunks at a time.
+	std::map<HWND, ChunkPending> chunkPending;
+	UINT_PTR chunkTimer;
 
 	//======================================================//
 	PowerShell_Lexer()
-		:_Initialized(false), StylesUpdatedCall(false)
+		:_Initialized(false), StylesUpdatedCall(false), pDocState(NULL), stylesGeneration(1), hLexWindow(NULL),
+		foldedByLex(false), foldedStart(0), foldedEnd(0), chunkTimer(0)
 	{
 		//  Allocate the space needed for highlighters.
 		Hlite.reserve(INDICMAX);
@@ -351,7 +631,7 @@ public:
 	void initLexer( char* words[], Accessor& accessor )
 	{ 
 		_pAccessor = &accessor;
-		lineState.setAccessor( accessor );
+		pDocState->lineState.setAccessor( accessor );
 		
 		if(! _Initialized ) {
 
@@ -380,8 +660,9 @@ public:
 	};
 
 	void updateHighlighterStyles();
+	void activateHighlighters(int activeBits);
 	void updateWordlists(char* words[]);
-	void PowerShell_Lexer::activateAltView();
+	bool needsFullDoc(int startPos) const;
 	bool doFullDoc(int startPos);
 
 	//  <--- Lexer Helper Functions --->
@@ -399,10 +680,11 @@ public:
 
 	//  <--- Folder Helper Functions --->
 	bool IsCommentStyle(int style);
-	bool IsHashCommentLine(int line);
 
 	//  <--- Highlighter Helper Functions --->
 	int getSafe_Hlite_Pos(int currPos, int length, bool direction);
+	bool IsBraceState(int state);
+	int braceMatch(int pos);
 
 
 private:
@@ -419,16 +701,27 @@ private:
 void LexOrFold(bool LexorFold, unsigned int startPos, int length, int initStyle,
                   char *words[], WindowID window, char *props);
 
+//  The same entry point working on any Accessor.
+void LexOrFold(bool LexorFold, unsigned int startPos, int length, int initStyle,
+                  char *words[], Accessor &styler);
+
 //  This is the menu dialog function item.
 void menuDlg();
 
+#ifdef NPP_PLUGININTERFACE_LEXERBENCH
+//  Lexer benchmark setup; the highlighters come from the lexer.powershell.highlighters bits.
+void benchSetup(char *words[], Accessor &props);
+#endif
+
 //  This will return the pointer to this the PowerShell lexer object.
 PowerShell_Lexer* getLexerObj();
 
 //  Notification Handlers
 void WORDSTYLESUPDATEDproc();
-void setDocModified(bool modified);
-void setLanguageChanged(bool changed);
+void MODIFIEDproc(void* pDoc, int position, int length, bool inserted, int line, int linesAdded);
+void BUFFERACTIVATEDproc(void* bufferID, void* pDoc);
+void LANGCHANGEDproc(void* bufferID, void* pDoc);
+void FILEBEFORECLOSEproc(void* bufferID);
 
 
 }	// End: namespace NppExtLexer_PowerShell
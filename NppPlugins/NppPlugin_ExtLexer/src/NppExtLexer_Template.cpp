@@ -42,6 +42,9 @@ namespace lex = NppExtLexer_Template;				//  This lexer's namespace.
 
 namespace NppExtLexer_Template {
 
+//  The properties and WordLists Notepad++ passes, kept until their text changes.
+lIface::LexerInputs inputs;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 //  Main Lexer Functions
 
@@ -76,23 +79,11 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
                   char *words[], WindowID window, char *props)
 {
 
-	// Create and initialize the WindowAccessor (including contained PropSet)
-	PropSet ps;
-	ps.SetMultiple(props);
-	WindowAccessor wa(window, ps);
-
-	//  Create and initialize WordList(s).
-	//  If you have an extremely large word file, or lots of styling rules you may want to speed
-	//  up processing by storing the wordlists instead of reprocessing them on each call.
-	int nWL = 0;
-	for (; words[nWL]; nWL++) ;	// count # of WordList PTRs needed
-	WordList** wl = new WordList* [nWL + 1];// alloc WordList PTRs
-	int i = 0;
-	for (; i < nWL; i++) {
-		wl[i] = new WordList();	// (works or THROWS bad_alloc EXCEPTION)
-		wl[i]->Set(words[i]);
-	}
-	wl[i] = 0;
+	// Create the accessor over the document text, properties only parsed again when they change.
+	lIface::DirectAccessor wa(window, inputs.properties(props), startPos, length);
+
+	//  The WordList(s) are kept between calls and only rebuilt when a list's text changes.
+	WordList** wl = inputs.wordLists(words);
 
 
 	// Set the currView handle to update at least once per lexer call.
@@ -132,11 +123,6 @@ void LexOrFold(bool foldOrLex, unsigned int startPos, int length, int initStyle,
 	//  The flush function is what actually finalizes settings the styles you just coloured.
 	wa.Flush();
 
-	// Clean up the wordlists before leaving.
-	for (i = nWL - 1; i >= 0; i--)
-		delete wl[i];
-	delete [] wl;
-
 }
 
 
@@ -27,6 +27,7 @@
 #include "NppExtLexer_MYUSERLANG.h"
 #include "NppExtLexer_Template.h"
 #include "NppExtLexer_PowerShell.h"
+#include "NppExtLexer_Engine.h"
 
 /*
  * Plugin Environment Setup:
@@ -50,6 +51,7 @@ namespace l_conf = NppExtLexer_Conf;
 namespace l_myuserlang = NppExtLexer_MYUSERLANG;
 namespace l_template = NppExtLexer_Template;
 namespace l_powershell = NppExtLexer_PowerShell;
+namespace l_engine = NppExtLexer_Engine;
 
 
 //  <--- Required Plugin Interface Routines --->
@@ -68,6 +70,12 @@ BOOL APIENTRY DllMain(HANDLE hModule, DWORD reasonForCall, LPVOID /*lpReserved*/
 		// <--- Base menu function items setup --->
 		setPluginFuncItem(TEXT(""), NULL);	//  A separator line.
 		setPluginFuncItem(TEXT("Help.txt"), npp_plugin::Help_func);
+#ifdef NPP_PLUGININTERFACE_TIMING
+		setPluginFuncItem(TEXT("Dump Timing Histograms"), npp_plugin::timing::dumpHistograms);
+#endif
+#ifdef NPP_PLUGININTERFACE_MSGPROFILE
+		setPluginFuncItem(TEXT("Dump Message Profile"), npp_plugin::msg_facade::dumpProfile);
+#endif
 		setPluginFuncItem(TEXT("About..."), npp_plugin::About_func);
 
 #ifdef NPP_PLUGININTERFACE_CMDMAP_EXTENSION_H
@@ -83,21 +91,29 @@ BOOL APIENTRY DllMain(HANDLE hModule, DWORD reasonForCall, LPVOID /*lpReserved*/
 		 *    - A description within a TEXT(" ") statement.  Shown in the status bar.
 		 *    - The name of the LexOrFold function in your namespace.
 		 *    - The name of the menu dialog function in your namespace.
+		 *    - Optionally the Accessor& LexOrFold overload, which enables the lexer benchmark.
 		 *
 		 */
 
 		//  ===> Include your lexer's initialization statement here.
 		lIface::initLexer( "Conf*", TEXT("Apache Config File. *Ext"),
-			l_conf::LexOrFold, l_conf::menuDlg );
+			l_conf::LexOrFold, l_conf::menuDlg, l_conf::LexOrFold );
 
 		lIface::initLexer( "MYUSERLANG*", TEXT("MYUSERLANG File. *Ext"),
-			l_myuserlang::LexOrFold, l_myuserlang::menuDlg );
+			l_myuserlang::LexOrFold, l_myuserlang::menuDlg, l_myuserlang::LexOrFold );
 
 		lIface::initLexer( "Template*", TEXT("Lexer Template File. *Ext"), 
 			l_template::LexOrFold, l_template::menuDlg);
 
 		lIface::initLexer( "PowerShell*", TEXT("PowerShell Scipt File. *Ext"), 
-			l_powershell::LexOrFold, l_powershell::menuDlg);
+			l_powershell::LexOrFold, l_powershell::menuDlg, l_powershell::LexOrFold);
+
+#ifdef NPP_PLUGININTERFACE_LEXERBENCH
+		lIface::bench::setLexerSetup( "PowerShell*", l_powershell::benchSetup );
+#endif
+
+		//  Lexers described in the plugin's xml file.
+		lIface::initLexersLater( l_engine::initLexers );
 
 
 		// <--- Additional Menu Function Items --->
@@ -152,6 +168,47 @@ extern "C" __declspec(dllexport) FuncItem * getFuncsArray(int *FuncsArraySize)
 	 *
 	 */
 
+//  Un-named namespace for private classes, variables, and functions.
+namespace {
+
+/*
+ *  Scintilla sends SCN_MODIFIED from every view showing the edited document, so an edit to a
+ *  document open in both views arrives twice.  The views are always told in the same order,
+ *  so a change matching the last one handled but sent by the other view is its echo.
+ *
+ */
+struct Modification
+{
+	HWND hFrom;
+	void* pDoc;
+	int position;
+	int length;
+	int modificationType;
+};
+
+Modification lastModification = { NULL, NULL, -1, 0, 0 };
+
+//  Returns true when notifyCode repeats the last handled change for another view, otherwise
+//  records it as the last handled change.
+bool isRepeatedModification( HWND hFrom, void* pDoc, SCNotification* notifyCode )
+{
+	Modification curr = { hFrom, pDoc,
+		notifyCode->position, notifyCode->length, notifyCode->modificationType };
+
+	if ( ( curr.hFrom != lastModification.hFrom ) &&
+			( curr.pDoc == lastModification.pDoc ) &&
+			( curr.position == lastModification.position ) &&
+			( curr.length == lastModification.length ) &&
+			( curr.modificationType == lastModification.modificationType ) ) {
+		return ( true );
+	}
+
+	lastModification = curr;
+	return ( false );
+}
+
+}  // End: Un-named namespace
+
 //  This function gives access to Notepad++'s notification facilities including forwarded
 //  notifications from Scintilla.
 extern "C" __declspec(dllexport) void beNotified(SCNotification *notifyCode)
@@ -170,6 +227,11 @@ extern "C" __declspec(dllexport) void beNotified(SCNotification *notifyCode)
 
 	int currSCILEXERID;		//  External lexers are assigned SCLEX_AUTOMATIC + id by Scintilla.
 
+	PIFACE_TIMED_SCOPE( PROBE_BENOTIFIED );
+
+#ifdef NPP_PLUGININTERFACE_NOTIFYTRACE
+	npp_plugin::notify_trace::recordNotification( notifyCode );
+#endif
 
 	// ===> Include optional notification handlers in the switch.
 int msg = notifyCode->nmhdr.code;
@@ -178,14 +240,16 @@ int msg = notifyCode->nmhdr.code;
 	case SCN_MODIFIED:
 		npp_plugin::hCurrViewNeedsUpdate();
 		if (notifyCode->modificationType & (SC_MOD_DELETETEXT | SC_MOD_INSERTTEXT)) {
-			currSCILEXERID = messageProc(SCI_GETLEXER, 0, 0);
-
-			if ( currSCILEXERID > SCLEX_AUTOMATIC ) {
-
-				if ( currSCILEXERID == lIface::getSCILexerIDByName("PowerShell*") ) {
-					l_powershell::setDocModified( true );
-				}
-				
+			//  The edit may have been made from either view, so ask the view that sent it.
+			HWND hFrom = static_cast<HWND>( notifyCode->nmhdr.hwndFrom );
+			void* pDoc = reinterpret_cast<void*>( SendMessage( hFrom, SCI_GETDOCPOINTER, 0, 0 ) );
+
+			if ( !isRepeatedModification( hFrom, pDoc, notifyCode ) ) {
+				int line = ( notifyCode->linesAdded == 0 ) ? ( 0 ) :
+						SendMessage( hFrom, SCI_LINEFROMPOSITION, notifyCode->position, 0 );
+				l_powershell::MODIFIEDproc( pDoc, notifyCode->position, notifyCode->length,
+					( notifyCode->modificationType & SC_MOD_INSERTTEXT ) != 0,
+					line, notifyCode->linesAdded );
 			}
 		}
 		break;
@@ -193,6 +257,7 @@ int msg = notifyCode->nmhdr.code;
 	case NPPN_READY:
 		npp_plugin::setNppReady();
 		npp_plugin::hCurrViewNeedsUpdate();
+		l_engine::showErrors();
 
 		currSCILEXERID = messageProc(SCI_GETLEXER, 0, 0);
 
@@ -239,7 +304,8 @@ int msg = notifyCode->nmhdr.code;
 		if ( currSCILEXERID > SCLEX_AUTOMATIC ) {
 
 			if ( currSCILEXERID == lIface::getSCILexerIDByName("PowerShell*") ) {
-				l_powershell::setLanguageChanged( true );
+				l_powershell::LANGCHANGEDproc( reinterpret_cast<void*>( notifyCode->nmhdr.idFrom ),
+					reinterpret_cast<void*>( messageProc( SCI_GETDOCPOINTER, 0, 0 ) ) );
 			}
 			
 		}
@@ -253,15 +319,21 @@ int msg = notifyCode->nmhdr.code;
 		if ( currSCILEXERID > SCLEX_AUTOMATIC ) {
 
 			if ( currSCILEXERID == lIface::getSCILexerIDByName("PowerShell*") ) {
-				//  Make sure highlighters get applied to the whole doc.
-				l_powershell::setLanguageChanged( true );  // This flags for a full doc lexing.
-				messageProc(SCI_STARTSTYLING, -1, 0);
+				//  Only documents not lexed with the current styles need the whole doc redone.
+				l_powershell::BUFFERACTIVATEDproc( reinterpret_cast<void*>( notifyCode->nmhdr.idFrom ),
+					reinterpret_cast<void*>( messageProc( SCI_GETDOCPOINTER, 0, 0 ) ) );
 			}
 			
 		}
 
 		break;
 
+	case NPPN_FILEBEFORECLOSE:
+		//  The closing buffer may not be the current one, so every lexer keyed by document
+		//  gets to drop it.
+		l_powershell::FILEBEFORECLOSEproc( reinterpret_cast<void*>( notifyCode->nmhdr.idFrom ) );
+		break;
+
 	case NPPN_FILEOPENED:
 		npp_plugin::hCurrViewNeedsUpdate();
 		break;
@@ -295,6 +367,8 @@ extern "C" __declspec(dllexport) LRESULT messageProc(UINT Message, WPARAM wParam
 	
 	using namespace npp_plugin;
 
+	PIFACE_TIMED_SCOPE( PROBE_MESSAGEPROC );
+
 	// ===>  Include optional messaging handlers here.
 	switch (Message)
 	{
@@ -307,6 +381,8 @@ extern "C" __declspec(dllexport) LRESULT messageProc(UINT Message, WPARAM wParam
 			break;
 		case NPPM_GETCURRENTDOCINDEX:
 			return SendMessage( hNpp(), NPPM_GETCURRENTDOCINDEX, wParam, lParam);
+		case NPPM_GETCURRENTBUFFERID:
+			return SendMessage( hNpp(), NPPM_GETCURRENTBUFFERID, wParam, lParam);
 
 		//  Lexer messages
 		case SCI_STARTSTYLING:
@@ -316,6 +392,8 @@ extern "C" __declspec(dllexport) LRESULT messageProc(UINT Message, WPARAM wParam
 			return SendMessage(hCurrView(), SCI_GETLEXER, wParam, lParam);
 		case SCI_BRACEMATCH:
 			return SendMessage(hCurrView(), SCI_BRACEMATCH, wParam, lParam);
+		case SCI_GETDOCPOINTER:
+			return SendMessage(hCurrView(), SCI_GETDOCPOINTER, wParam, lParam);
 
 		// Style messages
 		case SCI_STYLEGETBACK:
@@ -52,6 +52,13 @@
 //#include "NppPluginIface_CmdMap.h"
 #include "NppPluginIface_ExtLexer.h"
 #include "NppPluginIface_ExtLexer_SciCommon.h"
+#include "NppPluginIface_ExtLexer_Keywords.h"
+#include "NppPluginIface_ExtLexer_RunAccessor.h"
+#include "NppPluginIface_ExtLexer_ByteScan.h"
+#include "NppPluginIface_ExtLexer_LexerInputs.h"
+#include "NppPluginIface_ExtLexer_DirectAccessor.h"
+#include "NppPluginIface_ExtLexer_CharClass.h"
+#include "NppPluginIface_ExtLexer_ParallelLex.h"
 
 namespace npp_plugin {
 